@@ -51,6 +51,152 @@
 */
 
 #include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+
+/**
+  Completion mode of the MAC request.
+  @see MacCompletion
+*/
+byte MAC_COMPLETION_MODE = MacCompletion::POLLING;
+
+/**
+  The longest wait for the MAC response, us.
+*/
+word MAC_COMPLETION_TIMEOUT_US = MacCompletion::DEFAULT_TIMEOUT_US;
+
+/**
+  true = collect latencies of the MAC responses
+*/
+bool MAC_LATENCY_HISTOGRAM = false;
+
+/**
+  Latency histogram of a single MAC subcommand.
+*/
+struct _MacLatencySlot {
+  word subcmd;
+  word bins[MacCompletion::LATENCY_BINS];
+};
+
+_MacLatencySlot _macLatency[MacCompletion::LATENCY_SLOTS];
+byte _macLatencyCount = 0;
+
+/**
+  @brief Put the latency of the subcommand into the bin of its histogram.
+
+  Subcommands that do not fit into the table are ignored.
+  Pass ~0UL as latencyUs for the timeout.
+
+  @see MAC_LATENCY_HISTOGRAM
+*/
+void recordMacLatency(const word MACSubcmd, unsigned long latencyUs) {
+  int i = 0;
+  while (i < _macLatencyCount && _macLatency[i].subcmd != MACSubcmd) i++;
+
+  if (i == _macLatencyCount) {
+    if (_macLatencyCount >= MacCompletion::LATENCY_SLOTS) return;
+    memset(&_macLatency[i], 0, sizeof(_MacLatencySlot));
+    _macLatency[i].subcmd = MACSubcmd;
+    _macLatencyCount++;
+  }
+
+  unsigned long bin = latencyUs / MacCompletion::LATENCY_BIN_US;
+  if (bin >= MacCompletion::LATENCY_BINS) bin = MacCompletion::LATENCY_BINS - 1;
+
+  word *counter = &_macLatency[i].bins[bin];
+  if (*counter < 0xFFFF) (*counter)++;
+}
+
+/**
+  Wait until the device has processed the MAC subcommand.
+
+  Polling: read back 0x3E/0x3F every MacCompletion::POLL_INTERVAL_US until the device echoes the subcommand.
+  The polls are single attempts and their failures are not counted, the busy device is expected;
+  only the final timeout is counted as BusError::MAC_TIMEOUT.
+  After the match, the register pointer is already at 0x40 MACData(),
+  so the rest of the block can be read without resending the command.
+
+  @returns whether the address bytes of the response are already in the buffer
+*/
+bool _waitMacResponse(const word MACSubcmd, byte *buf) {
+  if (MacCompletion::POLLING != MAC_COMPLETION_MODE) {
+    DRIVER_DELAY(MAC_COMPLETION_TIMEOUT_US / 1000);
+    DRIVER_DELAY_US(MAC_COMPLETION_TIMEOUT_US % 1000);
+    return false;
+  }
+
+  bool retval = false;
+  const unsigned long start = micros();
+  unsigned long elapsed = 0;
+  while (true) {
+    retval = 0 == sendCommandOnce(StdCommands::ALT_MANUFACTURER_ACCESS)
+             && BlockProtocol::ADDR_SIZE == rawRequestBytesUncounted(buf, BlockProtocol::ADDR_SIZE)
+             && MACSubcmd == ((buf[1] << 8) | buf[0]);
+    elapsed = micros() - start;
+    if (retval || elapsed >= MAC_COMPLETION_TIMEOUT_US) break;
+
+    DRIVER_DELAY_US(MacCompletion::POLL_INTERVAL_US);
+  }
+
+  if (!retval) recordBusError(BusError::MAC_TIMEOUT);
+  if (MAC_LATENCY_HISTOGRAM) recordMacLatency(MACSubcmd, retval ? elapsed : ~0UL);
+
+  return retval;
+}
+
+/**
+  Send subcommand and read the full response block once, without validation and printing.
+
+  @returns number of the obtained bytes, -1 if the subcommand was not sent
+*/
+int _macRequestBlockOnce(const word MACSubcmd, byte *buf) {
+  memset(buf, 0, BlockProtocol::RESPONSE_MAX_SIZE);
+
+  if (0 != sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, MACSubcmd)) return -1;
+
+  if (_waitMacResponse(MACSubcmd, buf)) return BlockProtocol::ADDR_SIZE + requestBlockData(buf);
+
+  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
+  return requestBlock(buf);
+}
+
+/**
+  Send subcommand and read the full response block, without validation and printing.
+
+  The short, wrong length or wrong checksum response is requested again up to BUS_RETRIES times,
+  with the exponential backoff between the attempts.
+  The unsent subcommand is not repeated here, sendCommand() has already repeated the write.
+
+  @returns number of the obtained bytes
+*/
+int _macRequestBlock(const word MACSubcmd, byte *buf) {
+  for (byte attempt = 0; ; attempt++) {
+    const int count = _macRequestBlockOnce(MACSubcmd, buf);
+    if (count < 0) return 0;
+
+    const byte error = blockError(buf, count);
+    if (BusError::OK == error) return count;
+
+    INSTRUMENT_INVALID();
+    if (BusError::SHORT_READ != error) recordBusError(error);  // the short read is already counted by rawRequestBytes()
+    if (attempt >= BUS_RETRIES) return count;
+
+    busBackoff(attempt);
+  }
+}
+
+/**
+  @brief Copy the data bytes of the response block, the length is limited to [0; 32].
+
+  @returns number of the data bytes
+*/
+byte macBlockData(byte *buf, byte *retval) {
+  int len = buf[BlockProtocol::LENGTH_INDEX] - BlockProtocol::SERVICE_SIZE;
+  if (len < 0) len = 0;
+  if (len > BlockProtocol::PAYLOAD_MAX_SIZE) len = BlockProtocol::PAYLOAD_MAX_SIZE;
+
+  for (int i = 0; i < len; i++) retval[i] = buf[BlockProtocol::DATA_INDEX + i];
+  return len;
+}
 
 /**
   @brief 12.2 0x3E, 0x3F AltManufacturerAccess
@@ -61,18 +207,18 @@
 
   Send subcommand to 0x3E AltManufacturerAccess and request block of data.
 
+  The response is waited according to the MAC_COMPLETION_MODE,
+  the result is checked with validate() anyway.
+  The short, wrong length or wrong checksum response is requested again up to BUS_RETRIES times.
+
   @returns whether the request was successful
+
+  @see MacCompletion
+  @see rawAltManufacturerAccess()
 */
 bool AltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len) {
   byte buf[BlockProtocol::RESPONSE_MAX_SIZE];
-  memset(buf, 0, sizeof(buf));
-
-  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, MACSubcmd);
-
-  delay(5);  // The delay required for the chip to process the request
-
-  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
-  const int count = requestBlock(buf);
+  const int count = _macRequestBlock(MACSubcmd, buf);
 
   if (DEBUG) {
     PGM_PRINT("Obtained bytes: ");
@@ -81,18 +227,30 @@ bool AltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len) {
 
   const bool isDataValid = validate(buf);
   if (isDataValid) {
-    const int _len = buf[BlockProtocol::LENGTH_INDEX] - BlockProtocol::SERVICE_SIZE;
-    for (int i = 0; i < _len; i++) retval[i] = buf[BlockProtocol::DATA_INDEX + i];
-    *len = _len;
+    *len = macBlockData(buf, retval);
 
     if (DEBUG) {
       PGM_PRINT("Data bytes: ");
-      printBytesHex(retval, _len);
+      printBytesHex(retval, *len);
     }
   }
   return isDataValid;
 }
 
+/**
+  @brief Same as AltManufacturerAccess(), but nothing is printed, regardless of SILENCE and DEBUG.
+  @returns whether the response is valid
+  @see isBlockValid()
+*/
+bool rawAltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len) {
+  byte buf[BlockProtocol::RESPONSE_MAX_SIZE];
+  _macRequestBlock(MACSubcmd, buf);
+
+  const bool isDataValid = isBlockValid(buf);
+  if (isDataValid) *len = macBlockData(buf, retval);
+  return isDataValid;
+}
+
 /**
   @brief 12.2 0x3E/0x3F AltManufacturerAccess
 
@@ -102,6 +260,76 @@ void AltManufacturerAccess(const word MACSubcmd) {
   sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, MACSubcmd);
 }
 
+/**
+  @brief Security mode known for the current session.
+
+  Requesting of the security mode costs a full OperationStatus() MAC transaction,
+  so the last known mode is kept in RAM and updated by the functions that change it.
+  The mode is kept per gauge, see selectGauge().
+
+  @returns SecurityMode::UNKNOWN if the mode has not been requested yet or was invalidated.
+
+  @see securityMode()
+  @see SecurityMode
+*/
+byte getSecurityModeCache() {
+  return currentGauge()->securityMode;
+}
+
+/**
+  @brief Store the security mode obtained from the device or set by a command.
+
+  The Data Flash shadow copy is forgotten if the mode differs from the known one.
+
+  @see getSecurityModeCache()
+*/
+void setSecurityModeCache(byte mode) {
+  Gauge *gauge = currentGauge();
+  if (SecurityMode::UNKNOWN != gauge->securityMode && mode != gauge->securityMode) invalidateDfShadowCache();
+  gauge->securityMode = mode;
+}
+
+/**
+  @brief Forget the cached security mode, so it will be requested from the device on the next check.
+
+  The Data Flash shadow copy is forgotten too: the mode could be changed.
+
+  @see getSecurityModeCache()
+*/
+void invalidateSecurityModeCache() {
+  currentGauge()->securityMode = SecurityMode::UNKNOWN;
+  invalidateDfShadowCache();
+}
+
+/**
+  @brief Print the collected latencies of the MAC responses, one line per subcommand:
+  "0x0054: 0 12 3 0 0 0 0 0 0 0"
+
+  Each bin is MacCompletion::LATENCY_BIN_US wide, the last one also counts the timeouts.
+
+  @see MAC_LATENCY_HISTOGRAM
+*/
+void printMacLatencyHistogram() {
+  printInteger(PSTR("MAC latency bin"), MacCompletion::LATENCY_BIN_US, PSTR("us"));
+  for (int i = 0; i < _macLatencyCount; i++) {
+    printWordHex(_macLatency[i].subcmd);
+    PGM_PRINT(":");
+    for (int j = 0; j < MacCompletion::LATENCY_BINS; j++) {
+      PGM_PRINT(" ");
+      Serial.print(_macLatency[i].bins[j]);
+    }
+    Serial.println();
+  }
+}
+
+/**
+  @brief Clear the collected latencies of the MAC responses.
+  @see printMacLatencyHistogram()
+*/
+void resetMacLatencyHistogram() {
+  _macLatencyCount = 0;
+}
+
 /**
   @brief 12.2.1 AltManufacturerAccess() 0x0001 Device Type
 
@@ -231,12 +459,17 @@ word ChemicalID() {
 
   This command resets the device.
 
+  Invalidates the cached security mode, the decoded status blocks and the Data Flash shadow copy.
+
   @warning [!] Not Available in SEALED Mode
 */
 void DeviceReset() {
   if (!SILENCE) PGM_PRINTLN("=== 12.2.12 AltManufacturerAccess() 0x0012 Device Reset");
   AltManufacturerAccess(AltManufacturerCommands::DEVICE_RESET);
-  delay(500);
+  invalidateSecurityModeCache();
+  invalidateStatusBlocksCache();
+  invalidateDfShadowCache();
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -257,7 +490,7 @@ void DeviceReset() {
 void ChargeFET() {
   if (!SILENCE) PGM_PRINTLN("12.2.13 AltManufacturerAccess() 0x001F CHG FET");
   AltManufacturerAccess(AltManufacturerCommands::CHG_FET);
-  delay(500);
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -276,7 +509,7 @@ void ChargeFET() {
 void DischargeFET() {
   if (!SILENCE) PGM_PRINTLN("12.2.14 AltManufacturerAccess() 0x0020 DSG FET");
   AltManufacturerAccess(AltManufacturerCommands::DSG_FET);
-  delay(500);
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -289,7 +522,7 @@ void DischargeFET() {
 void Gauging() {
   if (!SILENCE) PGM_PRINTLN("12.2.15 AltManufacturerAccess() 0x0021 Gauging");
   AltManufacturerAccess(AltManufacturerCommands::GAUGE_EN);
-  delay(500);
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -307,7 +540,7 @@ void Gauging() {
 void FETControl() {
   if (!SILENCE) PGM_PRINTLN("12.2.16 AltManufacturerAccess() 0x0022 FET Control");
   AltManufacturerAccess(AltManufacturerCommands::FET_CONTROL);
-  delay(500);
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -324,11 +557,14 @@ void FETControl() {
   - 0x4288: (I1) [Lifetimes / Temperature / Max Temp Cell] = -128
   - 0x4289: (I1) [Lifetimes / Temperature / Min Temp Cell] = 127
 
+  Invalidates the Data Flash shadow copy.
+
   @warning [!] Not Available in SEALED Mode.
 */
 void LifetimeDataReset() {
   if (!SILENCE) PGM_PRINTLN("12.2.19 AltManufacturerAccess() 0x0028 Lifetime Data Reset");
   AltManufacturerAccess(AltManufacturerCommands::LIFETIME_DATA_RESET);
+  invalidateDfShadowCache();
 }
 
 /**
@@ -341,7 +577,7 @@ void LifetimeDataReset() {
 void PermanentFailureDataReset() {
   if (!SILENCE) PGM_PRINTLN("=== 12.2.20 AltManufacturerAccess() 0x0029 Permanent Fail Data Reset");
   AltManufacturerAccess(AltManufacturerCommands::PERMANENT_FAIL_DATA_RESET);
-  delay(1000);  // needs some time to process
+  DRIVER_DELAY(1000);  // needs some time to process
 }
 
 /**
@@ -349,13 +585,17 @@ void PermanentFailureDataReset() {
 
   This command seals the device for the field, disabling certain commands and access to DF.
 
+  Sets the cached security mode to SEALED and forgets the Data Flash shadow copy.
+
   @see unsealDevice()
   @see 9.5.2 SEALED to UNSEALED
 */
 void SealDevice() {
   if (!SILENCE) PGM_PRINTLN("=== 12.2.22 AltManufacturerAccess() 0x0030 Seal Device");
   AltManufacturerAccess(AltManufacturerCommands::SEAL_DEVICE);
-  delay(500);
+  setSecurityModeCache(SecurityMode::SEALED);
+  invalidateDfShadowCache();
+  DRIVER_DELAY(500);
 }
 
 /**
@@ -365,11 +605,11 @@ void SealDevice() {
 u32 SafetyAlert() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::SAFETY_ALERT, buf, &len)) return;
-
-  const u32 retval = composeDoubleWord(buf);
+  u32 retval = 0;
+  if (!rawSafetyAlert(&retval)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) printLongSplitBin(retval);
 
   return retval;
@@ -383,11 +623,11 @@ u32 SafetyAlert() {
 u32 SafetyStatus() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::PF_ALERT, buf, &len)) return;
-
-  const u32 retval = composeDoubleWord(buf);
+  u32 retval = 0;
+  if (!rawSafetyStatus(&retval)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) printLongSplitBin(retval);
 
   return retval;
@@ -400,11 +640,11 @@ u32 SafetyStatus() {
 u32 PFAlert() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.28 AltManufacturerAccess() 0x0052 PFAlert");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::PF_ALERT, buf, &len)) return;
-
-  const u32 retval = composeDoubleWord(buf);
+  u32 retval = 0;
+  if (!rawPFAlert(&retval)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) printLongSplitBin(retval);
 
   return retval;
@@ -416,13 +656,13 @@ u32 PFAlert() {
   @see PFStatusFlags
 */
 u32 PFStatus() {
-  if (!SILENCE) PGM_PRINTLN("\n=== 12.2.28 AltManufacturerAccess() 0x0052 PFAlert");
+  if (!SILENCE) PGM_PRINTLN("\n=== 12.2.29 AltManufacturerAccess() 0x0053 PFStatus");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::PF_STATUS, buf, &len)) return;
-
-  const u32 retval = composeDoubleWord(buf);
+  u32 retval = 0;
+  if (!rawPFStatus(&retval)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) printLongSplitBin(retval);
 
   return retval;
@@ -436,38 +676,14 @@ u32 PFStatus() {
 u32 OperationStatus() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::OPERATION_STATUS, buf, &len)) return;
-
-  const u32 operationStatus = composeDoubleWord(buf);
+  u32 operationStatus = 0;
+  if (!rawOperationStatus(&operationStatus)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) {
     printLongSplitBin(operationStatus);
-    printFlag(operationStatus, OperationStatusFlags::EMSHUT());  // EMSHUT (Bit 29): Emergency FET Shutdown
-    printFlag(operationStatus, OperationStatusFlags::CB());  // CB (Bit 28): Cell Balancing
-    printFlag(operationStatus, OperationStatusFlags::SLPCC());  // SLPCC (Bit 27): CC Measurement in SLEEP mode
-    printFlag(operationStatus, OperationStatusFlags::SLPAD());  // SLPAD (Bit 26): ADC Measurement in SLEEP mode
-    printFlag(operationStatus, OperationStatusFlags::SMBLCAL());  // SMBLCAL (Bit 25): Auto-offset calibration when Bus low is detected
-    printFlag(operationStatus, OperationStatusFlags::INIT());  // INIT (Bit 24): Initialization after full reset
-    printFlag(operationStatus, OperationStatusFlags::SLEEPM());  // SLEEPM (Bit 23): SLEEP mode
-    printFlag(operationStatus, OperationStatusFlags::XL());  // XL (Bit 22): 400-kHz mode
-    printFlag(operationStatus, OperationStatusFlags::CAL_OFFSET());  // CAL_OFFSET (Bit 21): Calibration Output (raw CC Offset data)
-    printFlag(operationStatus, OperationStatusFlags::CAL());  // CAL (Bit 20): Calibration Output (raw ADC and CC data)
-    printFlag(operationStatus, OperationStatusFlags::AUTHCALM());  // AUTHCALM (Bit 19): Auto CC Offset Calibration by MAC AutoCCOffset()
-    printFlag(operationStatus, OperationStatusFlags::AUTH());  // AUTH (Bit 18): Authentication in progress
-    printFlag(operationStatus, OperationStatusFlags::SDM());  // SDM (Bit 16): SHUTDOWN triggered via command
-    printFlag(operationStatus, OperationStatusFlags::SLEEP());  // SLEEP (Bit 15): SLEEP mode conditions met
-
-    printFlag(operationStatus, OperationStatusFlags::XCHG());  // XCHG (Bit 14): Charging disabled
-    printFlag(operationStatus, OperationStatusFlags::XDSG());  // XDSG (Bit 13): Discharging disabled
-    printFlag(operationStatus, OperationStatusFlags::PF());  // PF (Bit 12): PERMANENT FAILURE mode status
-    printFlag(operationStatus, OperationStatusFlags::SS());  // SS (Bit 11): SAFETY mode status
-    printFlag(operationStatus, OperationStatusFlags::SDV());  // SDV (Bit 10): SHUTDOWN triggered via low pack voltage
-    printFlag(operationStatus, OperationStatusFlags::SEC1());  // SEC1, SEC0 (Bits 9–8): SECURITY mode
-    printFlag(operationStatus, OperationStatusFlags::SEC0());  // SEC1, SEC0 (Bits 9–8): SECURITY mode
-    printFlag(operationStatus, OperationStatusFlags::BTP_INT());  // BTP_INT (Bit 7): Battery Trip Point (BTP) Interrupt output
-    printFlag(operationStatus, OperationStatusFlags::CHG());  // CHG (Bit 2): CHG FET status
-    printFlag(operationStatus, OperationStatusFlags::DSG());  // DSG (Bit 1): DSG FET status
+    printFlags(operationStatus, &OperationStatusFlags::TABLE);
   }
   return operationStatus;
 }
@@ -480,28 +696,14 @@ u32 OperationStatus() {
 word ChargingStatus() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.31 AltManufacturerAccess() 0x0055 ChargingStatus");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::CHARGING_STATUS, buf, &len)) return;
-
-  const word chargingStatus = composeWord(buf);
+  word chargingStatus = 0;
+  if (!rawChargingStatus(&chargingStatus)) {
+    printInvalidData();
+    return 0;
+  }
   if (!SILENCE) {
     printWordBin(chargingStatus, true);
-    printFlag(chargingStatus, ChargingStatusFlags::VCT());  // VCT (Bit 15): Charge Termination
-    printFlag(chargingStatus, ChargingStatusFlags::MCHG());  // MCHG (Bit 14): Maintenance Charge
-    printFlag(chargingStatus, ChargingStatusFlags::SU());  // SU (Bit 13): Charge Suspend
-    printFlag(chargingStatus, ChargingStatusFlags::IN());  // IN (Bit 12): Charge Inhibit
-    printFlag(chargingStatus, ChargingStatusFlags::HV());  // HV (Bit 11): High Voltage Region
-    printFlag(chargingStatus, ChargingStatusFlags::MV());  // MV (Bit 10): Mid Voltage Region
-    printFlag(chargingStatus, ChargingStatusFlags::LV());  // MV (Bit 10): Mid Voltage Region
-    printFlag(chargingStatus, ChargingStatusFlags::PV());  // MV (Bit 10): Mid Voltage Region
-    printFlag(chargingStatus, ChargingStatusFlags::OT());  // OT (Bit 6): Over Temperature Region
-    printFlag(chargingStatus, ChargingStatusFlags::HT());  // HT (Bit 5): High Temperature Region
-    printFlag(chargingStatus, ChargingStatusFlags::STH());  // STH (Bit 4): Standard Temperature High Region
-    printFlag(chargingStatus, ChargingStatusFlags::RT());  // RT (Bit 3): Room Temperature Region
-    printFlag(chargingStatus, ChargingStatusFlags::STL());  // RT (Bit 3): Room Temperature Region
-    printFlag(chargingStatus, ChargingStatusFlags::LT());  // LT (Bit 1): Low Temperature Region
-    printFlag(chargingStatus, ChargingStatusFlags::UT());  // UT (Bit 0): Under Temperature Region
+    printFlags(chargingStatus, &ChargingStatusFlags::TABLE);
   }
   return chargingStatus;
 }
@@ -514,32 +716,14 @@ word ChargingStatus() {
 u32 GaugingStatus() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus");
 
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::GAUGING_STATUS, buf, &len)) return;
-
-  const u32 gaugingStatus = composeDoubleWord(buf);
+  u32 gaugingStatus = 0;
+  if (!rawGaugingStatus(&gaugingStatus)) {
+    printInvalidData();
+    return 0;
+  }
   if (DEBUG) printLongSplitBin(gaugingStatus);
   if (!SILENCE) {
-    printFlag(gaugingStatus, GaugingStatusFlags::OCVFR());  // OCVFR (Bit 20): Open Circuit Voltage in Flat Region (during RELAX)
-    printFlag(gaugingStatus, GaugingStatusFlags::LDMD());  // LDMD (Bit 19): LOAD mode
-    printFlag(gaugingStatus, GaugingStatusFlags::RX());  // RX (Bit 18): Resistance Update (Toggles after every resistance update)
-    printFlag(gaugingStatus, GaugingStatusFlags::QMax());  // QMax (Bit 17): QMax Update (Toggles after every QMax update)
-    printFlag(gaugingStatus, GaugingStatusFlags::VDQ());  // VDQ (Bit 16): Discharge Qualified for Learning (based on RU flag)
-    printFlag(gaugingStatus, GaugingStatusFlags::NSFM());  // NSFM (Bit 15): Negative Scale Factor Mode
-    printFlag(gaugingStatus, GaugingStatusFlags::SLPQMax());  // SLPQMax (Bit 13): QMax Update During Sleep
-    printFlag(gaugingStatus, GaugingStatusFlags::QEN());  // QEN (Bit 12): Impedance Track Gauging (Ra and QMax updates are enabled.)
-    printFlag(gaugingStatus, GaugingStatusFlags::VOK());  // VOK (Bit 11): Voltage OK for QMax Update
-    printFlag(gaugingStatus, GaugingStatusFlags::RDIS());  // RDIS (Bit 10): Resistance Updates
-    printFlag(gaugingStatus, GaugingStatusFlags::REST());  // REST (Bit 8): Rest
-    printFlag(gaugingStatus, GaugingStatusFlags::CF());  // CF (Bit 7): Condition Flag
-    printFlag(gaugingStatus, GaugingStatusFlags::DSG());  // DSG (Bit 6): Discharge/Relax
-    printFlag(gaugingStatus, GaugingStatusFlags::EDV());  // EDV (Bit 5): End-of-Discharge Termination Voltage
-    printFlag(gaugingStatus, GaugingStatusFlags::BAL_EN());  // BAL_EN (Bit 4): Cell Balancing
-    printFlag(gaugingStatus, GaugingStatusFlags::TC());  // TC (Bit 3): Terminate Charge
-    printFlag(gaugingStatus, GaugingStatusFlags::TD());  // TD (Bit 2): Terminate Discharge
-    printFlag(gaugingStatus, GaugingStatusFlags::FC());  // FC (Bit 1): Fully Charged
-    printFlag(gaugingStatus, GaugingStatusFlags::FD());  // FC (Bit 1): Fully Charged
+    printFlags(gaugingStatus, &GaugingStatusFlags::TABLE);
   }
   return gaugingStatus;
 }
@@ -551,20 +735,14 @@ u32 GaugingStatus() {
 */
 word ManufacturingStatus() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.2.33 AltManufacturerAccess() 0x0057 ManufacturingStatus");
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
-  memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(AltManufacturerCommands::MANUFACTURER_STATUS, buf, &len)) return;
-
-  const word manufacturingStatus = composeWord(buf);
+  word manufacturingStatus = 0;
+  if (!rawManufacturingStatus(&manufacturingStatus)) {
+    printInvalidData();
+    return 0;
+  }
   if (DEBUG) printWordBin(manufacturingStatus, true);
   if (!SILENCE) {
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::CAL_EN());  // CAL_EN (Bit 15): CALIBRATION Mode
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::PF_EN());  // PF_EN (Bit 6): Permanent Failure
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::LF_EN());  // LF_EN (Bit 5): Lifetime Data Collection
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::FET_EN());  // FET_EN (Bit 4): All FET Action
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::GAUGE_EN());  // GAUGE_EN (Bit 3): Gas Gauging
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::DSG_TEST());  // DSG_TEST (Bit 2): Discharge FET Test
-    printFlag(manufacturingStatus, ManufacturingStatusFlags::CHG_TEST());  // CHG_TEST (Bit 1): Charge FET Test
+    printFlags(manufacturingStatus, &ManufacturingStatusFlags::TABLE);
   }
   return manufacturingStatus;
 }
@@ -910,3 +1088,235 @@ void ITStatus3() {
   const word RawDOD0_2 = composeValue(buf, 18, 19);
   printInteger(PSTR("RawDOD0_2. Cell 2 raw DOD0 measurement"), RawDOD0_2);
 }
+
+/*
+  Raw accessors.
+
+  The functions return the value in the native format of the device
+  and do not print anything, regardless of SILENCE and DEBUG.
+  The result is false if the device responded with invalid data, the value is not changed in that case.
+*/
+
+bool _rawMacLong(const word MACSubcmd, u32 *retval) {
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE], len = 0;
+  if (!rawAltManufacturerAccess(MACSubcmd, buf, &len) || len < 4) return false;
+  *retval = ((u32) buf[3] << 24) | ((u32) buf[2] << 16) | ((u32) buf[1] << 8) | buf[0];
+  return true;
+}
+
+bool _rawMacWord(const word MACSubcmd, word *retval) {
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE], len = 0;
+  if (!rawAltManufacturerAccess(MACSubcmd, buf, &len) || len < 2) return false;
+  *retval = (buf[1] << 8) | buf[0];
+  return true;
+}
+
+bool _rawMacBlock(const word MACSubcmd, byte *retval) {
+  byte len = 0;
+  return rawAltManufacturerAccess(MACSubcmd, retval, &len);
+}
+
+/**
+  @brief 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert, no printing.
+  @see SafetyAlert()
+  @see SafetyAlertFlags
+*/
+bool rawSafetyAlert(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::SAFETY_ALERT, retval);
+}
+
+/**
+  @brief 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus, no printing.
+  @see SafetyStatus()
+  @see SafetyStatusFlags
+*/
+bool rawSafetyStatus(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::SAFETY_STATUS, retval);
+}
+
+/**
+  @brief 12.2.28 AltManufacturerAccess() 0x0052 PFAlert, no printing.
+  @see PFAlert()
+*/
+bool rawPFAlert(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::PF_ALERT, retval);
+}
+
+/**
+  @brief 12.2.29 AltManufacturerAccess() 0x0053 PFStatus, no printing.
+  @see PFStatus()
+  @see PFStatusFlags
+*/
+bool rawPFStatus(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::PF_STATUS, retval);
+}
+
+/**
+  @brief 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus, no printing.
+  @see OperationStatus()
+  @see OperationStatusFlags
+*/
+bool rawOperationStatus(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::OPERATION_STATUS, retval);
+}
+
+/**
+  @brief 12.2.31 AltManufacturerAccess() 0x0055 ChargingStatus, no printing.
+  @see ChargingStatus()
+  @see ChargingStatusFlags
+*/
+bool rawChargingStatus(word *retval) {
+  return _rawMacWord(AltManufacturerCommands::CHARGING_STATUS, retval);
+}
+
+/**
+  @brief 12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus, no printing.
+  @see GaugingStatus()
+  @see GaugingStatusFlags
+*/
+bool rawGaugingStatus(u32 *retval) {
+  return _rawMacLong(AltManufacturerCommands::GAUGING_STATUS, retval);
+}
+
+/**
+  @brief 12.2.33 AltManufacturerAccess() 0x0057 ManufacturingStatus, no printing.
+  @see ManufacturingStatus()
+  @see ManufacturingStatusFlags
+*/
+bool rawManufacturingStatus(word *retval) {
+  return _rawMacWord(AltManufacturerCommands::MANUFACTURER_STATUS, retval);
+}
+
+/**
+  @brief 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1, no printing.
+  @param retval - buffer for 32 data bytes
+  @see DAStatus1()
+  @see DA_STATUS_1
+*/
+bool rawDAStatus1(byte *retval) {
+  return _rawMacBlock(AltManufacturerCommands::DA_STATUS_1, retval);
+}
+
+/**
+  @brief 12.2.39 AltManufacturerAccess() 0x0073 ITStatus1, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus1()
+*/
+bool rawITStatus1(byte *retval) {
+  return _rawMacBlock(AltManufacturerCommands::IT_STATUS_1, retval);
+}
+
+/**
+  @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus2()
+  @see IT_STATUS_2
+*/
+bool rawITStatus2(byte *retval) {
+  return _rawMacBlock(AltManufacturerCommands::IT_STATUS_2, retval);
+}
+
+/**
+  @brief 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus3()
+  @see IT_STATUS_3
+*/
+bool rawITStatus3(byte *retval) {
+  return _rawMacBlock(AltManufacturerCommands::IT_STATUS_3, retval);
+}
+
+/**
+  Decoded MAC block kept for the reuse within the freshness window.
+*/
+struct _StatusBlockCache {
+  unsigned long timestamp;  ///< millis() when the block was obtained
+  bool isValid;
+};
+
+_StatusBlockCache _daStatus1Cache, _itStatus1Cache, _itStatus2Cache, _itStatus3Cache;
+DAStatus1Data _daStatus1;
+ITStatus1Data _itStatus1;
+ITStatus2Data _itStatus2;
+ITStatus3Data _itStatus3;
+
+/**
+  Return the cached block if it is not older than maxAge, otherwise request and decode the block.
+  maxAge = 0 always requests the device.
+*/
+bool _readStatusBlock(const word MACSubcmd, void *retval, void *cached, byte size, _StatusBlockCache *cache, unsigned long maxAge) {
+  const bool isFresh = maxAge > 0 && cache->isValid && millis() - cache->timestamp <= maxAge;
+  if (!isFresh) {
+    byte buf[BlockProtocol::PAYLOAD_MAX_SIZE], len = 0;
+    if (!rawAltManufacturerAccess(MACSubcmd, buf, &len) || len < size) return false;
+
+    memcpy(cached, buf, size);
+    cache->timestamp = millis();
+    cache->isValid = true;
+  }
+  memcpy(retval, cached, size);
+  return true;
+}
+
+/**
+  @brief Forget the decoded status blocks, so they will be requested from the device on the next access.
+  @see DAStatus1(DAStatus1Data*, unsigned long)
+*/
+void invalidateStatusBlocksCache() {
+  _daStatus1Cache.isValid = false;
+  _itStatus1Cache.isValid = false;
+  _itStatus2Cache.isValid = false;
+  _itStatus3Cache.isValid = false;
+}
+
+/**
+  @brief 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool DAStatus1(DAStatus1Data *retval, unsigned long maxAge) {
+  return _readStatusBlock(AltManufacturerCommands::DA_STATUS_1, retval, &_daStatus1, sizeof(DAStatus1Data), &_daStatus1Cache, maxAge);
+}
+
+/**
+  @brief 12.2.39 AltManufacturerAccess() 0x0073 ITStatus1 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus1(ITStatus1Data *retval, unsigned long maxAge) {
+  return _readStatusBlock(AltManufacturerCommands::IT_STATUS_1, retval, &_itStatus1, sizeof(ITStatus1Data), &_itStatus1Cache, maxAge);
+}
+
+/**
+  @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus2(ITStatus2Data *retval, unsigned long maxAge) {
+  return _readStatusBlock(AltManufacturerCommands::IT_STATUS_2, retval, &_itStatus2, sizeof(ITStatus2Data), &_itStatus2Cache, maxAge);
+}
+
+/**
+  @brief 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus3(ITStatus3Data *retval, unsigned long maxAge) {
+  return _readStatusBlock(AltManufacturerCommands::IT_STATUS_3, retval, &_itStatus3, sizeof(ITStatus3Data), &_itStatus3Cache, maxAge);
+}
@@ -55,6 +55,25 @@
 #include "globals.h"
 #include "utils.h"
 
+/**
+  Completion mode of the MAC request.
+  @see MacCompletion
+*/
+extern byte MAC_COMPLETION_MODE;
+
+/**
+  The longest wait for the MAC response, us.
+
+  In the MacCompletion::FIXED_DELAY mode, this is the delay before the response is read.
+*/
+extern word MAC_COMPLETION_TIMEOUT_US;
+
+/**
+  true = collect latencies of the MAC responses
+  @see printMacLatencyHistogram()
+*/
+extern bool MAC_LATENCY_HISTOGRAM;
+
 /**
   @brief 12.2 0x3E, 0x3F AltManufacturerAccess
 
@@ -64,10 +83,39 @@
 
   Send subcommand to 0x3E AltManufacturerAccess and request block of data.
 
+  The response is waited according to the MAC_COMPLETION_MODE,
+  the result is checked with validate() anyway.
+  The short, wrong length or wrong checksum response is requested again up to BUS_RETRIES times.
+
   @returns whether the request was successful
+
+  @see MacCompletion
+  @see rawAltManufacturerAccess()
 */
 bool AltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len);
 
+/**
+  @brief Same as AltManufacturerAccess(), but nothing is printed, regardless of SILENCE and DEBUG.
+  @returns whether the response is valid
+  @see isBlockValid()
+*/
+bool rawAltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len);
+
+/**
+  @brief Copy the data bytes of the response block, the length is limited to [0; 32].
+
+  @returns number of the data bytes
+*/
+byte macBlockData(byte *buf, byte *retval);
+
+/*
+  Raw accessors.
+
+  The functions return the value in the native format of the device
+  and do not print anything, regardless of SILENCE and DEBUG.
+  The result is false if the device responded with invalid data, the value is not changed in that case.
+*/
+
 /**
   @brief 12.2 0x3E/0x3F AltManufacturerAccess
 
@@ -75,6 +123,64 @@ bool AltManufacturerAccess(const word MACSubcmd, byte *retval, byte *len);
 */
 void AltManufacturerAccess(const word MACSubcmd);
 
+/**
+  @brief Security mode known for the current session.
+
+  Requesting of the security mode costs a full OperationStatus() MAC transaction,
+  so the last known mode is kept in RAM and updated by the functions that change it.
+  The mode is kept per gauge, see selectGauge().
+
+  @returns SecurityMode::UNKNOWN if the mode has not been requested yet or was invalidated.
+
+  @see securityMode()
+  @see SecurityMode
+*/
+byte getSecurityModeCache();
+
+/**
+  @brief Store the security mode obtained from the device or set by a command.
+
+  The Data Flash shadow copy is forgotten if the mode differs from the known one.
+
+  @see getSecurityModeCache()
+*/
+void setSecurityModeCache(byte mode);
+
+/**
+  @brief Forget the cached security mode, so it will be requested from the device on the next check.
+
+  The Data Flash shadow copy is forgotten too: the mode could be changed.
+
+  @see getSecurityModeCache()
+*/
+void invalidateSecurityModeCache();
+
+/**
+  @brief Print the collected latencies of the MAC responses, one line per subcommand:
+  "0x0054: 0 12 3 0 0 0 0 0 0 0"
+
+  Each bin is MacCompletion::LATENCY_BIN_US wide, the last one also counts the timeouts.
+
+  @see MAC_LATENCY_HISTOGRAM
+*/
+void printMacLatencyHistogram();
+
+/**
+  @brief Put the latency of the subcommand into the bin of its histogram.
+
+  Subcommands that do not fit into the table are ignored.
+  Pass ~0UL as latencyUs for the timeout.
+
+  @see MAC_LATENCY_HISTOGRAM
+*/
+void recordMacLatency(const word MACSubcmd, unsigned long latencyUs);
+
+/**
+  @brief Clear the collected latencies of the MAC responses.
+  @see printMacLatencyHistogram()
+*/
+void resetMacLatencyHistogram();
+
 /**
   @brief 12.2.1 AltManufacturerAccess() 0x0001 Device Type
 
@@ -135,6 +241,8 @@ word ChemicalID();
 
   This command resets the device.
 
+  Invalidates the cached security mode, the decoded status blocks and the Data Flash shadow copy.
+
   @warning [!] Not Available in SEALED Mode
 */
 void DeviceReset();
@@ -208,6 +316,8 @@ void FETControl();
   - 0x4288: (I1) [Lifetimes / Temperature / Max Temp Cell] = -128
   - 0x4289: (I1) [Lifetimes / Temperature / Min Temp Cell] = 127
 
+  Invalidates the Data Flash shadow copy.
+
   @warning [!] Not Available in SEALED Mode.
 */
 void LifetimeDataReset();
@@ -226,6 +336,8 @@ void PermanentFailureDataReset();
 
   This command seals the device for the field, disabling certain commands and access to DF.
 
+  Sets the cached security mode to SEALED and forgets the Data Flash shadow copy.
+
   @see unsealDevice()
   @see 9.5.2 SEALED to UNSEALED
 */
@@ -432,3 +544,139 @@ void ITStatus3(byte *retval);
   Print result of ITStatus3.
 */
 void ITStatus3();
+
+/**
+  @brief 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert, no printing.
+  @see SafetyAlert()
+  @see SafetyAlertFlags
+*/
+bool rawSafetyAlert(u32 *retval);
+
+/**
+  @brief 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus, no printing.
+  @see SafetyStatus()
+  @see SafetyStatusFlags
+*/
+bool rawSafetyStatus(u32 *retval);
+
+/**
+  @brief 12.2.28 AltManufacturerAccess() 0x0052 PFAlert, no printing.
+  @see PFAlert()
+*/
+bool rawPFAlert(u32 *retval);
+
+/**
+  @brief 12.2.29 AltManufacturerAccess() 0x0053 PFStatus, no printing.
+  @see PFStatus()
+  @see PFStatusFlags
+*/
+bool rawPFStatus(u32 *retval);
+
+/**
+  @brief 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus, no printing.
+  @see OperationStatus()
+  @see OperationStatusFlags
+*/
+bool rawOperationStatus(u32 *retval);
+
+/**
+  @brief 12.2.31 AltManufacturerAccess() 0x0055 ChargingStatus, no printing.
+  @see ChargingStatus()
+  @see ChargingStatusFlags
+*/
+bool rawChargingStatus(word *retval);
+
+/**
+  @brief 12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus, no printing.
+  @see GaugingStatus()
+  @see GaugingStatusFlags
+*/
+bool rawGaugingStatus(u32 *retval);
+
+/**
+  @brief 12.2.33 AltManufacturerAccess() 0x0057 ManufacturingStatus, no printing.
+  @see ManufacturingStatus()
+  @see ManufacturingStatusFlags
+*/
+bool rawManufacturingStatus(word *retval);
+
+/**
+  @brief 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1, no printing.
+  @param retval - buffer for 32 data bytes
+  @see DAStatus1()
+  @see DA_STATUS_1
+*/
+bool rawDAStatus1(byte *retval);
+
+/**
+  @brief 12.2.39 AltManufacturerAccess() 0x0073 ITStatus1, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus1()
+*/
+bool rawITStatus1(byte *retval);
+
+/**
+  @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus2()
+  @see IT_STATUS_2
+*/
+bool rawITStatus2(byte *retval);
+
+/**
+  @brief 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3, no printing.
+  @param retval - buffer for 32 data bytes
+  @see ITStatus3()
+  @see IT_STATUS_3
+*/
+bool rawITStatus3(byte *retval);
+
+/**
+  @brief Forget the decoded status blocks, so they will be requested from the device on the next access.
+  @see DAStatus1(DAStatus1Data*, unsigned long)
+*/
+void invalidateStatusBlocksCache();
+
+/**
+  @brief 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool DAStatus1(DAStatus1Data *retval, unsigned long maxAge = 0);
+
+/**
+  @brief 12.2.39 AltManufacturerAccess() 0x0073 ITStatus1 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus1(ITStatus1Data *retval, unsigned long maxAge = 0);
+
+/**
+  @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus2(ITStatus2Data *retval, unsigned long maxAge = 0);
+
+/**
+  @brief 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3 decoded in a single pass.
+
+  No printing.
+
+  @param maxAge - the result of the previous read is reused if it is not older than maxAge, ms;
+                  0 = always request the device
+  @returns whether the data was obtained
+*/
+bool ITStatus3(ITStatus3Data *retval, unsigned long maxAge = 0);
@@ -0,0 +1,294 @@
+/**
+  @file async_i2c.cpp
+
+  @brief Non-blocking I2C transactions implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "async_i2c.h"
+
+/**
+  Kinds of the transactions.
+*/
+enum _I2cAsyncKind : byte {
+  _I2C_ASYNC_WORD,
+  _I2C_ASYNC_MAC,
+  _I2C_ASYNC_DF
+};
+
+/**
+  Bus steps of the transaction.
+
+  Word: SEND -> READ_TAIL
+  MAC:  SEND -> WAIT -> (READ_ADDR) -> READ_DATA -> READ_TAIL
+
+  With BLOCK_SINGLE_READ the rest of the block is read by READ_ADDR or READ_DATA at once.
+*/
+enum _I2cAsyncStep : byte {
+  _STEP_SEND,
+  _STEP_WAIT,  ///< polling for the echo of the subcommand, or waiting for the fixed delay
+  _STEP_READ_ADDR,  ///< the response was not confirmed by polling, request it from the beginning
+  _STEP_READ_DATA,
+  _STEP_READ_TAIL
+};
+
+struct _I2cAsyncTransaction {
+  byte kind;
+  byte step;
+  Gauge *gauge;  ///< the gauge selected when the transaction was queued
+  word command;  ///< register or MAC subcommand
+  byte len;  ///< requested bytes of the Data Flash
+  word timeoutMs;
+  unsigned long startMs;  ///< millis() of the first step
+  unsigned long sentUs;  ///< micros() of sending of the MAC subcommand
+  I2cAsyncCallback callback;
+  void *context;
+  byte buf[BlockProtocol::RESPONSE_MAX_SIZE];
+};
+
+_I2cAsyncTransaction _i2cAsyncQueue[I2cAsync::QUEUE_SIZE];
+byte _i2cAsyncHead = 0;  ///< index of the running transaction
+byte _i2cAsyncCount = 0;
+
+int _i2cAsyncIds = 0;  ///< identifier of the last queued transaction
+
+int _i2cAsyncEnqueue(byte kind, word command, byte len, I2cAsyncCallback callback, void *context, word timeoutMs) {
+  if (_i2cAsyncCount >= I2cAsync::QUEUE_SIZE) return -1;
+
+  _I2cAsyncTransaction *t = &_i2cAsyncQueue[(_i2cAsyncHead + _i2cAsyncCount) % I2cAsync::QUEUE_SIZE];
+  t->kind = kind;
+  t->gauge = currentGauge();
+  t->step = _STEP_SEND;
+  t->command = command;
+  t->len = len;
+  t->timeoutMs = timeoutMs;
+  t->callback = callback;
+  t->context = context;
+  _i2cAsyncCount++;
+
+  _i2cAsyncIds = (_i2cAsyncIds + 1) & 0x7FFF;
+  return _i2cAsyncIds;
+}
+
+/**
+  Remove the running transaction and notify its callback.
+*/
+void _i2cAsyncComplete(byte status, const byte *data, byte len) {
+  _I2cAsyncTransaction *t = &_i2cAsyncQueue[_i2cAsyncHead];
+  _i2cAsyncHead = (_i2cAsyncHead + 1) % I2cAsync::QUEUE_SIZE;
+  _i2cAsyncCount--;
+
+  // the callback can queue a new transaction into the released slot, so the fields are taken before the call
+  const I2cAsyncCallback callback = t->callback;
+  void *context = t->context;
+  if (NULL != callback) callback(status, data, len, context);
+}
+
+/**
+  Validate the MAC response block and complete the transaction.
+*/
+void _i2cAsyncCompleteBlock(_I2cAsyncTransaction *t) {
+  if (!isBlockValid(t->buf)) {
+    if (_I2C_ASYNC_DF == t->kind) invalidateSecurityModeCache();  // the mode could be changed
+    _i2cAsyncComplete(I2cAsync::INVALID_DATA, NULL, 0);
+    return;
+  }
+
+  byte data[BlockProtocol::PAYLOAD_MAX_SIZE];
+  byte len = macBlockData(t->buf, data);
+  if (_I2C_ASYNC_DF == t->kind && len > t->len) len = t->len;
+
+  _i2cAsyncComplete(I2cAsync::OK, data, len);
+}
+
+/**
+  One poll of 0x3E for the echo of the subcommand, or a check of the fixed delay.
+*/
+void _i2cAsyncWait(_I2cAsyncTransaction *t) {
+  const unsigned long elapsed = micros() - t->sentUs;
+
+  if (MacCompletion::POLLING != MAC_COMPLETION_MODE) {
+    if (elapsed >= MAC_COMPLETION_TIMEOUT_US) t->step = _STEP_READ_ADDR;
+    return;
+  }
+
+  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
+  const bool isEcho = BlockProtocol::ADDR_SIZE == rawRequestBytes(t->buf, BlockProtocol::ADDR_SIZE)
+                      && t->command == composeWord(t->buf);
+  if (isEcho) {
+    // the register pointer is already at 0x40 MACData()
+    t->step = _STEP_READ_DATA;
+    return;
+  }
+  if (elapsed >= MAC_COMPLETION_TIMEOUT_US) t->step = _STEP_READ_ADDR;
+}
+
+/**
+  @brief Queue reading of the standard word register, e.g. StdCommands::VOLTAGE.
+
+  The data of the callback are 2 bytes in Little Endian.
+
+  @returns the transaction identifier, or -1 if the queue is full
+*/
+int i2cAsyncReadWord(byte reg, I2cAsyncCallback callback, void *context, word timeoutMs) {
+  return _i2cAsyncEnqueue(_I2C_ASYNC_WORD, reg, 2, callback, context, timeoutMs);
+}
+
+/**
+  @brief Queue the MAC subcommand with the block response, like AltManufacturerAccess().
+
+  The response is waited according to the MAC_COMPLETION_MODE,
+  without blocking: every i2cAsyncTick() makes at most one poll.
+
+  @returns the transaction identifier, or -1 if the queue is full
+
+  @see AltManufacturerAccess()
+  @see MacCompletion
+*/
+int i2cAsyncMacRead(word MACSubcmd, I2cAsyncCallback callback, void *context, word timeoutMs) {
+  return _i2cAsyncEnqueue(_I2C_ASYNC_MAC, MACSubcmd, BlockProtocol::PAYLOAD_MAX_SIZE, callback, context, timeoutMs);
+}
+
+/**
+  @brief Queue reading of len bytes from the Data Flash, like dfReadBytes().
+
+  Address should be in the range [0x4000; 0x5FFF], length in the range [1; 32].
+  The device is not requested for the security mode: if the cached mode is SEALED the transaction is not queued.
+  The cache is invalidated if the response is wrong.
+
+  @returns the transaction identifier, or -1 if the request is not allowed or the queue is full
+
+  @see dfReadBytes()
+  @see getSecurityModeCache()
+*/
+int i2cAsyncDfRead(word addr, byte len, I2cAsyncCallback callback, void *context, word timeoutMs) {
+  if (addr < DF_ADDR::MIN || addr > DF_ADDR::MAX || !isAllowedRequestPayloadSize(len)) return -1;
+  if (SecurityMode::SEALED == getSecurityModeCache()) return -1;
+  return _i2cAsyncEnqueue(_I2C_ASYNC_DF, addr, len, callback, context, timeoutMs);
+}
+
+/**
+  @brief Execute the next bus step of the current transaction.
+
+  The transaction is executed on the gauge that was selected when it was queued,
+  the gauge remains selected after the step.
+
+  Should be called from loop() as often as possible.
+  The synchronous functions of the driver must not be called while i2cAsyncBusy(),
+  because they would move the register pointer of the device in the middle of the transaction.
+
+  @returns whether there are transactions left in the queue
+*/
+bool i2cAsyncTick() {
+  if (0 == _i2cAsyncCount) return false;
+
+  _I2cAsyncTransaction *t = &_i2cAsyncQueue[_i2cAsyncHead];
+  selectGauge(t->gauge);
+
+  if (_STEP_SEND == t->step) {
+    t->startMs = millis();
+    memset(t->buf, 0, sizeof(t->buf));
+
+    const int error = _I2C_ASYNC_WORD == t->kind
+                      ? sendCommand(t->command)
+                      : sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, t->command);
+    if (0 != error) {
+      _i2cAsyncComplete(I2cAsync::BUS_ERROR, NULL, 0);
+      return 0 != _i2cAsyncCount;
+    }
+
+    t->sentUs = micros();
+    t->step = _I2C_ASYNC_WORD == t->kind ? _STEP_READ_TAIL : _STEP_WAIT;
+    return true;
+  }
+
+  if (millis() - t->startMs > t->timeoutMs) {
+    _i2cAsyncComplete(I2cAsync::TIMEOUT, NULL, 0);
+    return 0 != _i2cAsyncCount;
+  }
+
+  switch (t->step) {
+    case _STEP_WAIT:
+      _i2cAsyncWait(t);
+      if (MAC_LATENCY_HISTOGRAM && MacCompletion::POLLING == MAC_COMPLETION_MODE && _STEP_WAIT != t->step) {
+        recordMacLatency(t->command, _STEP_READ_DATA == t->step ? micros() - t->sentUs : ~0UL);
+      }
+      break;
+
+    case _STEP_READ_ADDR:
+      sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
+#if BLOCK_SINGLE_READ
+      requestBlock(t->buf);
+      _i2cAsyncCompleteBlock(t);
+#else
+      rawRequestBytes(t->buf, BlockProtocol::ADDR_SIZE);
+      t->step = _STEP_READ_DATA;
+#endif
+      break;
+
+    case _STEP_READ_DATA:
+#if BLOCK_SINGLE_READ
+      requestBlockData(t->buf);
+      _i2cAsyncCompleteBlock(t);
+#else
+      rawRequestBytes(t->buf + BlockProtocol::DATA_INDEX, BlockProtocol::PAYLOAD_MAX_SIZE);
+      t->step = _STEP_READ_TAIL;
+#endif
+      break;
+
+    case _STEP_READ_TAIL:
+      if (_I2C_ASYNC_WORD == t->kind) {
+        if (2 == rawRequestBytes(t->buf, 2)) _i2cAsyncComplete(I2cAsync::OK, t->buf, 2);
+        else _i2cAsyncComplete(I2cAsync::BUS_ERROR, NULL, 0);
+      } else {
+        rawRequestBytes(t->buf + BlockProtocol::CHECKSUM_INDEX, BlockProtocol::CHECKSUM_AND_LENGTH_SIZE);
+        _i2cAsyncCompleteBlock(t);
+      }
+      break;
+  }
+
+  return 0 != _i2cAsyncCount;
+}
+
+/**
+  @brief Whether there are queued or running transactions.
+*/
+bool i2cAsyncBusy() {
+  return 0 != _i2cAsyncCount;
+}
+
+/**
+  @brief Number of the queued transactions including the running one.
+*/
+byte i2cAsyncPending() {
+  return _i2cAsyncCount;
+}
+
+/**
+  @brief Remove all the transactions, their callbacks are called with I2cAsync::CANCELED.
+*/
+void i2cAsyncCancelAll() {
+  byte count = _i2cAsyncCount;
+  while (count-- > 0 && 0 != _i2cAsyncCount) _i2cAsyncComplete(I2cAsync::CANCELED, NULL, 0);
+}
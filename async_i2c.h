@@ -0,0 +1,134 @@
+/**
+  @file async_i2c.h
+
+  @brief Non-blocking I2C transactions headers
+
+
+  Transactions are queued and executed by i2cAsyncTick() one bus step per call,
+  the waiting for the MAC response is done by timers instead of the busy loop.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+
+/**
+  @brief Constants of the asynchronous transactions.
+*/
+class I2cAsync {
+  public:
+    static const byte QUEUE_SIZE = 4;  ///< Maximum number of the queued transactions.
+    static const word DEFAULT_TIMEOUT_MS = 50;  ///< The longest duration of a whole transaction, ms.
+
+    static const byte OK = 0;  ///< Transaction completed, the data is valid.
+    static const byte BUS_ERROR = 1;  ///< The device has not acknowledged the write.
+    static const byte INVALID_DATA = 2;  ///< Checksum or length of the response is wrong.
+    static const byte TIMEOUT = 3;  ///< The transaction has not completed in time.
+    static const byte CANCELED = 4;  ///< The transaction was removed by i2cAsyncCancelAll().
+};
+
+/**
+  @brief Completion callback of the transaction.
+
+  @param status - I2cAsync::OK or an error code
+  @param data - response data bytes, valid only during the call
+  @param len - number of the data bytes
+  @param context - the value passed when the transaction was queued
+*/
+typedef void (*I2cAsyncCallback)(byte status, const byte *data, byte len, void *context);
+
+/**
+  @brief Queue reading of the standard word register, e.g. StdCommands::VOLTAGE.
+
+  The data of the callback are 2 bytes in Little Endian.
+
+  @returns the transaction identifier, or -1 if the queue is full
+*/
+int i2cAsyncReadWord(byte reg, I2cAsyncCallback callback, void *context = NULL,
+                     word timeoutMs = I2cAsync::DEFAULT_TIMEOUT_MS);
+
+/**
+  @brief Queue the MAC subcommand with the block response, like AltManufacturerAccess().
+
+  The response is waited according to the MAC_COMPLETION_MODE,
+  without blocking: every i2cAsyncTick() makes at most one poll.
+
+  @returns the transaction identifier, or -1 if the queue is full
+
+  @see AltManufacturerAccess()
+  @see MacCompletion
+*/
+int i2cAsyncMacRead(word MACSubcmd, I2cAsyncCallback callback, void *context = NULL,
+                    word timeoutMs = I2cAsync::DEFAULT_TIMEOUT_MS);
+
+/**
+  @brief Queue reading of len bytes from the Data Flash, like dfReadBytes().
+
+  Address should be in the range [0x4000; 0x5FFF], length in the range [1; 32].
+  The device is not requested for the security mode: if the cached mode is SEALED the transaction is not queued.
+  The cache is invalidated if the response is wrong.
+
+  @returns the transaction identifier, or -1 if the request is not allowed or the queue is full
+
+  @see dfReadBytes()
+  @see getSecurityModeCache()
+*/
+int i2cAsyncDfRead(word addr, byte len, I2cAsyncCallback callback, void *context = NULL,
+                   word timeoutMs = I2cAsync::DEFAULT_TIMEOUT_MS);
+
+/**
+  @brief Execute the next bus step of the current transaction.
+
+  The transaction is executed on the gauge that was selected when it was queued,
+  the gauge remains selected after the step.
+
+  Should be called from loop() as often as possible.
+  The synchronous functions of the driver must not be called while i2cAsyncBusy(),
+  because they would move the register pointer of the device in the middle of the transaction.
+
+  @returns whether there are transactions left in the queue
+*/
+bool i2cAsyncTick();
+
+/**
+  @brief Whether there are queued or running transactions.
+*/
+bool i2cAsyncBusy();
+
+/**
+  @brief Number of the queued transactions including the running one.
+*/
+byte i2cAsyncPending();
+
+/**
+  @brief Remove all the transactions, their callbacks are called with I2cAsync::CANCELED.
+*/
+void i2cAsyncCancelAll();
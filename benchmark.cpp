@@ -0,0 +1,279 @@
+/**
+  @file benchmark.cpp
+
+  @brief Bus-level latency benchmark of the command families
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "benchmark.h"
+
+/**
+  @brief Standard Data Commands to be measured.
+*/
+const byte _BENCH_STD_COMMANDS[] PROGMEM = {
+  StdCommands::MANUFACTURER_ACCESS_CONTROL,
+  StdCommands::TEMPERATURE,
+  StdCommands::VOLTAGE,
+  StdCommands::BATTERY_STATUS,
+  StdCommands::CURRENT,
+  StdCommands::REMAINING_CAPACITY,
+  StdCommands::FULL_CHARGE_CAPACITY,
+  StdCommands::AVERAGE_CURRENT,
+  StdCommands::CYCLE_COUNT,
+  StdCommands::RELATIVE_STATE_OF_CHARGE,
+  StdCommands::STATE_OF_HEALTH,
+  StdCommands::CHARGING_VOLTAGE,
+  StdCommands::CHARGING_CURRENT,
+  StdCommands::DESIGN_CAPACITY,
+};
+
+/**
+  @brief Read-only MAC subcommands to be measured.
+*/
+const word _BENCH_MAC_COMMANDS[] PROGMEM = {
+  AltManufacturerCommands::DEVICE_TYPE,
+  AltManufacturerCommands::FIRMWARE_VERSION,
+  AltManufacturerCommands::HARDWARE_VERSION,
+  AltManufacturerCommands::CHEMICAL_ID,
+  AltManufacturerCommands::SAFETY_ALERT,
+  AltManufacturerCommands::SAFETY_STATUS,
+  AltManufacturerCommands::PF_ALERT,
+  AltManufacturerCommands::PF_STATUS,
+  AltManufacturerCommands::OPERATION_STATUS,
+  AltManufacturerCommands::CHARGING_STATUS,
+  AltManufacturerCommands::GAUGING_STATUS,
+  AltManufacturerCommands::MANUFACTURER_STATUS,
+  AltManufacturerCommands::DA_STATUS_1,
+  AltManufacturerCommands::DA_STATUS_2,
+  AltManufacturerCommands::IT_STATUS_1,
+  AltManufacturerCommands::IT_STATUS_2,
+  AltManufacturerCommands::IT_STATUS_3,
+};
+
+/**
+  @brief Durations of the iterations of the current command, us.
+*/
+unsigned long _benchSamples[Benchmark::MAX_ITERATIONS];
+
+byte _benchLimit(byte iterations) {
+  if (0 == iterations) return 1;
+  return iterations < Benchmark::MAX_ITERATIONS ? iterations : Benchmark::MAX_ITERATIONS;
+}
+
+/**
+  @brief Sort the samples and print the CSV line.
+
+  @param isWord - the command is printed with 4 hex digits, otherwise with 2
+  @param n - number of the successful iterations in _benchSamples
+  @param busBytes - bytes moved over the bus by the single request
+*/
+void _benchReport(Print &out, PGM_P family, word command, bool isWord, byte size, byte iterations, byte n, word busBytes) {
+  // insertion sort, the number of samples is small:
+  for (byte i = 1; i < n; i++) {
+    const unsigned long v = _benchSamples[i];
+    byte j = i;
+    for (; j > 0 && _benchSamples[j - 1] > v; j--) _benchSamples[j] = _benchSamples[j - 1];
+    _benchSamples[j] = v;
+  }
+
+  out.print(PGM_FLASH(family));
+  out.print(F(",0x"));
+  for (byte shift = (isWord ? 12 : 4); shift > 0; shift -= 4) {  // leading zeros
+    if (command >> shift) break;
+    out.print('0');
+  }
+  out.print(command, HEX);
+  out.print(',');
+  out.print(size);
+  out.print(',');
+  out.print(iterations);
+  out.print(',');
+  out.print(iterations - n);  // errors
+
+  if (0 == n) {
+    out.println(F(",,,,"));
+    return;
+  }
+
+  const unsigned long median = _benchSamples[n / 2];
+  const byte p99 = (99UL * n + 99) / 100 - 1;  // nearest-rank: ceil(0.99 * n) - 1
+  out.print(',');
+  out.print(_benchSamples[0]);
+  out.print(',');
+  out.print(median);
+  out.print(',');
+  out.print(_benchSamples[p99]);
+  out.print(',');
+  out.println(0 == median ? 0 : 1000000UL * busBytes / median);
+}
+
+/**
+  @brief Print the Data Flash row with all the iterations as errors, the device is not requested.
+*/
+void _benchReportFailed(Print &out, PGM_P family, byte len, byte iterations) {
+  _benchReport(out, family, Benchmark::DF_READ_ADDR, true, len, _benchLimit(iterations), 0, len);
+}
+
+/**
+  @brief Time the Standard Data Command.
+  @see runBenchmark()
+*/
+void benchmarkStdCommand(Print &out, byte reg, byte iterations) {
+  iterations = _benchLimit(iterations);
+  byte n = 0, buf[2];
+  for (byte i = 0; i < iterations; i++) {
+    const unsigned long start = micros();
+    const bool isOk = 0 == sendCommand(reg) && sizeof(buf) == rawRequestBytes(buf, sizeof(buf));
+    const unsigned long duration = micros() - start;
+    if (isOk) _benchSamples[n++] = duration;
+  }
+  _benchReport(out, PSTR("std"), reg, false, sizeof(buf), iterations, n, 1 + sizeof(buf));
+}
+
+/**
+  @brief Time the MAC subcommand, the interval includes the completion wait.
+  @see runBenchmark()
+*/
+void benchmarkMacCommand(Print &out, word MACSubcmd, byte iterations) {
+  iterations = _benchLimit(iterations);
+  byte n = 0, len = 0;
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE];
+  for (byte i = 0; i < iterations; i++) {
+    const unsigned long start = micros();
+    const bool isOk = rawAltManufacturerAccess(MACSubcmd, buf, &len);
+    const unsigned long duration = micros() - start;
+    if (isOk) _benchSamples[n++] = duration;
+  }
+  // register + subcommand are written, register + the whole block are read:
+  const word busBytes = 1 + BlockProtocol::ADDR_SIZE + 1 + BlockProtocol::RESPONSE_MAX_SIZE;
+  _benchReport(out, PSTR("mac"), MACSubcmd, true, len, iterations, n, busBytes);
+}
+
+/**
+  @brief Time the Data Flash read of len bytes, by rawDfReadBytes() which prints nothing.
+  The security mode is not checked, see runBenchmark().
+
+  The bytes per second are counted by the requested payload,
+  so the cost of the whole block which is always transferred is visible for the short reads.
+
+  @see runBenchmark()
+*/
+void benchmarkDfRead(Print &out, word addr, byte len, byte iterations) {
+  iterations = _benchLimit(iterations);
+  byte n = 0;
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE];
+  for (byte i = 0; i < iterations; i++) {
+    const unsigned long start = micros();
+    const bool isOk = rawDfReadBytes(addr, buf, len);
+    const unsigned long duration = micros() - start;
+    if (isOk) _benchSamples[n++] = duration;
+  }
+  _benchReport(out, PSTR("df_read"), addr, true, len, iterations, n, len);
+}
+
+/**
+  @brief Time the Data Flash write of len bytes, the current content is written back.
+  The security mode is not checked, see runBenchmark().
+
+  The host cannot detect a failed write without the read-back, so every write is counted.
+  The interval includes the fixed delay of dfWriteBytes().
+
+  @warning Every iteration is the real write of the flash.
+
+  @see runBenchmark()
+*/
+void benchmarkDfWrite(Print &out, word addr, byte len, byte iterations) {
+  iterations = _benchLimit(iterations);
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE];
+  if (!rawDfReadBytes(addr, buf, len)) {
+    _benchReport(out, PSTR("df_write"), addr, true, len, iterations, 0, len);
+    return;
+  }
+
+  for (byte i = 0; i < iterations; i++) {
+    const unsigned long start = micros();
+    dfWriteBytes(addr, buf, len);
+    _benchSamples[i] = micros() - start;
+  }
+  _benchReport(out, PSTR("df_write"), addr, true, len, iterations, iterations, len);
+}
+
+/**
+  @brief Time every Standard Data Command, every read-only MAC subcommand and the Data Flash read
+  of every payload size [1; 32], print the report to out in CSV.
+
+  The commands which change the state of the device (resets, FET toggles, seal) are not measured.
+  The security mode is checked once before the Data Flash rows: if the Data Flash is not accessible,
+  the rows are printed with all the iterations as errors, so no text message breaks the CSV.
+
+  @param iterations - number of the requests per command, limited by Benchmark::MAX_ITERATIONS
+  @param withDfWrites - also time the Data Flash write of every payload size;
+                        the bytes at Benchmark::DF_READ_ADDR are written back unchanged,
+                        but every iteration is a real flash write.
+
+  @see Benchmark
+*/
+void runBenchmark(Print &out, byte iterations, bool withDfWrites) {
+  const bool _silence = SILENCE;
+  SILENCE = true;
+
+  out.print(F("# bq28z610 benchmark v"));
+  out.println(Benchmark::VERSION);
+  out.print(F("# f_cpu="));
+#ifdef F_CPU
+  out.print((unsigned long) F_CPU);
+#endif
+  out.print(F(",wire_rx_buffer="));
+  out.print(WIRE_RX_BUFFER_SIZE);
+  out.print(F(",block_single_read="));
+  out.print(BLOCK_SINGLE_READ);
+  out.print(F(",mac_completion="));
+  out.println(MAC_COMPLETION_MODE);
+  out.println(F("family,command,size,iterations,errors,min_us,median_us,p99_us,bytes_per_s"));
+
+  for (byte i = 0; i < sizeof(_BENCH_STD_COMMANDS); i++) {
+    benchmarkStdCommand(out, pgm_read_byte(&_BENCH_STD_COMMANDS[i]), iterations);
+  }
+
+  for (byte i = 0; i < sizeof(_BENCH_MAC_COMMANDS) / sizeof(_BENCH_MAC_COMMANDS[0]); i++) {
+    benchmarkMacCommand(out, pgm_read_word(&_BENCH_MAC_COMMANDS[i]), iterations);
+  }
+
+  const int mode = cachedSecurityMode();
+  const bool isDfAccessible = SecurityMode::UNKNOWN != mode && SecurityMode::SEALED != mode;
+
+  for (byte len = 1; len <= BlockProtocol::PAYLOAD_MAX_SIZE; len++) {
+    if (isDfAccessible) benchmarkDfRead(out, Benchmark::DF_READ_ADDR, len, iterations);
+    else _benchReportFailed(out, PSTR("df_read"), len, iterations);
+  }
+
+  if (withDfWrites) {
+    for (byte len = 1; len <= BlockProtocol::PAYLOAD_MAX_SIZE; len++) {
+      if (isDfAccessible) benchmarkDfWrite(out, Benchmark::DF_READ_ADDR, len, iterations);
+      else _benchReportFailed(out, PSTR("df_write"), len, iterations);
+    }
+  }
+
+  SILENCE = _silence;
+}
@@ -0,0 +1,113 @@
+/**
+  @file benchmark.h
+
+  @brief Bus-level latency benchmark of the command families
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+#include "service.h"
+
+/**
+  @brief Constants of the bus-level benchmark.
+
+  The report is CSV, one line per measured command, the lines starting with "#" describe the environment:
+  <pre>
+    # bq28z610 benchmark v1
+    # f_cpu=16000000,wire_rx_buffer=32,block_single_read=0,mac_completion=0
+    family,command,size,iterations,errors,min_us,median_us,p99_us,bytes_per_s
+    std,0x08,2,32,0,402,408,416,7352
+    mac,0x0071,32,32,0,6012,6020,6104,6644
+    df_read,0x4080,1,32,0,6030,6041,6118,165
+  </pre>
+
+  - family - std, mac, df_read or df_write;
+  - command - register, MAC subcommand or Data Flash address;
+  - size - number of the payload bytes per request;
+  - bytes_per_s - all the bytes moved over the bus per request (address byte excluded) divided by the median time.
+*/
+class Benchmark {
+  public:
+    static const byte VERSION = 1;
+#if defined(__AVR__)
+    static const byte MAX_ITERATIONS = 32;  ///< 4 bytes of RAM per iteration
+#else
+    static const byte MAX_ITERATIONS = 128;
+#endif
+    static const byte DEFAULT_ITERATIONS = 32 < MAX_ITERATIONS ? 32 : MAX_ITERATIONS;
+    static const word DF_READ_ADDR = DF_ADDR::DEVICE_NAME;  ///< 32 bytes which are not in the DF shadow copy.
+};
+
+/**
+  @brief Time every Standard Data Command, every read-only MAC subcommand and the Data Flash read
+  of every payload size [1; 32], print the report to out in CSV.
+
+  The commands which change the state of the device (resets, FET toggles, seal) are not measured.
+  The security mode is checked once before the Data Flash rows: if the Data Flash is not accessible,
+  the rows are printed with all the iterations as errors, so no text message breaks the CSV.
+
+  @param iterations - number of the requests per command, limited by Benchmark::MAX_ITERATIONS
+  @param withDfWrites - also time the Data Flash write of every payload size;
+                        the bytes at Benchmark::DF_READ_ADDR are written back unchanged,
+                        but every iteration is a real flash write.
+
+  @see Benchmark
+*/
+void runBenchmark(Print &out = Serial, byte iterations = Benchmark::DEFAULT_ITERATIONS, bool withDfWrites = false);
+
+/**
+  @brief Time the Standard Data Command.
+  @see runBenchmark()
+*/
+void benchmarkStdCommand(Print &out, byte reg, byte iterations);
+
+/**
+  @brief Time the MAC subcommand, the interval includes the completion wait.
+  @see runBenchmark()
+*/
+void benchmarkMacCommand(Print &out, word MACSubcmd, byte iterations);
+
+/**
+  @brief Time the Data Flash read of len bytes, by rawDfReadBytes() which prints nothing.
+  The security mode is not checked, see runBenchmark().
+  @see runBenchmark()
+*/
+void benchmarkDfRead(Print &out, word addr, byte len, byte iterations);
+
+/**
+  @brief Time the Data Flash write of len bytes, the current content is written back.
+  The security mode is not checked, see runBenchmark().
+
+  @warning Every iteration is the real write of the flash.
+
+  @see runBenchmark()
+*/
+void benchmarkDfWrite(Print &out, word addr, byte len, byte iterations);
@@ -50,18 +50,46 @@
 #include "data_flash_access.h"
 
 #include "service.h"
+#include "sampler.h"
+#include "async_i2c.h"
+#include "status_watcher.h"
+#include "telemetry.h"
+#include "learning_log.h"
+#include "benchmark.h"
+#include "protection.h"
+#include "instrumentation.h"
+#include "learning_cycle.h"
+#include "warm_start.h"
 
 bool SILENCE = false,  // true = do not print results inside functions
      DEBUG = false;    // true = print extra raw data
 
+// LearningCycleState learningCycle;  // unattended learning cycle, see learningCycleTick()
+
+/**
+  Sampler callback: print Temperature in *C.
+*/
+void printTemperatureSample(byte, u32 value) {
+  printRegister<TemperatureRegister>(PSTR("Temperature"), value);
+}
+
+/**
+  Sampler callback: report the changed bits of SafetyStatus.
+*/
+void watchSafetyStatus(byte, u32 value) {
+  statusWatcherUpdate(StatusWord::SAFETY_STATUS, value);
+}
+
 void setup() {
   delay(5000);  // Prevent running when resetting while uploading sketch to Arduino
 
+  paintStack();  // mark the free RAM to find the stack high-water mark, see stackHighWater()
+
   Wire.begin();  // initializes the Wire library and join the I2C bus as a controller device
 
   Serial.begin(9600);  // start serial for output
   while (!Serial) {};  // wait until serial port is ready
-  Serial.println(stringFromProgmem(START_MESSAGE));
+  printPgm(START_MESSAGE, true);
 
   //
   // Sample code
@@ -136,12 +164,16 @@ void setup() {
   //
   // Chapter 2 Protections. Print flags
 
-  CellUndervoltageProtectionCheck();  // print flags for: "2.2 Cell Undervoltage Protection"
-  ShortCircuitInChargeProtectionCheck();  // print flags for: "2.6.2 Short Circuit in Charge Protection"
-  ShortCircuitInDischargeProtectionCheck();  // print flags for: "2.6.3 Short Circuit in Discharge Protection"
-  OvertemperatureInChargeProtectionCheck();  // print flags for: 2.8 Overtemperature in Charge Protection
-  //
-  PermanentFailCheck();  // print flags for: "Chapter 3 Permanent Fail"
+  ProtectionStatus protectionStatus;  // the status words are read once for all the checks
+  if (readProtectionStatus(&protectionStatus)) {
+    CellUndervoltageProtectionCheck(&protectionStatus);  // print flags for: "2.2 Cell Undervoltage Protection"
+    ShortCircuitInChargeProtectionCheck(&protectionStatus);  // print flags for: "2.6.2 Short Circuit in Charge Protection"
+    ShortCircuitInDischargeProtectionCheck(&protectionStatus);  // print flags for: "2.6.3 Short Circuit in Discharge Protection"
+    OvertemperatureInChargeProtectionCheck(&protectionStatus);  // print flags for: 2.8 Overtemperature in Charge Protection
+    //
+    PermanentFailCheck(&protectionStatus);  // print flags for: "Chapter 3 Permanent Fail"
+    printProtections(evaluateProtections(&protectionStatus));  // the same conditions as the bitmap
+  }
   isPermanentFail();  // check whether the Device in Permanent Fail
 
   SILENCE = true;
@@ -154,23 +186,106 @@ void setup() {
   u32 safetyAlert = SafetyAlert();  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
   word controlRegister = ManufacturerAccessControl();  // 12.1.1 0x00/01 ManufacturerAccess() Control
   int chargingCurrent = ChargingCurrent();  // 12.1.26 0x32/33 ChargingCurrent()
-  float chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
-  float fullChargeCapacity = FullChargeCapacity();  // 12.1.10 0x12/13 FullChargeCapacity()
-  float designCapacity = DesignCapacity();  // 12.1.27 0x3C/3D DesignCapacity()
-
-  Serial.println("batteryStatus: " + String(batteryStatus));
-  Serial.println("manufacturingStatus: " + String(manufacturingStatus));
-  Serial.println("operationStatus: " + String(operationStatus));
-  Serial.println("safetyStatus: " + String(safetyStatus));
-  Serial.println("safetyAlert: " + String(safetyAlert));
-  Serial.println("controlRegister: " + String(controlRegister));
-  Serial.println("chargingCurrent: " + String(chargingCurrent));
-  Serial.println("chargingVoltage: " + String(chargingVoltage));
-  Serial.println("fullChargeCapacity: " + String(fullChargeCapacity));
-  Serial.println("designCapacity: " + String(designCapacity));
+  Measurement chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
+  word fullChargeCapacity = FullChargeCapacity();  // 12.1.10 0x12/13 FullChargeCapacity()
+  word designCapacity = DesignCapacity();  // 12.1.27 0x3C/3D DesignCapacity()
+
+  PGM_PRINT("batteryStatus: ");
+  Serial.println(batteryStatus);
+  PGM_PRINT("manufacturingStatus: ");
+  Serial.println(manufacturingStatus);
+  PGM_PRINT("operationStatus: ");
+  Serial.println(operationStatus);
+  PGM_PRINT("safetyStatus: ");
+  Serial.println(safetyStatus);
+  PGM_PRINT("safetyAlert: ");
+  Serial.println(safetyAlert);
+  PGM_PRINT("controlRegister: ");
+  Serial.println(controlRegister);
+  PGM_PRINT("chargingCurrent: ");
+  Serial.println(chargingCurrent);
+  PGM_PRINT("chargingVoltage: ");
+  Serial.println(chargingVoltage);
+  PGM_PRINT("fullChargeCapacity: ");
+  Serial.println(fullChargeCapacity);
+  PGM_PRINT("designCapacity: ");
+  Serial.println(designCapacity);
   
+  PGM_PRINT("Free RAM: ");
+  Serial.print(freeMemory());
+  PGM_PRINT(" bytes, never used by the stack: ");
+  Serial.println(stackHighWater());
+
   PGM_PRINTLN("\nDONE #####################\n");
+
+  //
+  // Several gauges behind the TCA9548A multiplexer, see gauge.h
+  //
+  // Gauge pack1(Wire, DEVICE_ADDR, GaugeMux::TCA9548A_ADDR, 0);
+  // Gauge pack2(Wire, DEVICE_ADDR, GaugeMux::TCA9548A_ADDR, 1);
+  // Gauge *packs[] = {&pack1, &pack2};
+  // macPollGauges(packs, 2, AltManufacturerCommands::OPERATION_STATUS);  // one MAC wait for both packs
+  // selectGauge(&pack2);
+  // Voltage();
+  // selectGauge(&DEFAULT_GAUGE);
+
+  //
+  // Binary telemetry instead of the text, decoded by extras/data_flash/telemetry.py
+  //
+  // telemetryWriteHello(Serial);
+  // telemetrySampleRegister<CurrentRegister>(Serial);
+  // TelemetryFrame frame;
+  // if (readTelemetryFrame(&frame)) telemetryWriteFrame(Serial, &frame);
+
+  //
+  // Unattended Learning Cycle log, flush it to the host later: learningLogFlush(Serial)
+  //
+  // learningLogBegin(60000);  // ............................ and learningLogTick() in loop()
+
+  //
+  // Bus latency of every command family in CSV, see benchmark.h
+  //
+  // runBenchmark(Serial);
+
+  //
+  // Transactions, bytes and time in the Wire calls and delays per command, build with -DDRIVER_INSTRUMENTATION=1
+  //
+  // printInstrumentation(Serial);
+  // resetInstrumentation();
+
+  //
+  // Unattended learning cycle in loop(): the charger and the load are switched by the FETs
+  //
+  // learningCycleBegin(&learningCycle, &DEFAULT_GAUGE);
+
+  //
+  // Periodic sampling in loop(), see samplerTick()
+  //
+  samplerAdd(sampleCurrent, 250);  // ........................ 4 Hz
+  samplerAdd(sampleVoltage, 1000);
+  samplerAdd(sampleTemperature, 1000, printTemperatureSample);
+  samplerAdd(sampleRelativeStateOfCharge, 10000);
+  samplerAdd(sampleCellVoltage1, 5000);  // .................. shares one DAStatus1 read
+  samplerAdd(sampleCellVoltage2, 5000);  // .................. with the Cell Voltage 1
+  samplerAdd(sampleQMax1, 60000);  // ........................ ITStatus3 once a minute
+
+  // samplerAdd(sampleProtections, 100);  // safety supervisor: 3 MAC reads per cycle, see protection.h
+
+  statusWatcherSetCallback(printStatusChange);  // print only the changed flags
+  samplerAdd(sampleSafetyStatus, 500, watchSafetyStatus);
+
+  //
+  // Warm start after the MCU reset: identity, DF shadow copy and sample periods from EEPROM, see warm_start.h
+  //
+  // if (warmStartRestore()) printWarmStartIdentity();  // 2 transactions instead of the identity and DF reads
+  // else warmStartSave();  // ................................ after the cold start has read the cached DF parameters
 }
 
 void loop() {
+  // the synchronous reads must not break into a queued transaction, see i2cAsyncTick()
+  if (!i2cAsyncTick()) {
+    samplerTick();
+    // learningLogTick();  // ................................. after learningLogBegin(), about 700 B of RAM on AVR
+    // learningCycleTick(&learningCycle);
+  }
 }
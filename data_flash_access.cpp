@@ -61,20 +61,203 @@ bool _isAddrValid(word addr) {
   return retval;
 }
 
+/**
+  @brief Checks if the whole requested region fits into the Data Flash addresses region.
+*/
+bool _isRequestRegionValid(word addr, int len) {
+  if (len <= 0) {
+    PGM_PRINTLN("Request size must be greater than 0.");
+    return false;
+  }
+  return _isAddrValid(addr) && _isAddrValid(addr + len - 1);
+}
+
 /**
   @brief Operations with Data Flash are not allowed in the Sealed mode.
-  @see securityMode()
+
+  The cached security mode is used, so the device is requested only once per session,
+  or after the cache has been invalidated.
+
+  @see cachedSecurityMode()
 */
 bool _isDeviceSealed() {
-  const bool silence = SILENCE;
-  SILENCE = true;
-  const bool retval = SecurityMode::SEALED == securityMode();
-  SILENCE = silence;
+  const bool retval = SecurityMode::SEALED == cachedSecurityMode();
 
   if (retval) PGM_PRINTLN("[!] Operations with Data Flash are not allowed in SEALED Mode.");
   return retval;
 }
 
+/**
+  @brief Address and size of the single shadowed Data Flash parameter.
+  The values are kept per gauge, see Gauge::dfShadow.
+*/
+struct _DfShadowParam {
+  word addr;
+  byte size;
+};
+
+/**
+  @brief Parameters which are changed only by the host, so the last read or written value stays actual.
+
+  Gas Gauging State values (Qmax, Update Status, Cycle Count) are updated by the device itself
+  and must not be shadowed.
+*/
+const _DfShadowParam _DF_SHADOW_PARAMS[DF_SHADOW::COUNT] = {
+  {DF_ADDR::FET_OPTIONS, 1},
+  {DF_ADDR::DESIGN_CAPACITY_MAH, 2},
+  {DF_ADDR::DESIGN_CAPACITY_CWH, 2},
+  {DF_ADDR::SOC_FLAG_CONFIG_A, 2},
+  {DF_ADDR::TC_SET_RSOC_THRESHOLD, 1},
+  {DF_ADDR::TC_CLEAR_RSOC_THRESHOLD, 1},
+  {DF_ADDR::CHARGE_TERM_TAPER_CURRENT, 2},
+  {DF_ADDR::OCC_THRESHOLD, 2},
+  {DF_ADDR::OTC_THRESHOLD, 2},
+  {DF_ADDR::OTC_RECOVERY, 2},
+};
+
+const byte _DF_SHADOW_COUNT = sizeof(_DF_SHADOW_PARAMS) / sizeof(_DF_SHADOW_PARAMS[0]);
+
+bool _isDfShadowValid(const Gauge *gauge, byte i) {
+  return gauge->dfShadowValid & (1 << i);
+}
+
+void _setDfShadowValid(Gauge *gauge, byte i, bool isValid) {
+  if (isValid) {
+    gauge->dfShadowValid |= 1 << i;
+  } else {
+    gauge->dfShadowValid &= ~(1 << i);
+  }
+}
+
+/**
+  @brief Serve the request from the shadow copy of the current gauge if the whole region is within the single valid entry.
+  @returns whether the data was taken from the shadow copy
+*/
+bool _dfShadowRead(word addr, byte *retval, int len) {
+  const Gauge *gauge = currentGauge();
+  for (byte i = 0; i < _DF_SHADOW_COUNT; i++) {
+    const _DfShadowParam &param = _DF_SHADOW_PARAMS[i];
+    if (!_isDfShadowValid(gauge, i) || addr < param.addr || addr + len > param.addr + param.size) continue;
+
+    memcpy(retval, gauge->dfShadow[i] + (addr - param.addr), len);
+    return true;
+  }
+  return false;
+}
+
+/**
+  @brief Remember all the shadowed parameters which are entirely within the response of the device.
+
+  The device always responds with the whole block starting from the requested address,
+  so the neighbouring parameters are shadowed by the same read.
+
+  @param addr - requested address
+  @param data - data bytes of the response
+  @param len - number of the data bytes
+*/
+void _dfShadowFill(word addr, const byte *data, int len) {
+  Gauge *gauge = currentGauge();
+  for (byte i = 0; i < _DF_SHADOW_COUNT; i++) {
+    const _DfShadowParam &param = _DF_SHADOW_PARAMS[i];
+    if (param.addr < addr || param.addr + param.size > addr + len) continue;
+
+    memcpy(gauge->dfShadow[i], data + (param.addr - addr), param.size);
+    _setDfShadowValid(gauge, i, true);
+  }
+}
+
+/**
+  @brief Forget the shadowed parameters overlapped by the written region.
+
+  The device may acknowledge the write and still reject it (read-only parameter, value out of range),
+  so the written value is not trusted: the entries become valid again only by the device read,
+  e.g. by the read-back of dfTransactionCommit().
+*/
+void _dfShadowInvalidate(word addr, int len) {
+  Gauge *gauge = currentGauge();
+  for (byte i = 0; i < _DF_SHADOW_COUNT; i++) {
+    const _DfShadowParam &param = _DF_SHADOW_PARAMS[i];
+    if (addr >= param.addr + param.size || addr + len <= param.addr) continue;  // no overlap
+
+    _setDfShadowValid(gauge, i, false);
+  }
+}
+
+/**
+  @brief Forget the shadow copy of the Data Flash parameters of the current gauge,
+  so they will be requested from the device on the next access.
+  @see DF_SHADOW
+*/
+void invalidateDfShadowCache() {
+  currentGauge()->dfShadowValid = 0;
+}
+
+/**
+  @brief Copy the valid shadowed parameters into the buffer, e.g. to keep them over the MCU reset.
+
+  Every parameter takes DF_SHADOW::SAVED_ENTRY_SIZE bytes: address LE and value.
+
+  @param size - size of the buffer, DF_SHADOW::SAVED_SIZE is enough
+  @returns number of the bytes written into the buffer
+*/
+int dfShadowSave(byte *retval, int size) {
+  const Gauge *gauge = currentGauge();
+  int len = 0;
+  for (byte i = 0; i < _DF_SHADOW_COUNT; i++) {
+    if (!_isDfShadowValid(gauge, i) || len + DF_SHADOW::SAVED_ENTRY_SIZE > size) continue;
+
+    retval[len] = _DF_SHADOW_PARAMS[i].addr & 0xFF;
+    retval[len + 1] = _DF_SHADOW_PARAMS[i].addr >> 8;
+    memcpy(retval + len + 2, gauge->dfShadow[i], DF_SHADOW::VALUE_MAX_SIZE);
+    len += DF_SHADOW::SAVED_ENTRY_SIZE;
+  }
+  return len;
+}
+
+/**
+  @brief Restore the shadowed parameters saved by dfShadowSave() into the current gauge.
+
+  The caller is responsible for the data to belong to this device, see warmStartRestore().
+  Saved addresses which are not shadowed are skipped.
+
+  @returns number of the restored parameters
+*/
+byte dfShadowRestore(const byte *data, int len) {
+  Gauge *gauge = currentGauge();
+  byte retval = 0;
+  for (int offset = 0; offset + DF_SHADOW::SAVED_ENTRY_SIZE <= len; offset += DF_SHADOW::SAVED_ENTRY_SIZE) {
+    const word addr = data[offset] | ((word) data[offset + 1] << 8);
+    for (byte i = 0; i < _DF_SHADOW_COUNT; i++) {
+      if (addr != _DF_SHADOW_PARAMS[i].addr) continue;
+
+      memcpy(gauge->dfShadow[i], data + offset + 2, DF_SHADOW::VALUE_MAX_SIZE);
+      _setDfShadowValid(gauge, i, true);
+      retval++;
+    }
+  }
+  return retval;
+}
+
+/**
+  @brief Request the Data Flash bytes from the device, bypassing the shadow copy.
+
+  The shadow copy is refreshed with the response.
+*/
+bool _dfReadDevice(word addr, byte *retval, int len) {
+  if (_isDeviceSealed()) return false;
+
+  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], _len = 0;
+  memset(buf, 0, sizeof(buf));
+  if (!AltManufacturerAccess(addr, buf, &_len)) {
+    invalidateSecurityModeCache();  // the mode could be changed, recheck it on the next access
+    return false;
+  }
+  _dfShadowFill(addr, buf, _len);
+
+  for (int i = 0; i < len; i++) retval[i] = buf[i];
+  return true;
+}
+
 /**
   @brief Read array of bytes from the Data Flash by address.
 
@@ -82,19 +265,49 @@ bool _isDeviceSealed() {
 
   Requested length should be in the range [1; 32]
 
+  The shadowed parameters are requested from the device only once, see DF_SHADOW.
+  The security mode is checked before the shadow copy, so nothing is served in the SEALED mode.
+
+  @returns whether the data was obtained
+
   @see AltManufacturerAccess()
   @see DF_ADDR::MIN
   @see DF_ADDR::MAX
   @see BlockProtocol
 */
-void dfReadBytes(word addr, byte *retval, int len) {
-  if (!_isAddrValid(addr) || !isAllowedRequestPayloadSize(len) || _isDeviceSealed()) return;
+bool dfReadBytes(word addr, byte *retval, int len) {
+  if (!_isAddrValid(addr) || !isAllowedRequestPayloadSize(len) || _isDeviceSealed()) return false;
+  if (_dfShadowRead(addr, retval, len)) return true;
+  return _dfReadDevice(addr, retval, len);
+}
+
+/**
+  @brief Same as dfReadBytes(), but nothing is printed, regardless of SILENCE and DEBUG.
+
+  The security mode is not checked, the caller should check it once before a series of reads.
+  Used where the output must not be broken by the text messages, e.g. the binary or CSV streams.
+
+  @returns whether the data was obtained
+
+  @see rawAltManufacturerAccess()
+  @see dfSnapshot()
+*/
+bool rawDfReadBytes(word addr, byte *retval, int len) {
+  if (addr < DF_ADDR::MIN || len <= 0 || len > BlockProtocol::PAYLOAD_MAX_SIZE || addr + len - 1 > DF_ADDR::MAX) {
+    return false;
+  }
+  if (_dfShadowRead(addr, retval, len)) return true;
 
   byte buf[BlockProtocol::RESPONSE_MAX_SIZE], _len = 0;
   memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(addr, buf, &_len)) return;
+  if (!rawAltManufacturerAccess(addr, buf, &_len)) {
+    invalidateSecurityModeCache();  // the mode could be changed, recheck it on the next access
+    return false;
+  }
+  _dfShadowFill(addr, buf, _len);
 
   for (int i = 0; i < len; i++) retval[i] = buf[i];
+  return true;
 }
 
 /**
@@ -127,6 +340,8 @@ void dfReadBytes(word addr, byte *retval, int len) {
   @param data - Array of data bytes.
   @param len - Length of the data.
 
+  The shadowed parameters overlapped by the written data are forgotten, see DF_SHADOW.
+
   @see StdCommands::ALT_MANUFACTURER_ACCESS
   @see StdCommands::MAC_DATA_CHECKSUM
 */
@@ -153,7 +368,9 @@ void dfWriteBytes(word addr, byte *data, int len) {
   // send the checksum and length at once:
   sendData(StdCommands::MAC_DATA_CHECKSUM, checksumAndLength, sizeof(checksumAndLength));
 
-  delay(200);
+  _dfShadowInvalidate(addr, len);
+
+  DRIVER_DELAY(200);
 }
 
 /**
@@ -244,21 +461,33 @@ void dfWriteU2(word addr, word value) {
 }
 
 /**
-  @brief Read String value from the Data Flash by address.
+  @brief Read String value from the Data Flash by address into the buffer.
+
+  The string in the Data Flash is stored as the length byte followed by the characters.
+  The result is always null-terminated and cut to fit the buffer.
+
+  @param retval - buffer for the string
+  @param size - size of the buffer including the terminating null
+  @returns length of the string in the buffer, or -1 if the request was not successful
+
   @see AltManufacturerAccess()
 */
-String dfReadString(word addr) {
-  if (!_isAddrValid(addr)) return;
+int dfReadString(word addr, char *retval, int size) {
+  if (size <= 0) return -1;
+  retval[0] = '\0';
+  if (!_isAddrValid(addr)) return -1;
 
   byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
   memset(buf, 0, sizeof(buf));
-  if (!AltManufacturerAccess(addr, buf, &len)) return "";
+  if (!AltManufacturerAccess(addr, buf, &len)) return -1;
 
-  const int str_len = buf[0];
-  char str[str_len + 1];  // len + '0'
-  for (int i = 0; i <= str_len; i++) str[i] = buf[1 + i];
+  int strLen = buf[0];
+  if (strLen > len - 1) strLen = len > 0 ? len - 1 : 0;
+  if (strLen > size - 1) strLen = size - 1;
 
-  return String(str);
+  for (int i = 0; i < strLen; i++) retval[i] = buf[1 + i];
+  retval[strLen] = '\0';
+  return strLen;
 }
 
 /**
@@ -266,15 +495,25 @@ String dfReadString(word addr) {
 
   I2C Configuration; Data; 0x4080; Device Name; S21
 
+  @param retval - buffer for the name, can be NULL if the name should be only printed
+  @param size - size of the buffer, DF_ADDR::DEVICE_NAME_SIZE is enough
+  @returns length of the name, or -1 if the request was not successful
+
   @see DF_ADDR::DEVICE_NAME
 */
-String dfDeviceName() {
-  const String retval = dfReadString(DF_ADDR::DEVICE_NAME);
+int dfDeviceName(char *retval, int size) {
+  char name[DF_ADDR::DEVICE_NAME_SIZE];
+  const int nameLen = dfReadString(DF_ADDR::DEVICE_NAME, name, sizeof(name));
   if (!SILENCE) {
     PGM_PRINT("=== Device Name: ");
-    Serial.println(retval);
+    Serial.println(name);
   }
-  return retval;
+
+  if (NULL != retval && size > 0) {
+    strncpy(retval, name, size - 1);
+    retval[size - 1] = '\0';
+  }
+  return nameLen;
 }
 
 /**
@@ -367,11 +606,7 @@ byte dfReadFetOptions() {
   if (!SILENCE) {
     printWordHex(PSTR("\n=== Data Flash [FET Options]"), addr);
     printByteBin(retval, true);
-    printFlag(retval, FetOptionsFlags::OTFET());  // Bit 2: OTFET—FET action in OVERTEMPERATURE mode
-    printFlag(retval, FetOptionsFlags::CHGSU());  // Bit 3: CHGSU—FET action in CHARGE SUSPEND mode
-    printFlag(retval, FetOptionsFlags::CHGIN());  // Bit 4: CHGIN—FET action in CHARGE INHIBIT mode
-    printFlag(retval, FetOptionsFlags::CHGFET());  // Bit 5: CHGFET—FET action on valid charge termination
-    printFlag(retval, FetOptionsFlags::SLEEPCHG());  // Bit 6: SLEEPCHG—CHG FET enabled during sleep
+    printFlags(retval, &FetOptionsFlags::TABLE);
   }
   return retval;
 }
@@ -409,10 +644,7 @@ byte dfReadDaConfiguration() {
   const byte retval = dfReadByte(DF_ADDR::DA_CONFIGURATION);
   if (!SILENCE) {
     printByteBin(retval, true);
-    printFlag(retval, DaConfigurationFlags::CC0());  // Bit 0: CC0—Cell Count
-    printFlag(retval, DaConfigurationFlags::IN_SYSTEM_SLEEP());  // Bit 3: IN_SYSTEM_SLEEP—In-system SLEEP mode
-    printFlag(retval, DaConfigurationFlags::SLEEP());  // Bit 4: SLEEP—SLEEP Mode
-    printFlag(retval, DaConfigurationFlags::CTEMP());  // Bit 6: CTEMP—Cell Temperature protection source
+    printFlags(retval, &DaConfigurationFlags::TABLE);
   }
   return retval;
 }
@@ -462,8 +694,7 @@ byte dfReadGasGaugingUpdateStatus() {
     Serial.print(bitRead(retval, GasGaugingUpdateStatusFlags::Update1().n));
     Serial.println(bitRead(retval, GasGaugingUpdateStatusFlags::Update0().n));
 
-    printFlag(retval, GasGaugingUpdateStatusFlags::Enable());  // Bit 2: Enable—Impedance Track gauging and lifetime updating is enabled
-    printFlag(retval, GasGaugingUpdateStatusFlags::QMax_update());  // Bit 3: QMax_update
+    printFlags(retval, &GasGaugingUpdateStatusFlags::TABLE, 2);  // from Enable (Bit 2), Update1, Update0 are printed above
   }
   return retval;
 }
@@ -507,21 +738,29 @@ void dfWriteGasGaugingUpdateStatus(byte updateStatus) {
   - Cell0 R_a flag: addr = 0x4100, data = 0xFF55 - Cell impedance never updated; Table being used;
   - Cell1 R_a flag: addr = 0x4140, data = 0xFF55 - Cell impedance never updated; Table being used;
   - xCell0 R_a flag: addr = 0x4180, data = 0xFFFF - Cell impedance never updated; Table never used;
-  - xCell0 R_a flag: addr = 0x41C0, data = 0xFFFF - Cell impedance never updated; Table never used;
+  - xCell1 R_a flag: addr = 0x41C0, data = 0xFFFF - Cell impedance never updated; Table never used;
+
+  The flags are written by the single Data Flash transaction: the flags that already have the default value
+  are not written, the written ones are verified by the read-back.
+
+  @returns number of the write transactions, or -1 if the flags could not be written, see dfTransactionCommit()
 
   @see DF_ADDR::CELL0_RA_FLAG
   @see DF_ADDR::CELL1_RA_FLAG
   @see DF_ADDR::X_CELL0_RA_FLAG
   @see DF_ADDR::X_CELL1_RA_FLAG
 */
-void dfResetRaTableFlags() {
-  const word TABLE_USED_NOT_UPDATED = 0xFF55;
-  const word TABLE_NOT_USED_NOT_UPDATED = 0xFFFF;
-
-  dfWriteWord(DF_ADDR::CELL0_RA_FLAG, TABLE_USED_NOT_UPDATED);  // Cell0 R_a flag
-  dfWriteWord(DF_ADDR::CELL1_RA_FLAG, TABLE_USED_NOT_UPDATED);  // Cell1 R_a flag
-  dfWriteWord(DF_ADDR::X_CELL0_RA_FLAG, TABLE_NOT_USED_NOT_UPDATED);  // xCell0 R_a flag
-  dfWriteWord(DF_ADDR::X_CELL1_RA_FLAG, TABLE_NOT_USED_NOT_UPDATED);  // xCell0 R_a flag
+int dfResetRaTableFlags() {
+  const word TABLE_USED_NOT_UPDATED = (RA_TABLE::IMPEDANCE_NEVER_UPDATED << 8) | RA_TABLE::TABLE_USED;  // 0xFF55
+  const word TABLE_NOT_USED_NOT_UPDATED = (RA_TABLE::IMPEDANCE_NEVER_UPDATED << 8) | RA_TABLE::TABLE_NEVER_USED;  // 0xFFFF
+
+  DfTransaction tx;
+  dfTransactionBegin(&tx);
+  dfTransactionSetWord(&tx, DF_ADDR::CELL0_RA_FLAG, TABLE_USED_NOT_UPDATED);  // Cell0 R_a flag
+  dfTransactionSetWord(&tx, DF_ADDR::CELL1_RA_FLAG, TABLE_USED_NOT_UPDATED);  // Cell1 R_a flag
+  dfTransactionSetWord(&tx, DF_ADDR::X_CELL0_RA_FLAG, TABLE_NOT_USED_NOT_UPDATED);  // xCell0 R_a flag
+  dfTransactionSetWord(&tx, DF_ADDR::X_CELL1_RA_FLAG, TABLE_NOT_USED_NOT_UPDATED);  // xCell1 R_a flag
+  return dfTransactionCommit(&tx);
 }
 
 /**
@@ -545,6 +784,377 @@ void dfReadAllData() {
   }
 }
 
+/**
+  Write the rest of the frame into the output.
+
+  @param pending - number of the bytes at the end of the frame that are not written yet, updated by the function
+  @param blocking - false = write only as many bytes as the output can take without blocking
+*/
+void _dfSnapshotWrite(Print &out, const byte *frame, int *pending, bool blocking) {
+  if (*pending <= 0) return;
+
+  int n = *pending;
+  if (!blocking) n = min(n, out.availableForWrite());
+  if (n <= 0) return;
+
+  out.write(frame + DF_SNAPSHOT::ROW_FRAME_SIZE - *pending, n);
+  *pending -= n;
+}
+
+/**
+  @brief Stream the full Data Flash into the output in the compact binary frames.
+
+  Reading and output are pipelined with two row buffers: while the next row is being read over I2C,
+  the output (e.g. the Serial TX buffer) is drained in the background, and only as many bytes
+  as the output can take without blocking are written in between. The output is written in a blocking way
+  only when the both buffers are full.
+  If the output does not report availableForWrite(), each row is written in a blocking way.
+
+  The security mode is checked once before the header, the rows are read by rawDfReadBytes(),
+  so the failed row is recorded as DF_SNAPSHOT::SYNC_ROW_FAILED and no text message breaks the frames.
+
+  @param out - destination of the frames, Serial by default
+  @returns number of the rows successfully read, or -1 if the device is SEALED
+
+  @see DF_SNAPSHOT
+  @see dfReadAllData()
+  @see extras/data_flash/data_flash.py load_dump_binary()
+*/
+int dfSnapshot(Print &out) {
+  if (_isDeviceSealed()) return -1;
+
+  const byte header[DF_SNAPSHOT::HEADER_SIZE] = {
+    'D', 'F', DF_SNAPSHOT::VERSION, DF_SNAPSHOT::ROW_SIZE,
+    DF_ADDR::MIN & 0xFF, (DF_ADDR::MIN >> 8) & 0xFF,
+    DF_SNAPSHOT::ROWS & 0xFF, (DF_SNAPSHOT::ROWS >> 8) & 0xFF
+  };
+  out.write(header, sizeof(header));
+
+  byte frames[2][DF_SNAPSHOT::ROW_FRAME_SIZE];
+  int pending[2] = {0, 0};  // number of the bytes of the frame not written yet
+  word rowsRead = 0;
+
+  for (word row = 0; row < DF_SNAPSHOT::ROWS; row++) {
+    const byte cur = row & 1, prev = cur ^ 1;
+    byte *frame = frames[cur];
+
+    const word addr = DF_ADDR::MIN + row * DF_SNAPSHOT::ROW_SIZE;
+    memset(frame, 0, DF_SNAPSHOT::ROW_FRAME_SIZE);
+    frame[1] = addr & 0xFF;
+    frame[2] = (addr >> 8) & 0xFF;
+
+    const bool isRead = rawDfReadBytes(addr, frame + 3, DF_SNAPSHOT::ROW_SIZE);
+    if (isRead) rowsRead++;
+    frame[0] = isRead ? DF_SNAPSHOT::SYNC_ROW : DF_SNAPSHOT::SYNC_ROW_FAILED;
+
+    const word crc = crc16(frame + 1, 2 + DF_SNAPSHOT::ROW_SIZE);
+    frame[DF_SNAPSHOT::ROW_FRAME_SIZE - 2] = crc & 0xFF;
+    frame[DF_SNAPSHOT::ROW_FRAME_SIZE - 1] = (crc >> 8) & 0xFF;
+    pending[cur] = DF_SNAPSHOT::ROW_FRAME_SIZE;
+
+    // the previous frame must be written before its buffer is taken by the next row
+    _dfSnapshotWrite(out, frames[prev], &pending[prev], true);
+    _dfSnapshotWrite(out, frame, &pending[cur], false);
+  }
+  _dfSnapshotWrite(out, frames[(DF_SNAPSHOT::ROWS - 1) & 1], &pending[(DF_SNAPSHOT::ROWS - 1) & 1], true);
+
+  const byte end[DF_SNAPSHOT::END_SIZE] = {DF_SNAPSHOT::SYNC_END, (byte)(rowsRead & 0xFF), (byte)(rowsRead >> 8)};
+  out.write(end, sizeof(end));
+  return rowsRead;
+}
+
+/**
+  Copy a part of the image from RAM or PROGMEM.
+*/
+void _dfImageRead(const byte *image, bool isProgmem, int from, byte *retval, int len) {
+  if (isProgmem) memcpy_P(retval, image + from, len);
+  else memcpy(retval, image + from, len);
+}
+
+/**
+  @brief Ranges of the Data Flash maintained by the device itself, the default skip list of dfApplyImage().
+  @see DF_DEVICE_MAINTAINED_COUNT
+*/
+const DfRange DF_DEVICE_MAINTAINED[DF_DEVICE_MAINTAINED_COUNT] PROGMEM = {
+  {0x4061, 10},  // System Data; Integrity: DF signatures, I2C Configuration; Data: Manufacture Date, Serial Number
+  {DF_ADDR::CELL0_RA_FLAG, 256},  // Ra Table: R_a0, R_a1, R_a0x, R_a1x
+  {DF_ADDR::Q_MAX_CELL_1, 0x4242 - DF_ADDR::Q_MAX_CELL_1},  // Gas Gauging; State: from Qmax Cell 1 till Cycle Count
+  {0x4280, 128},  // Lifetimes, PF Status
+};
+
+word _dfApplyImageFailedAddr = 0;
+
+/**
+  @brief Address of the window at which the last dfApplyImage() has failed, 0 if it has not failed.
+*/
+word dfApplyImageFailedAddr() {
+  return _dfApplyImageFailedAddr;
+}
+
+/**
+  Replace the skipped bytes of the target by the current ones, so they are never changed.
+  @param skip - list of the ranges in PROGMEM
+*/
+void _dfImageKeep(word addr, const byte *current, byte *target, int len, const DfRange *skip, byte skipCount) {
+  for (byte i = 0; i < skipCount; i++) {
+    DfRange range;
+    memcpy_P(&range, skip + i, sizeof(range));
+    for (int j = 0; j < len; j++) {
+      const word a = addr + j;
+      if (a >= range.addr && a - range.addr < range.size) target[j] = current[j];
+    }
+  }
+}
+
+/**
+  @see dfApplyImage()
+*/
+int _dfApplyImage(word addr, const byte *image, int len, bool isProgmem, const DfRange *skip, byte skipCount) {
+  _dfApplyImageFailedAddr = 0;
+  if (!_isRequestRegionValid(addr, len) || _isDeviceSealed()) return -1;
+
+  static const int WINDOW_SIZE = BlockProtocol::PAYLOAD_MAX_SIZE;  // 32
+  byte current[WINDOW_SIZE], target[WINDOW_SIZE];
+
+  int writes = 0;
+  int pos = 0;
+  int kept = 0;  // number of the bytes at the start of the window left from the previous read
+  bool isAligned = false;  // whether the window starts from the changed byte
+  while (pos < len) {
+    const int size = min(WINDOW_SIZE, len - pos);
+    if (kept < size) {
+      if (!dfReadBytes(addr + pos + kept, current + kept, size - kept)) {
+        _dfApplyImageFailedAddr = addr + pos + kept;
+        return -1;
+      }
+      _dfImageRead(image, isProgmem, pos + kept, target + kept, size - kept);
+      _dfImageKeep(addr + pos + kept, current + kept, target + kept, size - kept, skip, skipCount);
+    }
+
+    int first = 0;
+    while (first < size && current[first] == target[first]) first++;
+    if (first == size) {  // the window already matches
+      pos += size;
+      kept = 0;
+      isAligned = false;
+      continue;
+    }
+    if (first > 0 && !isAligned) {  // move the window to the first changed byte to take as many changes as possible
+      kept = size - first;
+      memmove(current, current + first, kept);
+      memmove(target, target + first, kept);
+      pos += first;
+      isAligned = true;
+      continue;
+    }
+
+    int last = size - 1;
+    while (current[last] == target[last]) last--;
+
+    dfWriteBytes(addr + pos, target, last + 1);
+    writes++;
+
+    // verify by the device, not by the shadow copy which has been updated by the write,
+    // the skipped bytes between the changes could be updated by the device meanwhile:
+    const bool isRead = _dfReadDevice(addr + pos, current, last + 1);
+    if (isRead) _dfImageKeep(addr + pos, current, target, last + 1, skip, skipCount);
+    if (!isRead || 0 != memcmp(current, target, last + 1)) {
+      _dfApplyImageFailedAddr = addr + pos;
+      if (!SILENCE) {
+        PGM_PRINT("[!] Data Flash verification failed at ");
+        printWordHex(addr + pos, true);
+      }
+      return -1;
+    }
+
+    pos += size;
+    kept = 0;
+    isAligned = false;
+  }
+
+  return writes;
+}
+
+/**
+  @brief Bring the Data Flash region into the state of the target image, writing only the changed bytes.
+
+  The image has the same layout as the dump of dfReadAllData(): one byte per address starting from addr.
+
+  The current content is read by 32-byte windows. A window which already matches the image is skipped.
+  Otherwise the window is moved to the first changed byte, and all changed bytes within the next 32 bytes
+  are written by the single dfWriteBytes() transaction, including the matching bytes between them.
+  Every written span is verified by the read-back.
+
+  [!] The image of another pack holds its own learned data: Qmax, R_a tables, Cycle Count, Serial Number.
+  Such bytes are kept by the skip list, DF_DEVICE_MAINTAINED by default; the bytes of the skip list
+  between the changes are rewritten with their current values.
+  Pass NULL to apply the whole image, the bytes refused by the device then fail the verification.
+
+  The function stops at the first failed window, the windows before it are already written,
+  see dfApplyImageFailedAddr().
+
+  @param addr - Data Flash address of the first byte of the image.
+  @param image - Target content of the Data Flash.
+  @param len - Length of the image.
+  @param skip - Ranges which are never changed, in PROGMEM; NULL = none.
+  @param skipCount - Number of the ranges.
+  @returns number of the write transactions, or -1 if the region is invalid, the device is SEALED,
+           a window could not be read or the read-back does not match
+
+  @see dfApplyImage_P()
+  @see dfWriteBytes()
+  @see DF_DEVICE_MAINTAINED
+  @see BlockProtocol::PAYLOAD_MAX_SIZE
+*/
+int dfApplyImage(word addr, const byte *image, int len, const DfRange *skip, byte skipCount) {
+  return _dfApplyImage(addr, image, len, false, skip, skipCount);
+}
+
+/**
+  @brief Same as dfApplyImage(), but the image is stored in PROGMEM.
+  @see dfApplyImage()
+*/
+int dfApplyImage_P(word addr, PGM_P image, int len, const DfRange *skip, byte skipCount) {
+  return _dfApplyImage(addr, (const byte*) image, len, true, skip, skipCount);
+}
+
+/**
+  @brief Start the new Data Flash transaction, all staged edits are dropped.
+  @see DF_TRANSACTION
+*/
+void dfTransactionBegin(DfTransaction *tx) {
+  tx->count = 0;
+  tx->isOverflow = false;
+}
+
+/**
+  @brief Stage replacement of the masked bits of the Data Flash byte.
+
+  Edits of the same byte are merged, the later one wins.
+
+  @returns false if the address is invalid or there is no room for the edit, the whole transaction is rejected then
+*/
+bool dfTransactionSetBits(DfTransaction *tx, word addr, byte mask, byte value) {
+  if (!_isAddrValid(addr)) {
+    tx->isOverflow = true;
+    return false;
+  }
+
+  // keep the edits sorted by address, so the commit can group them by windows:
+  byte i = 0;
+  while (i < tx->count && tx->edits[i].addr < addr) i++;
+
+  if (i < tx->count && tx->edits[i].addr == addr) {
+    DfEdit &edit = tx->edits[i];
+    edit.value = (edit.value & ~mask) | (value & mask);
+    edit.mask |= mask;
+    return true;
+  }
+
+  if (tx->count >= DF_TRANSACTION::MAX_EDITS) {
+    PGM_PRINTLN("[!] Too many Data Flash edits in the transaction.");
+    tx->isOverflow = true;
+    return false;
+  }
+
+  for (byte j = tx->count; j > i; j--) tx->edits[j] = tx->edits[j - 1];
+  tx->edits[i].addr = addr;
+  tx->edits[i].mask = mask;
+  tx->edits[i].value = value & mask;
+  tx->count++;
+  return true;
+}
+
+/**
+  @brief Stage the bit value of the Data Flash byte.
+  @param n - number of the bit, [0; 7]
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetBit(DfTransaction *tx, word addr, byte n, bool value) {
+  const byte mask = 1 << n;
+  return dfTransactionSetBits(tx, addr, mask, value ? mask : 0);
+}
+
+/**
+  @brief Stage the U1/H1 value.
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetByte(DfTransaction *tx, word addr, byte value) {
+  return dfTransactionSetBits(tx, addr, 0xFF, value);
+}
+
+/**
+  @brief Stage the word value (I2, U2, H2), order of bytes should be Normal.
+
+  The value is stored in the Data Flash in Little Endian.
+
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetWord(DfTransaction *tx, word addr, word value) {
+  return dfTransactionSetByte(tx, addr, value & 0xFF)
+         && dfTransactionSetByte(tx, addr + 1, (value >> 8) & 0xFF);
+}
+
+/**
+  @brief Write all staged edits to the Data Flash.
+
+  The edits are grouped by 32-byte windows starting from the lowest staged address.
+  Per window: one read, one write of the changed bytes (skipped if nothing changes) and one read-back.
+
+  The staged edits are kept, so the failed transaction can be committed again.
+
+  @returns number of the write transactions, or -1 if a window could not be read,
+           the read-back does not match, or the transaction was rejected
+
+  @see DF_TRANSACTION
+*/
+int dfTransactionCommit(DfTransaction *tx) {
+  if (tx->isOverflow) return -1;
+
+  const byte WINDOW_SIZE = DF_TRANSACTION::WINDOW_SIZE;
+  byte current[WINDOW_SIZE], target[WINDOW_SIZE];
+
+  int writes = 0;
+  byte i = 0;
+  while (i < tx->count) {
+    const word windowAddr = tx->edits[i].addr;
+
+    byte end = i;  // the first edit out of the window
+    while (end < tx->count && tx->edits[end].addr - windowAddr < WINDOW_SIZE) end++;
+    const byte size = tx->edits[end - 1].addr - windowAddr + 1;
+
+    if (!dfReadBytes(windowAddr, current, size)) return -1;
+    memcpy(target, current, size);
+    for (byte j = i; j < end; j++) {
+      const DfEdit &edit = tx->edits[j];
+      byte &b = target[edit.addr - windowAddr];
+      b = (b & ~edit.mask) | edit.value;
+    }
+
+    int first = 0, last = size - 1;
+    while (first < size && current[first] == target[first]) first++;
+    if (first < size) {
+      while (current[last] == target[last]) last--;
+
+      dfWriteBytes(windowAddr + first, target + first, last - first + 1);
+      writes++;
+
+      // verify by the device, not by the shadow copy which has been updated by the write:
+      if (!_dfReadDevice(windowAddr, current, size) || 0 != memcmp(current, target, size)) {
+        if (!SILENCE) {
+          PGM_PRINT("[!] Data Flash verification failed at ");
+          printWordHex(windowAddr, true);
+        }
+        return -1;
+      }
+    }
+
+    i = end;
+  }
+
+  return writes;
+}
+
 /**
   @brief Print data from R_a table.
 
@@ -580,6 +1190,94 @@ void dfPrintRaTable() {
   }
 }
 
+/**
+  Addresses of the R_a table blocks in the order of RA_TABLE::CELL0 ... RA_TABLE::X_CELL1.
+*/
+const word _RA_BLOCK_ADDR[RA_TABLE::BLOCKS] PROGMEM = {
+  DF_ADDR::CELL0_RA_FLAG,
+  DF_ADDR::CELL1_RA_FLAG,
+  DF_ADDR::X_CELL0_RA_FLAG,
+  DF_ADDR::X_CELL1_RA_FLAG
+};
+
+/**
+  @brief Clear the snapshot, so the next dfRaTableUpdate() reads all blocks.
+
+  Call it also after the table was written, e.g. by dfResetRaTableFlags().
+*/
+void dfRaTableBegin(RaTable *table) {
+  memset(table, 0, sizeof(RaTable));
+}
+
+/**
+  @brief Refresh the snapshot of the R_a table if the device has updated it or the snapshot is too old.
+
+  One GaugingStatus() MAC transaction if nothing has changed, four Data Flash reads otherwise.
+
+  @param maxAgeMs - the blocks are requested if the snapshot is older, ms;
+                   0 = only by the toggles, which miss an even number of updates and the status changes without an update
+
+  @returns bitmask of the blocks that changed (bit RA_TABLE::CELL0 ... RA_TABLE::X_CELL1), 0 if none,
+           -1 if the device could not be read (e.g. SEALED), the snapshot is requested again on the next call
+
+  @see RA_TABLE
+*/
+int dfRaTableUpdate(RaTable *table, unsigned long maxAgeMs) {
+  u32 gaugingStatus = 0;
+  if (!rawGaugingStatus(&gaugingStatus)) return -1;
+
+  // RX (Bit 18) and QMax (Bit 17) are adjacent
+  const byte toggles = (gaugingStatus >> GaugingStatusFlags::QMax().n) & 0b11;
+  const bool isExpired = 0 != maxAgeMs && millis() - table->timestamp >= maxAgeMs;
+  if (table->isValid && toggles == table->toggles && !isExpired) return 0;
+
+  int retval = 0;
+  byte buf[RA_TABLE::BLOCK_SIZE];
+  for (byte i = 0; i < RA_TABLE::BLOCKS; i++) {
+    if (!dfReadBytes(pgm_read_word(&_RA_BLOCK_ADDR[i]), buf, sizeof(buf))) {
+      table->isValid = false;
+      return -1;
+    }
+
+    RaTableBlock block;
+    const word flag = composeWord(buf);
+    block.status = flag >> 8;
+    block.usage = flag & 0xFF;
+    for (byte row = 0; row < RA_TABLE::ROWS; row++) block.rows[row] = (int16_t) composeWord(buf, 2 + 2 * row);
+
+    if (!table->isValid || memcmp(&block, &table->blocks[i], sizeof(block))) {
+      table->blocks[i] = block;
+      retval |= 1 << i;
+    }
+  }
+
+  table->isValid = true;
+  table->toggles = toggles;
+  table->timestamp = millis();
+  return retval;
+}
+
+/**
+  @brief Print the decoded snapshot of the R_a table: the flag bytes and 15 rows per block.
+*/
+void dfPrintRaTable(const RaTable *table) {
+  for (byte i = 0; i < RA_TABLE::BLOCKS; i++) {
+    const RaTableBlock *block = &table->blocks[i];
+
+    printWordHex(pgm_read_word(&_RA_BLOCK_ADDR[i]));
+    PGM_PRINT(": status ");
+    printByteHex(block->status);
+    PGM_PRINT(", usage ");
+    printByteHex(block->usage);
+    PGM_PRINT(", rows:");
+    for (byte row = 0; row < RA_TABLE::ROWS; row++) {
+      Serial.print(' ');
+      Serial.print(block->rows[row]);
+    }
+    Serial.println();
+  }
+}
+
 /**
   @brief Advanced Charge Algorithm; Termination Config; 0x4693; Charge Term Taper Current; I2
   @see DF_ADDR::CHARGE_TERM_TAPER_CURRENT
@@ -603,15 +1301,19 @@ void dfWriteTaperCurrent(int taperCurrent) {
   - 0 = FET active
   - 1 = Charging or precharging disabled, FET off
 
+  The bit is written only if it differs, and is verified by the read-back.
+
+  @returns number of the write transactions, or -1 if the bit could not be written, see dfTransactionCommit()
+
   @see DF_ADDR::FET_OPTIONS
   @see FetOptionsFlags::CHGFET()
+  @see dfTransactionCommit()
 */
-void dfWriteFetOptionsCHGFET(bool chgFetBitValue) {
-  byte fetOptions = dfReadByte(DF_ADDR::FET_OPTIONS);
-  const byte _fetOptions = fetOptions;
-  bitWrite(fetOptions, FetOptionsFlags::CHGFET().n, chgFetBitValue);
-  if (_fetOptions == fetOptions) return;
-  dfWriteByte(DF_ADDR::FET_OPTIONS, fetOptions);
+int dfWriteFetOptionsCHGFET(bool chgFetBitValue) {
+  DfTransaction tx;
+  dfTransactionBegin(&tx);
+  dfTransactionSetBit(&tx, DF_ADDR::FET_OPTIONS, FetOptionsFlags::CHGFET().n, chgFetBitValue);
+  return dfTransactionCommit(&tx);
 }
 
 /**
@@ -666,16 +1368,7 @@ word dfReadSocFlagConfigA() {
   if (!SILENCE) {
     printWordHex(PSTR("\n=== Data Flash [SOC Flag Config A]"), addr);
     printWordBin(retval, true);
-    printFlag(retval, SOCFlagConfigAFlags::TDSETV());  // Bit 0: TDSETV - Enables the TD flag set by the cell voltage threshold
-    printFlag(retval, SOCFlagConfigAFlags::TDCLEARV());  // Bit 1: TDCLEARV - Enables the TD flag clear by cell voltage threshold
-    printFlag(retval, SOCFlagConfigAFlags::TDSETRSOC());  // Bit 2: TDSETRSOC - Enables the TD flag set by RSOC threshold
-    printFlag(retval, SOCFlagConfigAFlags::TDCLEARRSOC());  // Bit 3: TDCLEARRSOC - Enables the TD flag cleared by the RSOC threshold
-    printFlag(retval, SOCFlagConfigAFlags::TCSETV());  // Bit 4: TCSETV - Enables the TC flag set by cell voltage threshold
-    printFlag(retval, SOCFlagConfigAFlags::TCCLEARV());  // Bit 5: TCCLEARV - Enables the TC flag clear by cell voltage threshold
-    printFlag(retval, SOCFlagConfigAFlags::TCSETRSOC());  // Bit 6: TCSETRSOC - Enables the TC flag set by the RSOC threshold
-    printFlag(retval, SOCFlagConfigAFlags::TCCLEARRSOC());  // Bit 7: TCCLEARRSOC - Enables the TC flag cleared by the RSOC threshold
-    printFlag(retval, SOCFlagConfigAFlags::FCSETVCT());  // Bit 10: FCSETVCT - Enables the FC flag set by primary charge termination
-    printFlag(retval, SOCFlagConfigAFlags::TCSETVCT());  // Bit 11: TCSETVCT - Enables the TC flag set by primary charge termination
+    printFlags(retval, &SOCFlagConfigAFlags::TABLE);
   }
   return retval;
 }
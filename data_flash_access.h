@@ -61,6 +61,8 @@ class DF_ADDR {
     static const word MIN = 0x4000;  ///< Minimum Data Flash address.
     static const word MAX = 0x5FFF;  ///< Maximum Data Flash address.
 
+    static const word MANUFACTURE_DATE = 0x4067;  ///< I2C Configuration; Data; Manufacture Date; U2
+    static const word SERIAL_NUMBER = 0x4069;  ///< I2C Configuration; Data; Serial Number; H2
     /**
       @retval JBL: XTREME2
     */
@@ -69,6 +71,7 @@ class DF_ADDR {
       @retval JBL: ID1019-A-M26-28z610
     */
     static const word DEVICE_NAME = 0x4080;  ///< I2C Configuration; Data; Device Name; S21
+    static const byte DEVICE_NAME_SIZE = 21;  ///< Buffer for the Device Name: S21 is the length byte and up to 20 characters, plus the terminating null.
     /**
       @retval JBL: 1352 - this is ID of the type for the Li-Ion battery
     */
@@ -214,6 +217,117 @@ class DF_ADDR {
     static const word X_CELL1_RA_FLAG = 0x41C0;  ///< Ra Table; R_a1x; 0x41C0; xCell1 R_a flag; H2
 };
 
+/**
+  @brief Binary framing of the Data Flash snapshot
+
+  All multi-byte values are in Little Endian.
+
+  Header, 8 bytes:
+  - 'D', 'F' - magic
+  - version
+  - row size, 32
+  - address of the first row, 2 bytes
+  - number of the rows, 2 bytes
+
+  Row, 37 bytes:
+  - sync byte 0xA5 if the row was read, or 0xAF if the device did not respond
+  - row address, 2 bytes
+  - 32 data bytes
+  - CRC16 of the address and data bytes, 2 bytes
+
+  End, 3 bytes:
+  - sync byte 0x5A
+  - number of the rows successfully read, 2 bytes
+
+  @see dfSnapshot()
+  @see crc16()
+*/
+class DF_SNAPSHOT {
+  public:
+    static const byte VERSION = 1;
+    static const byte ROW_SIZE = BlockProtocol::PAYLOAD_MAX_SIZE;  ///< 32
+    static const word ROWS = (DF_ADDR::MAX - DF_ADDR::MIN + 1) / ROW_SIZE;  ///< 256
+
+    static const byte HEADER_SIZE = 8;
+    static const byte ROW_FRAME_SIZE = 1 + 2 + ROW_SIZE + 2;  ///< sync + address + data + CRC16, 37
+    static const byte END_SIZE = 3;
+
+    static const byte SYNC_ROW = 0xA5;  ///< The row data is valid.
+    static const byte SYNC_ROW_FAILED = 0xAF;  ///< The row could not be read, the data bytes are zeroes.
+    static const byte SYNC_END = 0x5A;
+};
+
+/**
+  @brief Forget the shadow copy of the Data Flash parameters of the current gauge,
+  so they will be requested from the device on the next access.
+  @see DF_SHADOW
+*/
+void invalidateDfShadowCache();
+
+/**
+  @brief Copy the valid shadowed parameters into the buffer, e.g. to keep them over the MCU reset.
+
+  Every parameter takes DF_SHADOW::SAVED_ENTRY_SIZE bytes: address LE and value.
+
+  @param size - size of the buffer, DF_SHADOW::SAVED_SIZE is enough
+  @returns number of the bytes written into the buffer
+*/
+int dfShadowSave(byte *retval, int size);
+
+/**
+  @brief Restore the shadowed parameters saved by dfShadowSave() into the current gauge.
+
+  The caller is responsible for the data to belong to this device, see warmStartRestore().
+  Saved addresses which are not shadowed are skipped.
+
+  @returns number of the restored parameters
+*/
+byte dfShadowRestore(const byte *data, int len);
+
+/**
+  @brief Staged edits of the Data Flash committed by the minimal number of the write transactions
+
+  Every edit replaces the masked bits of the single byte, so several bitfields and values
+  can be staged without reading the device. The commit reads the current content once per 32-byte window,
+  applies the edits, writes all changed bytes of the window by the single dfWriteBytes()
+  and verifies the window by the single read-back.
+
+  Usage:
+  <pre>
+    DfTransaction tx;
+    dfTransactionBegin(&tx);
+    dfTransactionSetBit(&tx, DF_ADDR::FET_OPTIONS, FetOptionsFlags::CHGFET().n, true);
+    dfTransactionSetByte(&tx, DF_ADDR::TC_SET_RSOC_THRESHOLD, 60);
+    dfTransactionSetByte(&tx, DF_ADDR::TC_CLEAR_RSOC_THRESHOLD, 55);
+    dfTransactionCommit(&tx);
+  </pre>
+
+  @see dfApplyImage()
+*/
+class DF_TRANSACTION {
+  public:
+    static const byte MAX_EDITS = 16;  ///< bytes which can be staged by the single transaction
+    static const byte WINDOW_SIZE = BlockProtocol::PAYLOAD_MAX_SIZE;  ///< 32
+};
+
+/**
+  @brief Masked edit of the single Data Flash byte.
+*/
+struct DfEdit {
+  word addr;
+  byte mask;  ///< bits to be replaced
+  byte value;
+};
+
+/**
+  @brief Data Flash transaction, see DF_TRANSACTION.
+*/
+struct DfTransaction {
+  byte count;
+  bool isOverflow;  ///< an edit was rejected, the transaction will not be committed
+  DfEdit edits[DF_TRANSACTION::MAX_EDITS];
+};
+
 /**
   @brief Read array of bytes from the Data Flash by address.
 
@@ -221,12 +335,30 @@ class DF_ADDR {
 
   Requested length should be in the range [1; 32]
 
+  The shadowed parameters are requested from the device only once, see DF_SHADOW.
+  The security mode is checked before the shadow copy, so nothing is served in the SEALED mode.
+
+  @returns whether the data was obtained
+
   @see AltManufacturerAccess()
   @see DF_ADDR::MIN
   @see DF_ADDR::MAX
   @see BlockProtocol
 */
-void dfReadBytes(word addr, byte *retval, int len);
+bool dfReadBytes(word addr, byte *retval, int len);
+
+/**
+  @brief Same as dfReadBytes(), but nothing is printed, regardless of SILENCE and DEBUG.
+
+  The security mode is not checked, the caller should check it once before a series of reads.
+  Used where the output must not be broken by the text messages, e.g. the binary or CSV streams.
+
+  @returns whether the data was obtained
+
+  @see rawAltManufacturerAccess()
+  @see dfSnapshot()
+*/
+bool rawDfReadBytes(word addr, byte *retval, int len);
 
 /**
   @brief Write array of data to the Data Flash.
@@ -258,6 +390,8 @@ void dfReadBytes(word addr, byte *retval, int len);
   @param data - Array of data bytes.
   @param len - Length of the data.
 
+  The shadowed parameters overlapped by the written data are forgotten, see DF_SHADOW.
+
   @see StdCommands::ALT_MANUFACTURER_ACCESS
   @see StdCommands::MAC_DATA_CHECKSUM
 */
@@ -325,19 +459,31 @@ word dfReadU2(word addr);
 void dfWriteU2(word addr, word value);
 
 /**
-  @brief Read String value from the Data Flash by address.
+  @brief Read String value from the Data Flash by address into the buffer.
+
+  The string in the Data Flash is stored as the length byte followed by the characters.
+  The result is always null-terminated and cut to fit the buffer.
+
+  @param retval - buffer for the string
+  @param size - size of the buffer including the terminating null
+  @returns length of the string in the buffer, or -1 if the request was not successful
+
   @see AltManufacturerAccess()
 */
-String dfReadString(word addr);
+int dfReadString(word addr, char *retval, int size);
 
 /**
   @brief Read the Device Name from the Data Flash.
 
   I2C Configuration; Data; 0x4080; Device Name; S21
 
+  @param retval - buffer for the name, can be NULL if the name should be only printed
+  @param size - size of the buffer, DF_ADDR::DEVICE_NAME_SIZE is enough
+  @returns length of the name, or -1 if the request was not successful
+
   @see DF_ADDR::DEVICE_NAME
 */
-String dfDeviceName();
+int dfDeviceName(char *retval = NULL, int size = 0);
 
 /**
   @brief Read the Design Capacity in mAh from the Data Flash.
@@ -420,10 +566,15 @@ byte dfReadFetOptions();
   - 0 = FET active
   - 1 = Charging or precharging disabled, FET off
 
+  The bit is written only if it differs, and is verified by the read-back.
+
+  @returns number of the write transactions, or -1 if the bit could not be written, see dfTransactionCommit()
+
   @see DF_ADDR::FET_OPTIONS
   @see FetOptionsFlags::CHGFET()
+  @see dfTransactionCommit()
 */
-void dfWriteFetOptionsCHGFET(bool chgFetBitValue);
+int dfWriteFetOptionsCHGFET(bool chgFetBitValue);
 
 /**
   @brief Settings; Configuration; 0x469B; DA Configuration; H1
@@ -524,6 +675,147 @@ void dfWriteGasGaugingUpdateStatus(byte updateStatus);
 */
 void dfReadAllData();
 
+/**
+  @brief Stream the full Data Flash into the output in the compact binary frames.
+
+  Reading and output are pipelined with two row buffers: while the next row is being read over I2C,
+  the output (e.g. the Serial TX buffer) is drained in the background, and only as many bytes
+  as the output can take without blocking are written in between. The output is written in a blocking way
+  only when the both buffers are full.
+  If the output does not report availableForWrite(), each row is written in a blocking way.
+
+  The security mode is checked once before the header, the rows are read by rawDfReadBytes(),
+  so the failed row is recorded as DF_SNAPSHOT::SYNC_ROW_FAILED and no text message breaks the frames.
+
+  @param out - destination of the frames, Serial by default
+  @returns number of the rows successfully read, or -1 if the device is SEALED
+
+  @see DF_SNAPSHOT
+  @see dfReadAllData()
+  @see extras/data_flash/data_flash.py load_dump_binary()
+*/
+int dfSnapshot(Print &out = Serial);
+
+/**
+  @brief Range of the Data Flash addresses.
+*/
+struct DfRange {
+  word addr;
+  word size;
+};
+
+/**
+  @brief Number of the ranges in DF_DEVICE_MAINTAINED.
+*/
+const byte DF_DEVICE_MAINTAINED_COUNT = 4;
+
+/**
+  @brief Ranges of the Data Flash maintained by the device itself, in PROGMEM.
+
+  - System Data; Integrity: DF signatures, I2C Configuration; Data: Manufacture Date, Serial Number;
+  - Ra Table: R_a0, R_a1, R_a0x, R_a1x;
+  - Gas Gauging; State: from Qmax Cell 1 till Cycle Count;
+  - Lifetimes, PF Status.
+
+  @see dfApplyImage()
+*/
+extern const DfRange DF_DEVICE_MAINTAINED[DF_DEVICE_MAINTAINED_COUNT];
+
+/**
+  @brief Bring the Data Flash region into the state of the target image, writing only the changed bytes.
+
+  The image has the same layout as the dump of dfReadAllData(): one byte per address starting from addr.
+
+  The current content is read by 32-byte windows. A window which already matches the image is skipped.
+  Otherwise the window is moved to the first changed byte, and all changed bytes within the next 32 bytes
+  are written by the single dfWriteBytes() transaction, including the matching bytes between them.
+  Every written span is verified by the read-back.
+
+  [!] The image of another pack holds its own learned data: Qmax, R_a tables, Cycle Count, Serial Number.
+  Such bytes are kept by the skip list, DF_DEVICE_MAINTAINED by default; the bytes of the skip list
+  between the changes are rewritten with their current values.
+  Pass NULL to apply the whole image, the bytes refused by the device then fail the verification.
+
+  The function stops at the first failed window, the windows before it are already written,
+  see dfApplyImageFailedAddr().
+
+  @param addr - Data Flash address of the first byte of the image.
+  @param image - Target content of the Data Flash.
+  @param len - Length of the image.
+  @param skip - Ranges which are never changed, in PROGMEM; NULL = none.
+  @param skipCount - Number of the ranges.
+  @returns number of the write transactions, or -1 if the region is invalid, the device is SEALED,
+           a window could not be read or the read-back does not match
+
+  @see dfApplyImage_P()
+  @see dfWriteBytes()
+  @see DF_DEVICE_MAINTAINED
+  @see BlockProtocol::PAYLOAD_MAX_SIZE
+*/
+int dfApplyImage(word addr, const byte *image, int len,
+                 const DfRange *skip = DF_DEVICE_MAINTAINED, byte skipCount = DF_DEVICE_MAINTAINED_COUNT);
+
+/**
+  @brief Same as dfApplyImage(), but the image is stored in PROGMEM.
+  @see dfApplyImage()
+*/
+int dfApplyImage_P(word addr, PGM_P image, int len,
+                   const DfRange *skip = DF_DEVICE_MAINTAINED, byte skipCount = DF_DEVICE_MAINTAINED_COUNT);
+
+/**
+  @brief Address of the window at which the last dfApplyImage() has failed, 0 if it has not failed.
+*/
+word dfApplyImageFailedAddr();
+
+/**
+  @brief Start the new Data Flash transaction, all staged edits are dropped.
+  @see DF_TRANSACTION
+*/
+void dfTransactionBegin(DfTransaction *tx);
+
+/**
+  @brief Stage replacement of the masked bits of the Data Flash byte.
+
+  Edits of the same byte are merged, the later one wins.
+
+  @returns false if the address is invalid or there is no room for the edit, the whole transaction is rejected then
+*/
+bool dfTransactionSetBits(DfTransaction *tx, word addr, byte mask, byte value);
+
+/**
+  @brief Stage the bit value of the Data Flash byte.
+  @param n - number of the bit, [0; 7]
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetBit(DfTransaction *tx, word addr, byte n, bool value);
+
+/**
+  @brief Stage the U1/H1 value.
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetByte(DfTransaction *tx, word addr, byte value);
+
+/**
+  @brief Stage the word value (I2, U2, H2), order of bytes should be Normal.
+  @see dfTransactionSetBits()
+*/
+bool dfTransactionSetWord(DfTransaction *tx, word addr, word value);
+
+/**
+  @brief Write all staged edits to the Data Flash.
+
+  The edits are grouped by 32-byte windows starting from the lowest staged address.
+  Per window: one read, one write of the changed bytes (skipped if nothing changes) and one read-back.
+
+  The staged edits are kept, so the failed transaction can be committed again.
+
+  @returns number of the write transactions, or -1 if a window could not be read,
+           the read-back does not match, or the transaction was rejected
+
+  @see DF_TRANSACTION
+*/
+int dfTransactionCommit(DfTransaction *tx);
+
 /**
   @brief Print data from R_a table.
 
@@ -538,6 +830,101 @@ void dfReadAllData();
 */
 void dfPrintRaTable();
 
+/**
+  @brief Decoded R_a table with the detection of its update
+
+  The table is 4 blocks of 32 bytes: Cell 0, Cell 1, xCell 0, xCell 1.
+  Each block is the R_a flag (H2) and 15 rows (I2).
+  The high byte of the flag is the update status, the low byte is the usage, see DF_ADDR::CELL0_RA_FLAG.
+
+  The device toggles GaugingStatus()[RX] after every resistance update and GaugingStatus()[QMax] after every QMax update,
+  the flags of the table change only along with them.
+  So dfRaTableUpdate() reads GaugingStatus() by the single MAC transaction
+  and requests the 4 blocks only if the toggle bits differ from the last snapshot.
+
+  The toggles do not reveal an even number of updates between two calls,
+  nor the change of the status (e.g. 0x05, 0x55) that happens without an update:
+  so maxAgeMs is required, the blocks are requested anyway when the snapshot is older.
+
+  Usage:
+  <pre>
+    RaTable ra;  // the last snapshot, keep it between the calls
+    dfRaTableBegin(&ra);
+    ...
+    const int changed = dfRaTableUpdate(&ra, 60000);  // re-read at least once a minute
+    if (changed > 0 && bitRead(changed, RA_TABLE::CELL0)) publish(ra.blocks[RA_TABLE::CELL0].rows);
+  </pre>
+
+  @see GaugingStatusFlags::RX()
+  @see GaugingStatusFlags::QMax()
+*/
+class RA_TABLE {
+  public:
+    static const byte BLOCKS = 4;
+    static const byte ROWS = 15;
+    static const byte BLOCK_SIZE = BlockProtocol::PAYLOAD_MAX_SIZE;  ///< flag and 15 rows, 32
+
+    static const byte CELL0 = 0;  ///< index of the DF_ADDR::CELL0_RA_FLAG block
+    static const byte CELL1 = 1;  ///< index of the DF_ADDR::CELL1_RA_FLAG block
+    static const byte X_CELL0 = 2;  ///< index of the DF_ADDR::X_CELL0_RA_FLAG block
+    static const byte X_CELL1 = 3;  ///< index of the DF_ADDR::X_CELL1_RA_FLAG block
+
+    static const byte IMPEDANCE_QMAX_UPDATED = 0x00;  ///< status: cell impedance and QMax updated
+    static const byte RELAX_QMAX_UPDATING = 0x05;  ///< status: RELAX mode and QMax update in progress
+    static const byte DISCHARGE_IMPEDANCE_UPDATED = 0x55;  ///< status: DISCHARGE mode and cell impedance updated
+    static const byte IMPEDANCE_NEVER_UPDATED = 0xFF;  ///< status: cell impedance never updated
+
+    static const byte TABLE_NOT_USED = 0x00;  ///< usage: table not used and QMax updated
+    static const byte TABLE_USED = 0x55;  ///< usage: table being used
+    static const byte TABLE_NEVER_USED = 0xFF;  ///< usage: table never used, neither QMax nor cell impedance updated
+};
+
+/**
+  @brief Decoded block of the R_a table.
+*/
+struct RaTableBlock {
+  byte status;  ///< high byte of the R_a flag
+  byte usage;  ///< low byte of the R_a flag
+  int16_t rows[RA_TABLE::ROWS];  ///< I2
+};
+
+/**
+  @brief Snapshot of the R_a table, see RA_TABLE.
+*/
+struct RaTable {
+  bool isValid;  ///< all blocks have been read
+  byte toggles;  ///< GaugingStatus()[RX, QMax] when the blocks were read
+  unsigned long timestamp;  ///< millis() of the last read of the blocks
+  RaTableBlock blocks[RA_TABLE::BLOCKS];
+};
+
+/**
+  @brief Clear the snapshot, so the next dfRaTableUpdate() reads all blocks.
+
+  Call it also after the table was written, e.g. by dfResetRaTableFlags().
+*/
+void dfRaTableBegin(RaTable *table);
+
+/**
+  @brief Refresh the snapshot of the R_a table if the device has updated it or the snapshot is too old.
+
+  One GaugingStatus() MAC transaction if nothing has changed, four Data Flash reads otherwise.
+
+  @param maxAgeMs - the blocks are requested if the snapshot is older, ms;
+                   0 = only by the toggles, which miss an even number of updates and the status changes without an update
+
+  @returns bitmask of the blocks that changed (bit RA_TABLE::CELL0 ... RA_TABLE::X_CELL1), 0 if none,
+           -1 if the device could not be read (e.g. SEALED), the snapshot is requested again on the next call
+
+  @see RA_TABLE
+*/
+int dfRaTableUpdate(RaTable *table, unsigned long maxAgeMs);
+
+/**
+  @brief Print the decoded snapshot of the R_a table: the flag bytes and 15 rows per block.
+*/
+void dfPrintRaTable(const RaTable *table);
+
 /**
   @brief Advanced Charge Algorithm; Termination Config; 0x4693; Charge Term Taper Current; I2
   @see DF_ADDR::CHARGE_TERM_TAPER_CURRENT
@@ -556,14 +943,19 @@ void dfWriteTaperCurrent(int taperCurrent);
   - Cell0 R_a flag: addr = 0x4100, data = 0xFF55 - Cell impedance never updated; Table being used;
   - Cell1 R_a flag: addr = 0x4140, data = 0xFF55 - Cell impedance never updated; Table being used;
   - xCell0 R_a flag: addr = 0x4180, data = 0xFFFF - Cell impedance never updated; Table never used;
-  - xCell0 R_a flag: addr = 0x41C0, data = 0xFFFF - Cell impedance never updated; Table never used;
+  - xCell1 R_a flag: addr = 0x41C0, data = 0xFFFF - Cell impedance never updated; Table never used;
+
+  The flags are written by the single Data Flash transaction: the flags that already have the default value
+  are not written, the written ones are verified by the read-back.
+
+  @returns number of the write transactions, or -1 if the flags could not be written, see dfTransactionCommit()
 
   @see DF_ADDR::CELL0_RA_FLAG
   @see DF_ADDR::CELL1_RA_FLAG
   @see DF_ADDR::X_CELL0_RA_FLAG
   @see DF_ADDR::X_CELL1_RA_FLAG
 */
-void dfResetRaTableFlags();
+int dfResetRaTableFlags();
 
 /**
   @brief Settings; Configuration; 0x4632; SOC Flag Config A; H2
@@ -8,6 +8,7 @@ Description:
 - Loads data dump from specified input file.
 - Processes the data and prints it with the description.
 - Compare two dump datasets and prints differences.
+- Decodes binary dumps produced by dfSnapshot().
 
 
 MIT License
@@ -160,6 +161,74 @@ def load_dump_data(file_name):
     return retval
 
 
+class Snapshot:
+    """Binary framing of the dfSnapshot() output, see DF_SNAPSHOT in data_flash_access.h"""
+    MAGIC = b'DF'
+    VERSION = 1
+    HEADER_FORMAT = '<2sBBHH'  # magic, version, row size, first row address, number of rows
+    HEADER_SIZE = 8
+
+    SYNC_ROW = 0xA5
+    SYNC_ROW_FAILED = 0xAF
+    SYNC_END = 0x5A
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, the same as crc16() in utils.cpp"""
+    for value in data:
+        crc ^= value << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def load_dump_binary(file_name):
+    """
+    Load data from a binary dump produced by dfSnapshot().
+
+    Rows which were not read by the device or have an invalid CRC are skipped with a warning.
+
+    :param file_name: Name of the Dump file
+    :return: A dictionary where keys are addresses and values are the corresponding values,
+             the same as load_dump_data()
+    """
+    with open(file_name, 'rb') as file:
+        raw = file.read()
+
+    magic, version, row_size, first_addr, rows = unpack(Snapshot.HEADER_FORMAT, raw[:Snapshot.HEADER_SIZE])
+    if Snapshot.MAGIC != magic or Snapshot.VERSION != version:
+        raise ValueError(f'{file_name}: not a Data Flash snapshot v{Snapshot.VERSION}')
+
+    row_frame_size = 1 + 2 + row_size + 2  # sync + address + data + CRC16
+    retval = {}
+    pos = Snapshot.HEADER_SIZE
+    for _ in range(rows):
+        frame = raw[pos:pos + row_frame_size]
+        if len(frame) < row_frame_size:
+            raise ValueError(f'{file_name}: unexpected end of the snapshot')
+        pos += row_frame_size
+
+        sync = frame[0]
+        addr, = unpack('<H', frame[1:3])
+        crc, = unpack('<H', frame[-2:])
+
+        if Snapshot.SYNC_ROW_FAILED == sync:
+            print(f'{file_name}: row 0x{addr:04X} was not read by the device')
+            continue
+        if Snapshot.SYNC_ROW != sync or crc16(frame[1:-2]) != crc:
+            print(f'{file_name}: row 0x{addr:04X} is corrupted')
+            continue
+
+        for i, value in enumerate(frame[3:-2]):
+            retval[addr + i] = value
+
+    if pos >= len(raw) or Snapshot.SYNC_END != raw[pos]:
+        print(f'{file_name}: end of the snapshot is missing')
+
+    return retval
+
+
 class DataFlashElement:
     def __init__(self, data_format, data_description):
         self.data_format = data_format
@@ -244,6 +313,7 @@ if __name__ == '__main__':
     _dump_original = load_dump_data('data/dump/dump-original.txt')
     _dump_20240710 = load_dump_data('data/dump/dump-20240710.txt')
     _dump_20240710_lifetime_reset = load_dump_data('data/dump/dump-20240710-after-lifetime-reset.txt')
+    # _dump_snapshot = load_dump_binary('data/dump/dump-snapshot.bin')
 
     # See the detailed contents of the dumps
     # print_data_detailed(FULL_ADDRESSES_RANGE, _data_descriptions, _dump_original)
@@ -0,0 +1,429 @@
+"""
+This script collects the Battery Gas Gauging Device BQ28Z610 Data Flash dumps of many packs into a single store.
+
+License: MIT License
+Copyright (c) 2024 Oleksii Sylichenko
+
+Description:
+- Ingests the binary dumps produced by dfSnapshot() and the text dumps printed by dfReadAllData(),
+  the files are parsed in parallel by all the cores.
+- Keeps the images in a columnar store which is memory-mapped for the queries:
+    - images.bin   - the whole Data Flash image per dump, 8 KB each, indexed by the dump and the offset;
+    - rows.bin     - 1 per 32-byte row which was read, 0 for the missing and corrupted rows;
+    - columns/     - the decoded value of every numeric field of data_descriptions.csv, one file per DF_ADDR;
+    - index.csv    - the dump number, the pack serial number, the Device Name, the time and the source file.
+- The dumps do not contain the time, so the time of the dump is the modification time of the file:
+  copy the dumps with the time preserved (`cp -p`, `rsync -t`), otherwise the history of a pack is out of order.
+- The files which can not be read or parsed (e.g. a truncated snapshot) are reported and skipped.
+- Prints the values of a field across the fleet, the differences between two dumps
+  and the history of the changes of a pack.
+
+Usage:
+    python fleet.py ingest STORE FILE... [-j PROCESSES]
+    python fleet.py field STORE 0x4069
+    python fleet.py diff STORE DUMP_1 DUMP_2 [--with-ra]
+    python fleet.py history STORE SERIAL [--with-ra]
+    python fleet.py summary STORE
+
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+"""
+
+import argparse
+import csv
+import mmap
+import os
+import re
+from multiprocessing import Pool
+from struct import calcsize, error as StructError, unpack, unpack_from
+
+from data_flash import Address, DeviceDataFormat, Snapshot, UNPACK_FORMATS, \
+    crc16, load_data_descriptions, parse_record
+
+
+class Store:
+    """Layout of the store directory"""
+    IMAGE_SIZE = Address.END - Address.START + 1
+    ROW_SIZE = 32
+    ROWS = IMAGE_SIZE // ROW_SIZE
+    ERASED = 0xFF  # value of the bytes which are not in the dump
+
+    IMAGES_FILE = 'images.bin'
+    ROWS_FILE = 'rows.bin'
+    INDEX_FILE = 'index.csv'
+    COLUMNS_DIR = 'columns'
+    INDEX_HEADERS = ['Dump', 'Serial Number', 'Device Name', 'Time', 'Source']
+
+    BATCH_SIZE = 256  # dumps buffered in memory before they are appended to the store files
+
+    SERIAL_NUMBER = 0x4069  # I2C Configuration / Data / Serial Number
+    DEVICE_NAME = 0x4080  # I2C Configuration / Data / Device Name
+
+
+TEXT_ROW = re.compile(r'0x([0-9A-Fa-f]{4}): \[ ?((?:[0-9A-Fa-f]{2} ?)*)]')
+
+
+def parse_dump_text(text, image, rows):
+    """
+    Put the rows of the dfReadAllData() output into the image, the other lines of the log are skipped:
+
+    ```
+    0xAAAA: [ AA BB .... ]
+    ```
+    """
+    for match in TEXT_ROW.finditer(text):
+        offset = int(match.group(1), 16) - Address.START
+        values = bytes.fromhex(match.group(2))
+        if offset < 0 or offset + len(values) > Store.IMAGE_SIZE:
+            continue
+        image[offset:offset + len(values)] = values
+        for row in range(offset // Store.ROW_SIZE, (offset + len(values) - 1) // Store.ROW_SIZE + 1):
+            rows[row] = 1
+
+
+def parse_dump_binary(raw, image, rows, file_name):
+    """Put the valid rows of the dfSnapshot() output into the image, see load_dump_binary()"""
+    magic, version, row_size, first_addr, count = unpack(Snapshot.HEADER_FORMAT, raw[:Snapshot.HEADER_SIZE])
+    if Snapshot.VERSION != version:
+        raise ValueError(f'{file_name}: not a Data Flash snapshot v{Snapshot.VERSION}')
+
+    row_frame_size = 1 + 2 + row_size + 2  # sync + address + data + CRC16
+    pos = Snapshot.HEADER_SIZE
+    for _ in range(count):
+        frame = raw[pos:pos + row_frame_size]
+        if len(frame) < row_frame_size:
+            raise ValueError(f'{file_name}: unexpected end of the snapshot')
+        pos += row_frame_size
+
+        addr, = unpack('<H', frame[1:3])
+        crc, = unpack('<H', frame[-2:])
+        offset = addr - Address.START
+        if Snapshot.SYNC_ROW != frame[0] or crc16(frame[1:-2]) != crc or not 0 <= offset <= Store.IMAGE_SIZE - row_size:
+            continue  # not read by the device or corrupted
+
+        image[offset:offset + row_size] = frame[3:-2]
+        for row in range(offset // Store.ROW_SIZE, (offset + row_size - 1) // Store.ROW_SIZE + 1):
+            rows[row] = 1
+
+
+def parse_dump(file_name):
+    """
+    Worker of the parallel ingestion: parse the dump file of any format.
+    The time is the modification time of the file, the dumps do not contain it.
+
+    :return: (image, rows, time, file name, None) or (None, None, None, file name, error) if the file is not parsed
+    """
+    try:
+        with open(file_name, 'rb') as file:
+            raw = file.read()
+        time = int(os.path.getmtime(file_name))
+
+        image = bytearray([Store.ERASED]) * Store.IMAGE_SIZE
+        rows = bytearray(Store.ROWS)
+        if raw.startswith(Snapshot.MAGIC):
+            parse_dump_binary(raw, image, rows, file_name)
+        else:
+            parse_dump_text(raw.decode('ascii', errors='replace'), image, rows)
+    except (OSError, ValueError, StructError) as e:
+        return None, None, None, file_name, e
+    return bytes(image), bytes(rows), time, file_name, None
+
+
+class ImageView:
+    """Dataset of parse_record() over the image in the store"""
+
+    def __init__(self, image):
+        self.image = image
+
+    def __getitem__(self, addr):
+        return self.image[addr - Address.START]
+
+
+def numeric_fields(data_descriptions):
+    """Fields which have a column in the store: {addr: struct format}"""
+    return {addr: UNPACK_FORMATS[element.data_format] for addr, element in data_descriptions.items()
+            if DeviceDataFormat.TYPE_S != element.data_format[0]}
+
+
+def column_file(store_dir, addr, data_format):
+    return os.path.join(store_dir, Store.COLUMNS_DIR, f'0x{addr:04X}.{data_format}')
+
+
+def pack_serial(image):
+    return unpack_from('<H', image, Store.SERIAL_NUMBER - Address.START)[0]
+
+
+def device_name(image):
+    offset = Store.DEVICE_NAME - Address.START
+    length = min(image[offset], 20)
+    return bytes(image[offset + 1:offset + 1 + length]).decode('ascii', errors='replace')
+
+
+class IngestBatch:
+    """
+    Dumps buffered in memory, appended to the store files at once.
+    Only one file is open at a time, there are hundreds of the columns.
+    """
+
+    def __init__(self, store_dir, fields):
+        self.store_dir = store_dir
+        self.fields = fields
+        self.clear()
+
+    def clear(self):
+        self.count = 0
+        self.images = bytearray()
+        self.rows = bytearray()
+        self.columns = {addr: bytearray() for addr in self.fields}
+        self.index = []
+
+    def add(self, dump, image, rows, time, file_name):
+        self.images += image
+        self.rows += rows
+        for addr, data_format in self.fields.items():
+            self.columns[addr] += image[addr - Address.START:addr - Address.START + calcsize(data_format)]
+        self.index.append([dump, f'0x{pack_serial(image):04X}', device_name(image), time, file_name])
+        self.count += 1
+
+    def flush(self):
+        """Append the buffered dumps to the store, the index is the last so it never refers to a missing dump"""
+        if 0 == self.count:
+            return
+        with open(os.path.join(self.store_dir, Store.IMAGES_FILE), 'ab') as file:
+            file.write(self.images)
+        with open(os.path.join(self.store_dir, Store.ROWS_FILE), 'ab') as file:
+            file.write(self.rows)
+        for addr, data_format in self.fields.items():
+            with open(column_file(self.store_dir, addr, data_format), 'ab') as file:
+                file.write(self.columns[addr])
+        with open(os.path.join(self.store_dir, Store.INDEX_FILE), 'a', newline='') as file:
+            csv.writer(file, delimiter=';').writerows(self.index)
+        self.clear()
+
+
+def ingest(store_dir, file_names, processes=None):
+    """Parse the dumps in parallel and append them to the store by the batches of Store.BATCH_SIZE"""
+    data_descriptions = load_data_descriptions()
+    fields = numeric_fields(data_descriptions)
+    os.makedirs(os.path.join(store_dir, Store.COLUMNS_DIR), exist_ok=True)
+
+    index_file = os.path.join(store_dir, Store.INDEX_FILE)
+    if os.path.exists(index_file):
+        dump = len(load_index(store_dir))
+    else:
+        dump = 0
+        with open(index_file, 'w', newline='') as index:
+            csv.writer(index, delimiter=';').writerow(Store.INDEX_HEADERS)
+
+    batch = IngestBatch(store_dir, fields)
+    with Pool(processes) as pool:
+        for image, rows, time, file_name, error in pool.imap(parse_dump, file_names, chunksize=16):
+            if error is not None:
+                print(f'{file_name}: skipped, {error}')
+                continue
+            if not any(rows):
+                print(f'{file_name}: no Data Flash rows')
+                continue
+            batch.add(dump, image, rows, time, file_name)
+            dump += 1
+            if Store.BATCH_SIZE <= batch.count:
+                batch.flush()
+    batch.flush()
+    return dump
+
+
+def load_index(store_dir):
+    """:return: list of (serial, device name, time, source), the position is the dump number"""
+    with open(os.path.join(store_dir, Store.INDEX_FILE), newline='') as file:
+        reader = csv.reader(file, delimiter=';')
+        next(reader)  # skip headers
+        return [(int(row[1], 16), row[2], int(row[3]), row[4]) for row in reader]
+
+
+def map_file(file_name):
+    """Memory-map the store file for reading, None if it is empty"""
+    if not os.path.exists(file_name) or 0 == os.path.getsize(file_name):
+        return None
+    with open(file_name, 'rb') as file:
+        return mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+
+
+class FleetStore:
+    """Memory-mapped store for the queries"""
+
+    def __init__(self, store_dir):
+        self.store_dir = store_dir
+        self.data_descriptions = load_data_descriptions()
+        self.fields = numeric_fields(self.data_descriptions)
+        self.index = load_index(store_dir)
+        self.images = map_file(os.path.join(store_dir, Store.IMAGES_FILE))
+        self.rows = map_file(os.path.join(store_dir, Store.ROWS_FILE))
+
+    def image(self, dump):
+        start = dump * Store.IMAGE_SIZE
+        return memoryview(self.images)[start:start + Store.IMAGE_SIZE]
+
+    def is_valid(self, dump, addr, size=1):
+        """Whether all the bytes of the region were read from the device"""
+        first = dump * Store.ROWS + (addr - Address.START) // Store.ROW_SIZE
+        last = dump * Store.ROWS + (addr + size - 1 - Address.START) // Store.ROW_SIZE
+        return all(self.rows[first:last + 1])
+
+    def column(self, addr):
+        """Values of the field for all the dumps, zero-copy view of the column file"""
+        data_format = self.fields[addr]
+        column = map_file(column_file(self.store_dir, addr, data_format))
+        return memoryview(column).cast(data_format) if column is not None else []
+
+    def dumps_of(self, serial):
+        """Dumps of the pack sorted by the time"""
+        return sorted((dump for dump, entry in enumerate(self.index) if serial == entry[0]),
+                      key=lambda dump: self.index[dump][2])
+
+    def latest_dumps(self):
+        """The latest dump of every pack: {serial: dump}"""
+        retval = {}
+        for dump, (serial, _, time, _) in enumerate(self.index):
+            if serial not in retval or self.index[retval[serial]][2] <= time:
+                retval[serial] = dump
+        return retval
+
+    def diff(self, dump_1, dump_2, with_ra=False):
+        """
+        Decoded fields which differ between two dumps, only the changed rows are decoded.
+
+        :return: list of (record 1, record 2)
+        """
+        image_1, image_2 = self.image(dump_1), self.image(dump_2)
+        retval = []
+        for addr in sorted(self.data_descriptions):
+            if not with_ra and Address.RA_TABLE_START <= addr <= Address.RA_TABLE_END:
+                continue
+            element = self.data_descriptions[addr]
+            offset = addr - Address.START
+            size = int(element.data_format[1:])
+            if image_1[offset:offset + size] == image_2[offset:offset + size]:
+                continue
+            if not (self.is_valid(dump_1, addr, size) and self.is_valid(dump_2, addr, size)):
+                continue
+            retval.append((parse_record(addr, element, ImageView(image_1)),
+                           parse_record(addr, element, ImageView(image_2))))
+        return retval
+
+    def dump_caption(self, dump):
+        serial, name, time, source = self.index[dump]
+        return f'dump {dump}: serial 0x{serial:04X} [{name}] {source}'
+
+
+def print_field(store, addr):
+    """Print the value of the field in every dump"""
+    if addr not in store.fields:
+        print(f'0x{addr:04X}: no numeric field at the address')
+        return
+    values = store.column(addr)
+    size = calcsize(store.fields[addr])
+    print(f'0x{addr:04X}: ({store.data_descriptions[addr].data_format}) [{store.data_descriptions[addr].data_description}]')
+    for dump, value in enumerate(values):
+        valid = '' if store.is_valid(dump, addr, size) else ' (not read)'
+        print(f'{store.dump_caption(dump)}: {value}{valid}')
+
+
+def print_diff(store, dump_1, dump_2, with_ra=False):
+    for dump in (dump_1, dump_2):
+        if not 0 <= dump < len(store.index):
+            print(f'dump {dump}: no such dump, the store has {len(store.index)} dumps')
+            return
+    print(f'dataset 1: {store.dump_caption(dump_1)}')
+    print(f'dataset 2: {store.dump_caption(dump_2)}')
+    print()
+    for record_1, record_2 in store.diff(dump_1, dump_2, with_ra):
+        print(f'dataset 1: {record_1}')
+        print(f'dataset 2: {record_2}')
+        print()
+
+
+def print_history(store, serial, with_ra=False):
+    """Print the changes of the pack between its consecutive dumps"""
+    dumps = store.dumps_of(serial)
+    if not dumps:
+        print(f'serial 0x{serial:04X}: no dumps')
+        return
+    for dump_1, dump_2 in zip(dumps, dumps[1:]):
+        print(f'=== {store.dump_caption(dump_1)} -> {store.dump_caption(dump_2)}')
+        for record_1, record_2 in store.diff(dump_1, dump_2, with_ra):
+            print(f'  {record_1}')
+            print(f'  {record_2}')
+
+
+def print_summary(store, with_ra=False):
+    """Print the fields which are not the same across the latest dumps of the packs"""
+    latest = store.latest_dumps()
+    print(f'{len(store.index)} dumps, {len(latest)} packs')
+    dumps = list(latest.values())
+    for addr in sorted(store.fields):
+        if not with_ra and Address.RA_TABLE_START <= addr <= Address.RA_TABLE_END:
+            continue
+        column = store.column(addr)
+        values = {column[dump] for dump in dumps}
+        if len(values) > 1:
+            element = store.data_descriptions[addr]
+            print(f'0x{addr:04X}: ({element.data_format}) [{element.data_description}]: {len(values)} distinct values')
+
+
+if __name__ == '__main__':
+    _parser = argparse.ArgumentParser(description='Fleet-wide store of the BQ28Z610 Data Flash dumps')
+    _commands = _parser.add_subparsers(dest='command', required=True)
+
+    _ingest = _commands.add_parser('ingest', help='parse the dumps in parallel and append them to the store')
+    _ingest.add_argument('store')
+    _ingest.add_argument('files', nargs='+')
+    _ingest.add_argument('-j', '--processes', type=int, default=None, help='number of the processes, all cores by default')
+
+    _field = _commands.add_parser('field', help='value of the field in every dump')
+    _field.add_argument('store')
+    _field.add_argument('addr', type=lambda value: int(value, 16))
+
+    _diff = _commands.add_parser('diff', help='differences between two dumps')
+    _diff.add_argument('store')
+    _diff.add_argument('dump_1', type=int)
+    _diff.add_argument('dump_2', type=int)
+    _diff.add_argument('--with-ra', action='store_true', help='compare the Ra table too')
+
+    _history = _commands.add_parser('history', help='changes of the pack between its consecutive dumps')
+    _history.add_argument('store')
+    _history.add_argument('serial', type=lambda value: int(value, 16))
+    _history.add_argument('--with-ra', action='store_true', help='compare the Ra table too')
+
+    _summary = _commands.add_parser('summary', help='fields which differ across the packs')
+    _summary.add_argument('store')
+    _summary.add_argument('--with-ra', action='store_true', help='compare the Ra table too')
+
+    _args = _parser.parse_args()
+    if 'ingest' == _args.command:
+        print(f'{ingest(_args.store, _args.files, _args.processes)} dumps in the store')
+    elif 'field' == _args.command:
+        print_field(FleetStore(_args.store), _args.addr)
+    elif 'diff' == _args.command:
+        print_diff(FleetStore(_args.store), _args.dump_1, _args.dump_2, _args.with_ra)
+    elif 'history' == _args.command:
+        print_history(FleetStore(_args.store), _args.serial, _args.with_ra)
+    elif 'summary' == _args.command:
+        print_summary(FleetStore(_args.store), _args.with_ra)
@@ -0,0 +1,265 @@
+"""
+This script decodes the binary telemetry records of the Battery Gas Gauging Device BQ28Z610 driver.
+
+License: MIT License
+Copyright (c) 2024 Oleksii Sylichenko
+
+Description:
+- Splits the stream into COBS frames by the 0x00 delimiter.
+- Checks the CRC-16 of every record, see telemetry.h.
+- Prints the records with the names and the units of the registers.
+- Decodes the Learning Cycle log flushed by learningLogFlush(), see learning_log.h.
+
+Usage:
+    python telemetry.py capture.bin
+    python telemetry.py /dev/ttyUSB0 115200   (requires pyserial)
+    python telemetry.py --learning-log learning.bin   (CSV of the samples)
+
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+"""
+
+import sys
+from struct import unpack
+
+from data_flash import crc16
+
+
+class Telemetry:
+    """Format of the record, see Telemetry in telemetry.h"""
+    VERSION = 2
+    HEADER_SIZE = 5
+    CRC_SIZE = 2
+    DELIMITER = 0x00
+
+    TAG_HELLO = 0x7E  # above the command codes of the standard registers
+    TAG_FRAME = 0x7F
+    TAG_MAC_BASE = 0x80
+
+
+# tag: (name, signed, scale, units)
+REGISTERS = {
+    0x00: ('ManufacturerAccessControl', False, 1, ''),
+    0x06: ('Temperature', False, 0.1, 'K'),
+    0x08: ('Voltage', False, 0.001, 'V'),
+    0x0A: ('BatteryStatus', False, 1, ''),
+    0x0C: ('Current', True, 1, 'mA'),
+    0x10: ('RemainingCapacity', False, 1, 'mAh'),
+    0x12: ('FullChargeCapacity', False, 1, 'mAh'),
+    0x14: ('AverageCurrent', True, 1, 'mA'),
+    0x2A: ('CycleCount', False, 1, ''),
+    0x2C: ('RelativeStateOfCharge', False, 1, '%'),
+    0x2E: ('StateOfHealth', False, 1, '%'),
+    0x30: ('ChargingVoltage', False, 0.001, 'V'),
+    0x32: ('ChargingCurrent', False, 1, 'mA'),
+    0x3C: ('DesignCapacity', False, 1, 'mAh'),
+}
+
+MAC_SUBCOMMANDS = {
+    0x50: 'SafetyAlert',
+    0x51: 'SafetyStatus',
+    0x52: 'PFAlert',
+    0x53: 'PFStatus',
+    0x54: 'OperationStatus',
+    0x55: 'ChargingStatus',
+    0x56: 'GaugingStatus',
+    0x57: 'ManufacturingStatus',
+}
+
+FRAME_FIELDS = ['Temperature', 'Voltage', 'BatteryStatus', 'Current',
+                'RemainingCapacity', 'FullChargeCapacity', 'AverageCurrent', 'RelativeStateOfCharge']
+FRAME_FORMAT = '<HHHhHHhH'
+
+
+def cobs_decode(data):
+    """Decode a single COBS frame without the delimiter"""
+    retval = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if 0 == code:
+            raise ValueError('zero byte inside the COBS frame')
+        retval += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            retval.append(0)
+    return bytes(retval)
+
+
+def decode_record(frame):
+    """
+    Decode a record.
+
+    :param frame: COBS frame without the delimiter
+    :return: (tag, timestamp, value bytes) or None if the frame is broken
+    """
+    try:
+        record = cobs_decode(frame)
+    except ValueError:
+        return None
+    if len(record) < Telemetry.HEADER_SIZE + Telemetry.CRC_SIZE:
+        return None
+
+    body, crc = record[:-Telemetry.CRC_SIZE], unpack('<H', record[-Telemetry.CRC_SIZE:])[0]
+    if crc16(body) != crc:
+        return None
+
+    tag, timestamp = unpack('<BI', body[:Telemetry.HEADER_SIZE])
+    return tag, timestamp, body[Telemetry.HEADER_SIZE:]
+
+
+def iter_records(stream):
+    """
+    Split the byte stream into records.
+
+    Broken frames are skipped, the count of them is printed at the end of the stream.
+
+    :param stream: iterable of bytes chunks
+    """
+    buffer = bytearray()
+    broken = 0
+    for chunk in stream:
+        buffer += chunk
+        while True:
+            end = buffer.find(Telemetry.DELIMITER)
+            if end < 0:
+                break
+            frame, buffer = bytes(buffer[:end]), buffer[end + 1:]
+            if not frame:
+                continue
+            record = decode_record(frame)
+            if record is None:
+                broken += 1
+            else:
+                yield record
+    if broken:
+        print(f'Broken records: {broken}', file=sys.stderr)
+
+
+def format_register(tag, value):
+    name, signed, scale, units = REGISTERS[tag]
+    raw = unpack('<h' if signed else '<H', value)[0]
+    if 1 == scale:
+        return f'{name}: {raw} {units}'.rstrip()
+    return f'{name}: {raw * scale:.3f} {units}'
+
+
+def format_record(tag, timestamp, value):
+    prefix = f'{timestamp / 1000:10.3f}s '
+    if Telemetry.TAG_HELLO == tag:
+        return prefix + f'HELLO version {value[0]}'
+    if Telemetry.TAG_FRAME == tag:
+        fields = unpack(FRAME_FORMAT, value)
+        return prefix + ', '.join(f'{n}={v}' for n, v in zip(FRAME_FIELDS, fields))
+    if tag & Telemetry.TAG_MAC_BASE:
+        name = MAC_SUBCOMMANDS.get(tag & 0x7F, f'MAC 0x{tag & 0x7F:04X}')
+        return prefix + f'{name}: 0x{unpack("<I", value)[0]:08X}'
+    if tag in REGISTERS and 2 == len(value):
+        return prefix + format_register(tag, value)
+    return prefix + f'tag 0x{tag:02X}: {value.hex(" ")}'
+
+
+class LearningLog:
+    """Format of the flushed Learning Cycle log, see LearningLog in learning_log.h"""
+    MAGIC = b'LG'
+    VERSION = 1
+    HEADER_FORMAT = '<2sBBHH'  # magic, version, number of fields, number of samples, period in seconds
+    HEADER_SIZE = 8
+    FIELDS = ['time', 'cellVoltage1', 'cellVoltage2', 'packVoltage', 'current', 'temperature', 'soc',
+              'qMaxCell1', 'qMaxCell2', 'qMaxPack', 'gaugingStatus', 'updateStatus']
+    SIGNED = {'cellVoltage1', 'cellVoltage2', 'packVoltage', 'current', 'qMaxCell1', 'qMaxCell2', 'qMaxPack'}
+
+
+def _read_varint(data, i):
+    value, shift = 0, 0
+    while True:
+        b = data[i]
+        i += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, i
+
+
+def load_learning_log(file_name):
+    """
+    Load the Learning Cycle log flushed by learningLogFlush().
+
+    :param file_name: Name of the binary file
+    :return: list of dictionaries with the fields of LearningSample
+    """
+    with open(file_name, 'rb') as file:
+        raw = file.read()
+
+    magic, version, fields, count, period = unpack(LearningLog.HEADER_FORMAT, raw[:LearningLog.HEADER_SIZE])
+    if LearningLog.MAGIC != magic or LearningLog.VERSION != version or len(LearningLog.FIELDS) != fields:
+        raise ValueError(f'Unsupported log: {magic} v{version}, {fields} fields')
+
+    samples = []
+    previous = [0] * fields
+    i = LearningLog.HEADER_SIZE
+    for _ in range(count):
+        values = []
+        for f in range(fields):
+            zigzag, i = _read_varint(raw, i)
+            delta = (zigzag >> 1) ^ -(zigzag & 1)
+            previous[f] = (previous[f] + delta) & 0xFFFFFFFF
+            values.append(previous[f])
+        sample = dict(zip(LearningLog.FIELDS, values))
+        for name in LearningLog.SIGNED:
+            if sample[name] & 0x80000000:
+                sample[name] -= 1 << 32
+        samples.append(sample)
+
+    if crc16(raw[:i]) != unpack('<H', raw[i:i + 2])[0]:
+        raise ValueError('CRC of the log is wrong')
+    print(f'Learning log: {count} samples, period {period} s', file=sys.stderr)
+    return samples
+
+
+def read_file(file_name, chunk_size=4096):
+    with open(file_name, 'rb') as file:
+        while chunk := file.read(chunk_size):
+            yield chunk
+
+
+def read_serial(port, baudrate):
+    import serial
+    with serial.Serial(port, baudrate, timeout=1) as connection:
+        while True:
+            yield connection.read(connection.in_waiting or 1)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 2 and '--learning-log' == sys.argv[1]:
+        _samples = load_learning_log(sys.argv[2])
+        print(','.join(LearningLog.FIELDS))
+        for _sample in _samples:
+            print(','.join(str(_sample[name]) for name in LearningLog.FIELDS))
+        sys.exit()
+
+    if len(sys.argv) > 2:
+        _stream = read_serial(sys.argv[1], int(sys.argv[2]))
+    else:
+        _stream = read_file(sys.argv[1] if len(sys.argv) > 1 else 'data/telemetry.bin')
+
+    for _record in iter_records(_stream):
+        print(format_record(*_record))
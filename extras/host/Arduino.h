@@ -0,0 +1,164 @@
+/**
+  @file Arduino.h
+
+  @brief Minimal Arduino core for building the driver on a host
+
+  Only the part of the API used by the driver: integer types, PROGMEM as plain memory,
+  bit macros, the clock, String, Print and Serial to stdout.
+
+  delay() and delayMicroseconds() do not sleep, they move the clock forward,
+  so micros() is the real time of the host plus all the delays requested by the driver.
+
+  @see host_driver.cpp
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <type_traits>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef uint32_t u32;
+typedef bool boolean;
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define PGM_P const char *
+#define strlen_P strlen
+#define strcpy_P(dest, src) strcpy((char *)(dest), (src))
+#define strncpy_P(dest, src, n) strncpy((char *)(dest), (src), (n))
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_ptr(p) (*(void * const *)(p))
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+/**
+  Function templates instead of the macros of the core, the result is a value, not a reference to the argument.
+*/
+template<class T, class U> auto min(T a, U b) -> typename std::decay<decltype(a < b ? a : b)>::type { return a < b ? a : b; }
+template<class T, class U> auto max(T a, U b) -> typename std::decay<decltype(a > b ? a : b)>::type { return a > b ? a : b; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+
+class String {
+  public:
+    String(const char *s = "");
+    String(int value, unsigned char base = DEC);
+    String(unsigned int value, unsigned char base = DEC);
+    String(long value, unsigned char base = DEC);
+    String(unsigned long value, unsigned char base = DEC);
+    String(double value, unsigned char decimals = 2);
+
+    String operator+(const String &other) const;
+    friend String operator+(const char *lhs, const String &rhs);
+    const char *c_str() const;
+    unsigned int length() const;
+
+  private:
+    std::string _s;
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size);
+    size_t write(const char *s);
+
+    size_t print(const __FlashStringHelper *s);
+    size_t print(const String &s);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(const __FlashStringHelper *s);
+    size_t println(const String &s);
+    size_t println(const char *s);
+    size_t println(char c);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+    size_t println();
+
+    virtual void flush() {}
+    virtual int availableForWrite() { return 0; }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    size_t readBytes(uint8_t *buf, size_t size);
+};
+
+/**
+  Serial port printing to stdout, nothing is received.
+*/
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud);
+    operator bool();
+    size_t write(uint8_t c) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
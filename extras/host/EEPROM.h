@@ -0,0 +1,47 @@
+/**
+  @file EEPROM.h
+
+  @brief Minimal EEPROM library for building the driver on a host
+
+  The memory lives in RAM for the process lifetime, erased to 0xFF like a new chip.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "Arduino.h"
+
+class EEPROMClass {
+  public:
+    static const uint16_t SIZE = 1024;
+
+    uint8_t read(int addr);
+    void write(int addr, uint8_t value);
+    void update(int addr, uint8_t value);
+    uint16_t length();
+
+    uint32_t writes = 0;  ///< number of the bytes actually changed by write() and update()
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,57 @@
+/**
+  @file Wire.h
+
+  @brief Minimal Wire library for building the driver on a host
+
+  There is no device on the bus: every address is not acknowledged and nothing is received.
+  The host talks to the gauge through the GaugeTransport, e.g. SimulatedGauge.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32
+
+class TwoWire : public Stream {
+  public:
+    void begin();
+    void setClock(uint32_t frequency);
+    void beginTransmission(uint8_t addr);
+    void beginTransmission(int addr);
+    uint8_t endTransmission();
+    uint8_t endTransmission(uint8_t sendStop);
+    uint8_t requestFrom(uint8_t addr, uint8_t size);
+    uint8_t requestFrom(int addr, int size);
+    uint8_t requestFrom(uint8_t addr, uint8_t size, uint8_t sendStop);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    using Print::write;
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,207 @@
+/**
+  @file host_arduino.cpp
+
+  @brief Minimal Arduino core, Wire and EEPROM for building the driver on a host implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "EEPROM.h"
+
+static const std::chrono::steady_clock::time_point _startTime = std::chrono::steady_clock::now();
+
+/**
+  Sum of all the delays requested by the driver, us.
+*/
+static unsigned long _delayedUs = 0;
+
+unsigned long micros() {
+  const auto elapsed = std::chrono::steady_clock::now() - _startTime;
+  return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + _delayedUs;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  _delayedUs += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  _delayedUs += us;
+}
+
+static std::string _toString(unsigned long value, int base, bool isNegative) {
+  if (base < 2) base = DEC;
+
+  std::string retval;
+  do {
+    const int digit = value % base;
+    retval.insert(retval.begin(), (char)(digit < 10 ? '0' + digit : 'A' + digit - 10));
+    value /= base;
+  } while (value);
+
+  if (isNegative) retval.insert(retval.begin(), '-');
+  return retval;
+}
+
+static std::string _toString(long value, int base) {
+  return DEC == base && value < 0 ? _toString(-(unsigned long)value, base, true) : _toString((unsigned long)value, base, false);
+}
+
+String::String(const char *s) : _s(s ? s : "") {}
+String::String(int value, unsigned char base) : _s(_toString((long)value, base)) {}
+String::String(unsigned int value, unsigned char base) : _s(_toString((unsigned long)value, base, false)) {}
+String::String(long value, unsigned char base) : _s(_toString(value, base)) {}
+String::String(unsigned long value, unsigned char base) : _s(_toString(value, base, false)) {}
+
+String::String(double value, unsigned char decimals) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  _s = buf;
+}
+
+String String::operator+(const String &other) const {
+  String retval(*this);
+  retval._s += other._s;
+  return retval;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+  return String(lhs) + rhs;
+}
+
+const char *String::c_str() const {
+  return _s.c_str();
+}
+
+unsigned int String::length() const {
+  return _s.length();
+}
+
+size_t Print::write(const uint8_t *buf, size_t size) {
+  size_t retval = 0;
+  while (size--) retval += write(*buf++);
+  return retval;
+}
+
+size_t Print::write(const char *s) {
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(const __FlashStringHelper *s) { return write((const char *)s); }
+size_t Print::print(const String &s) { return write(s.c_str()); }
+size_t Print::print(const char *s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return write(_toString((unsigned long)value, base, false).c_str()); }
+size_t Print::print(int value, int base) { return write(_toString((long)value, base).c_str()); }
+size_t Print::print(unsigned int value, int base) { return write(_toString((unsigned long)value, base, false).c_str()); }
+size_t Print::print(long value, int base) { return write(_toString(value, base).c_str()); }
+size_t Print::print(unsigned long value, int base) { return write(_toString(value, base, false).c_str()); }
+size_t Print::print(double value, int digits) { return print(String(value, digits)); }
+
+size_t Print::println(const __FlashStringHelper *s) { return print(s) + println(); }
+size_t Print::println(const String &s) { return print(s) + println(); }
+size_t Print::println(const char *s) { return print(s) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char value, int base) { return print(value, base) + println(); }
+size_t Print::println(int value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base) { return print(value, base) + println(); }
+size_t Print::println(long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base) { return print(value, base) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+size_t Print::println() { return write((uint8_t)'\n'); }
+
+size_t Stream::readBytes(uint8_t *buf, size_t size) {
+  size_t retval = 0;
+  for (int c; retval < size && (c = read()) >= 0; retval++) buf[retval] = c;
+  return retval;
+}
+
+void HardwareSerial::begin(unsigned long) {}
+HardwareSerial::operator bool() { return true; }
+size_t HardwareSerial::write(uint8_t c) { return EOF != fputc(c, stdout) ? 1 : 0; }
+int HardwareSerial::available() { return 0; }
+int HardwareSerial::read() { return -1; }
+int HardwareSerial::peek() { return -1; }
+
+HardwareSerial Serial;
+
+/**
+  Status of TwoWire::endTransmission(): address sent, NACK received.
+*/
+static const uint8_t _WIRE_NACK_ADDR = 2;
+
+void TwoWire::begin() {}
+void TwoWire::setClock(uint32_t) {}
+void TwoWire::beginTransmission(uint8_t) {}
+void TwoWire::beginTransmission(int) {}
+uint8_t TwoWire::endTransmission() { return _WIRE_NACK_ADDR; }
+uint8_t TwoWire::endTransmission(uint8_t) { return _WIRE_NACK_ADDR; }
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t) { return 0; }
+uint8_t TwoWire::requestFrom(int, int) { return 0; }
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t, uint8_t) { return 0; }
+size_t TwoWire::write(uint8_t) { return 1; }
+size_t TwoWire::write(const uint8_t *, size_t size) { return size; }
+int TwoWire::available() { return 0; }
+int TwoWire::read() { return -1; }
+int TwoWire::peek() { return -1; }
+
+TwoWire Wire;
+
+static uint8_t _eeprom[EEPROMClass::SIZE];
+static bool _isEepromErased = false;
+
+static uint8_t *_eepromCell(int addr) {
+  if (!_isEepromErased) {
+    memset(_eeprom, 0xFF, sizeof(_eeprom));
+    _isEepromErased = true;
+  }
+  return &_eeprom[(unsigned)addr % EEPROMClass::SIZE];
+}
+
+uint8_t EEPROMClass::read(int addr) {
+  return *_eepromCell(addr);
+}
+
+void EEPROMClass::write(int addr, uint8_t value) {
+  uint8_t *cell = _eepromCell(addr);
+  if (*cell != value) writes++;
+  *cell = value;
+}
+
+void EEPROMClass::update(int addr, uint8_t value) {
+  write(addr, value);
+}
+
+uint16_t EEPROMClass::length() {
+  return SIZE;
+}
+
+EEPROMClass EEPROM;
@@ -0,0 +1,213 @@
+/**
+  @file host_driver.cpp
+
+  @brief Benchmark and fuzzing loops of the driver against the SimulatedGauge on a host
+
+  Build and run from the root of the repository, -fpermissive as the Arduino IDE does:
+  <pre>
+    g++ -std=gnu++11 -O2 -fpermissive -Iextras/host -I. extras/host/host_arduino.cpp extras/host/host_driver.cpp *.cpp -o host_driver
+    ./host_driver [ITERATIONS [DUMP_FILE]]
+  </pre>
+
+  - isBlockValid(), validate() and blockError() on random blocks against a reference sum;
+  - composeValue() and composeWord() on random buffers against a reference Little Endian compose;
+  - every Data Flash row read through the simulator and compared with the seeded image,
+    the image is seeded from the dfReadAllData() dump if DUMP_FILE is given;
+  - runBenchmark() against the simulator with the default MAC latency.
+
+  The exit code is the number of the failed checks, capped at 255.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <chrono>
+
+#include "globals.h"
+#include "utils.h"
+#include "data_flash_access.h"
+#include "benchmark.h"
+#include "simulated_gauge.h"
+
+bool SILENCE = true,
+     DEBUG = false;
+
+static const unsigned long DEFAULT_ITERATIONS = 100000;
+static const u32 RANDOM_SEED = 0x28610;
+
+static u32 _random = RANDOM_SEED;
+
+/**
+  xorshift32, the same sequence on every host.
+*/
+static u32 nextRandom() {
+  _random ^= _random << 13;
+  _random ^= _random >> 17;
+  _random ^= _random << 5;
+  return _random;
+}
+
+static double elapsedS(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void report(const char *name, unsigned long count, unsigned long failures, double seconds) {
+  printf("%-16s %10lu checks %6lu failed %12.0f per s\n", name, count, failures, seconds > 0 ? count / seconds : 0.0);
+}
+
+/**
+  The sum of the bytes covered by the checksum and the checksum itself, written independently from utils.cpp.
+*/
+static byte referenceBlockSum(const byte *block) {
+  const int covered = block[BlockProtocol::LENGTH_INDEX] - 2;  // without the checksum and the length
+  byte sum = block[BlockProtocol::CHECKSUM_INDEX];
+  for (int i = 0; i < covered && i < BlockProtocol::CHECKSUM_INDEX; i++) sum += block[i];
+  return sum;
+}
+
+static unsigned long fuzzValidate(unsigned long iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  unsigned long failures = 0;
+  byte block[BlockProtocol::RESPONSE_MAX_SIZE];
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    for (int j = 0; j < BlockProtocol::RESPONSE_MAX_SIZE; j++) block[j] = nextRandom();
+    const byte len = BlockProtocol::SERVICE_SIZE + nextRandom() % (BlockProtocol::PAYLOAD_MAX_SIZE + 1);
+    block[BlockProtocol::LENGTH_INDEX] = len;
+
+    // random checksum, validate() prints the invalid blocks:
+    const bool expected = 0xFF == referenceBlockSum(block);
+    if (expected != isBlockValid(block) || (expected && !validate(block))) failures++;
+
+    // correct checksum:
+    block[BlockProtocol::CHECKSUM_INDEX] = checksum(block, len - 2);
+    if (!validate(block) || BusError::OK != blockError(block, sizeof(block))) failures++;
+
+    // one corrupted byte of the covered part:
+    block[nextRandom() % (len - 2)] ^= 1 << (nextRandom() % 8);
+    if (isBlockValid(block) || BusError::CHECKSUM != blockError(block, sizeof(block))) failures++;
+
+    // short response and length out of the range:
+    if (BusError::SHORT_READ != blockError(block, nextRandom() % BlockProtocol::RESPONSE_MAX_SIZE)) failures++;
+    block[BlockProtocol::LENGTH_INDEX] = BlockProtocol::RESPONSE_MAX_SIZE + 1 + nextRandom() % 64;
+    if (BusError::LENGTH != blockError(block, sizeof(block))) failures++;
+  }
+
+  report("validate", iterations * 5, failures, elapsedS(start));
+  return failures;
+}
+
+static unsigned long fuzzComposeValue(unsigned long iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  unsigned long failures = 0;
+  byte buf[8];
+
+  for (unsigned long i = 0; i < iterations; i++) {
+    for (unsigned j = 0; j < sizeof(buf); j++) buf[j] = nextRandom();
+    const int from = nextRandom() % (sizeof(buf) - 1);
+    const int till = min(from + 1 + (int)(nextRandom() % 3), (int)sizeof(buf) - 1);  // 2..4 bytes
+
+    u32 expected = 0;
+    for (int j = till; j >= from; j--) expected = (expected << 8) | buf[j];
+    if (expected != composeValue(buf, from, till)) failures++;
+
+    const word expectedWord = buf[from] | buf[from + 1] << 8;
+    if (expectedWord != composeWord(buf, from) || (word)(expectedWord << 8 | expectedWord >> 8) != composeWord(buf, from + 1, false)) {
+      failures++;
+    }
+  }
+
+  report("composeValue", iterations, failures, elapsedS(start));
+  return failures;
+}
+
+/**
+  Read every row of the Data Flash through the driver, the shadow copy is bypassed by the invalidation.
+*/
+static unsigned long readDataFlash(SimulatedGauge *sim, const byte *image, unsigned long iterations) {
+  const auto start = std::chrono::steady_clock::now();
+  const u32 transactions = sim->reads + sim->writes;
+  const unsigned long rounds = max(1UL, iterations / 1000);
+  unsigned long failures = 0, rows = 0;
+  byte buf[BlockProtocol::PAYLOAD_MAX_SIZE];
+
+  for (unsigned long i = 0; i < rounds; i++) {
+    for (word addr = DF_ADDR::MIN; addr <= DF_ADDR::MAX - sizeof(buf) + 1; addr += sizeof(buf), rows++) {
+      invalidateDfShadowCache();
+      if (!dfReadBytes(addr, buf, sizeof(buf)) || 0 != memcmp(buf, image + (addr - DF_ADDR::MIN), sizeof(buf))) {
+        failures++;
+      }
+    }
+  }
+
+  report("dfReadBytes", rows, failures, elapsedS(start));
+  printf("%-16s %10lu transactions\n", "", (unsigned long)(sim->reads + sim->writes - transactions));
+  return failures;
+}
+
+static int seedDataFlash(SimulatedGauge *sim, byte *df, const char *dumpFile) {
+  if (NULL == dumpFile) {
+    for (int i = 0; i < DF_ADDR::MAX - DF_ADDR::MIN + 1; i++) df[i] = nextRandom();
+    return DF_ADDR::MAX - DF_ADDR::MIN + 1;
+  }
+
+  FILE *file = fopen(dumpFile, "r");
+  if (NULL == file) {
+    perror(dumpFile);
+    return -1;
+  }
+  int retval = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), file)) retval += simulatedGaugeLoadDumpLine(sim, line);
+  fclose(file);
+  return retval;
+}
+
+int main(int argc, char **argv) {
+  const unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_ITERATIONS;
+  const char *dumpFile = argc > 2 ? argv[2] : NULL;
+
+  static byte df[DF_ADDR::MAX - DF_ADDR::MIN + 1];
+  SimulatedGauge sim;
+  simulatedGaugeBegin(&sim, df, sizeof(df));
+  GaugeTransport transport = simulatedGaugeTransport(&sim);
+  Gauge simGauge(&transport);
+  selectGauge(&simGauge);
+
+  const int seeded = seedDataFlash(&sim, df, dumpFile);
+  if (seeded < 0) return 1;
+  printf("seed 0x%X, %lu iterations, %d Data Flash bytes seeded\n", RANDOM_SEED, iterations, seeded);
+
+  unsigned long failures = 0;
+  failures += fuzzValidate(iterations);
+  failures += fuzzComposeValue(iterations);
+
+  sim.macLatencyUs = 0;  // native speed of the parsing, not of the device
+  failures += readDataFlash(&sim, df, iterations);
+
+  sim.macLatencyUs = SimulatedGaugeConfig::DEFAULT_MAC_LATENCY_US;
+  runBenchmark(Serial);
+
+  printf("%lu failed\n", failures);
+  return failures > 255 ? 255 : (int)failures;
+}
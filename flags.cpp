@@ -0,0 +1,319 @@
+/**
+  @file flags.cpp
+
+  @brief Flag tables in PROGMEM
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "flags.h"
+
+/**
+  @brief Position of the bit in the table.
+  @returns -1 if the bit is not described
+*/
+int flagIndex(const FlagTable *table, byte n) {
+  if (NULL == table) return -1;
+
+  const byte *bits = (const byte *) pgm_read_ptr(&table->bits);
+  const byte count = pgm_read_byte(&table->count);
+  for (byte i = 0; i < count; i++) {
+    if (n == pgm_read_byte(&bits[i])) return i;
+  }
+  return -1;
+}
+
+/**
+  @brief Caption of the flag from the documentation.
+  @returns NULL if the bit is not described or built without FLAG_CAPTIONS
+*/
+PGM_P flagCaption(Flag flag) {
+  const int index = flagIndex(flag.table, flag.n);
+  if (index < 0) return NULL;
+
+  PGM_P caption = (PGM_P) pgm_read_ptr(&flag.table->captions);
+  if (NULL == caption) return NULL;
+  for (int i = 0; i < index; i++) caption += strlen_P(caption) + 1;
+  return caption;
+}
+
+/**
+  12.1.1 0x00/01 ManufacturerAccessControl()
+*/
+const byte _MANUFACTURER_ACCESS_BITS[] PROGMEM = {14, 13, 12, 9, 7, 3, 2, 1, 0};
+#if FLAG_CAPTIONS
+const char _MANUFACTURER_ACCESS_CAPTIONS[] PROGMEM =
+  "SEC1 (Bit 14): SECURITY Mode\0"
+  "SEC0 (Bit 13): SECURITY Mode\0"
+  "AUTHCALM (Bit 12): Automatic CALIBRATION mode\0"
+  "CheckSumValid (Bit 9): Checksum Valid\0"
+  "BTP_INT (Bit 7): Battery Trip Point Interrupt\0"
+  "LDMD (Bit 3): LOAD Mode\0"
+  "R_DIS (Bit 2): Resistance Updates\0"
+  "VOK (Bit 1): Voltage OK for QMax Update\0"
+  "QMax (Bit 0): QMax Updates. This bit toggles after every QMax update\0";
+#endif
+const FlagTable ManufacturerAccessFlags::TABLE PROGMEM = {_MANUFACTURER_ACCESS_BITS, FLAG_CAPTION(_MANUFACTURER_ACCESS_CAPTIONS), sizeof(_MANUFACTURER_ACCESS_BITS)};
+
+/**
+  12.1.6 0x0A/0B BatteryStatus()
+*/
+const byte _BATTERY_STATUS_BITS[] PROGMEM = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 12, 14, 15};
+#if FLAG_CAPTIONS
+const char _BATTERY_STATUS_CAPTIONS[] PROGMEM =
+  "EC0 (Bit 0): Error Code\0"
+  "EC1 (Bit 1): Error Code\0"
+  "EC2 (Bit 2): Error Code\0"
+  "EC3 (Bit 3): Error Code\0"
+  "FD (Bit 4): Fully Discharged: [Battery ok; Battery fully depleted]\0"
+  "FC (Bit 5): Fully Charged: [Battery not fully charged; Battery fully charged]\0"
+  "DSG (Bit 6): Discharging: [Battery is charging; Battery is discharging]\0"
+  "INIT (Bit 7): Initialization: [Inactive; Active]\0"
+  "RTA (Bit 8): Remaining Time Alarm: [Inactive; Active]\0"
+  "RCA (Bit 9): Remaining Capacity Alarm: [Inactive; Active]\0"
+  "TDA (Bit 11): Terminate Discharge Alarm: [Inactive; Active]\0"
+  "OTA (Bit 12): Overtemperature Alarm: [Inactive; Active]\0"
+  "TCA (Bit 14): Terminate Charge Alarm: [Inactive; Active]\0"
+  "OCA (Bit 15): Overcharged Alarm: [Inactive; Active]\0";
+#endif
+const FlagTable BatteryStatusFlags::TABLE PROGMEM = {_BATTERY_STATUS_BITS, FLAG_CAPTION(_BATTERY_STATUS_CAPTIONS), sizeof(_BATTERY_STATUS_BITS)};
+
+/**
+  12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert()
+*/
+const byte _SAFETY_ALERT_BITS[] PROGMEM = {27, 26, 21, 19, 13, 12, 10, 8, 6, 4, 2, 1, 0};
+#if FLAG_CAPTIONS
+const char _SAFETY_ALERT_CAPTIONS[] PROGMEM =
+  "UTD (Bit 27): Undertemperature During Discharge\0"
+  "UTC (Bit 26): Undertemperature During Charge\0"
+  "CTOS (Bit 21): Charge Timeout Suspend\0"
+  "PTOS (Bit 19): Precharge Timeout Suspend\0"
+  "OTD (Bit 13): Overtemperature During Discharge\0"
+  "OTC (Bit 12): Overtemperature During Charge\0"
+  "ASCD (Bit 10): Short-Circuit During Discharge\0"
+  "ASCC (Bit 8): Short-Circuit During Charge\0"
+  "AOLD (Bit 6): Overload During Discharge\0"
+  "OCD (Bit 4): Overcurrent During Discharge\0"
+  "OCC (Bit 2): Overcurrent During Charge\0"
+  "COV (Bit 1): Cell Overvoltage\0"
+  "CUV (Bit 0): Cell Undervoltage\0";
+#endif
+const FlagTable SafetyAlertFlags::TABLE PROGMEM = {_SAFETY_ALERT_BITS, FLAG_CAPTION(_SAFETY_ALERT_CAPTIONS), sizeof(_SAFETY_ALERT_BITS)};
+
+/**
+  12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus()
+*/
+const byte _SAFETY_STATUS_BITS[] PROGMEM = {27, 26, 20, 18, 13, 12, 10, 8, 6, 4, 2, 1, 0};
+#if FLAG_CAPTIONS
+const char _SAFETY_STATUS_CAPTIONS[] PROGMEM =
+  "UTD (Bit 27): Undertemperature During Discharge\0"
+  "UTC (Bit 26): Undertemperature During Charge\0"
+  "CTO (Bit 20): Charge Timeout\0"
+  "PTO (Bit 18): Precharge Timeout\0"
+  "OTD (Bit 13): Overtemperature During Discharge\0"
+  "OTC (Bit 12): Overtemperature During Charge\0"
+  "ASCD (Bit 10): Short-Circuit During Discharge\0"
+  "ASCC (Bit 8): Short-Circuit During Charge\0"
+  "AOLD (Bit 6): Overload During Discharge\0"
+  "OCD (Bit 4): Overcurrent During Discharge\0"
+  "OCC (Bit 2): Overcurrent During Charge\0"
+  "COV (Bit 1): Cell Overvoltage\0"
+  "CUV (Bit 0): Cell Undervoltage\0";
+#endif
+const FlagTable SafetyStatusFlags::TABLE PROGMEM = {_SAFETY_STATUS_BITS, FLAG_CAPTION(_SAFETY_STATUS_CAPTIONS), sizeof(_SAFETY_STATUS_BITS)};
+
+/**
+  12.2.29 AltManufacturerAccess() 0x0053 PFStatus()
+*/
+const byte _PF_STATUS_BITS[] PROGMEM = {26, 24, 17, 16, 12, 11, 1};
+#if FLAG_CAPTIONS
+const char _PF_STATUS_CAPTIONS[] PROGMEM =
+  "DFW (Bit 26): Data Flash Wearout Failure\0"
+  "IFC (Bit 24): Instruction Flash Checksum Failure\0"
+  "DFETF (Bit 17): Discharge FET Failure\0"
+  "CFETF (Bit 16): Charge FET Failure\0"
+  "VIMR (Bit 12): Voltage Imbalance While Pack Is At Rest Failure\0"
+  "VIMA (Bit 11): Voltage Imbalance While Pack Is Active Failure\0"
+  "SOV (Bit 1): Safety Cell Overvoltage Failure\0";
+#endif
+const FlagTable PFStatusFlags::TABLE PROGMEM = {_PF_STATUS_BITS, FLAG_CAPTION(_PF_STATUS_CAPTIONS), sizeof(_PF_STATUS_BITS)};
+
+/**
+  12.2.30 AltManufacturerAccess() 0x0054 OperationStatus()
+*/
+const byte _OPERATION_STATUS_BITS[] PROGMEM = {29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 2, 1};
+#if FLAG_CAPTIONS
+const char _OPERATION_STATUS_CAPTIONS[] PROGMEM =
+  "EMSHUT (Bit 29): Emergency FET Shutdown\0"
+  "CB (Bit 28): Cell Balancing\0"
+  "SLPCC (Bit 27): CC Measurement in SLEEP mode\0"
+  "SLPAD (Bit 26): ADC Measurement in SLEEP mode\0"
+  "SMBLCAL (Bit 25): Auto-offset calibration when Bus low is detected\0"
+  "INIT (Bit 24): Initialization after full reset\0"
+  "SLEEPM (Bit 23): SLEEP mode\0"
+  "XL (Bit 22): 400-kHz mode\0"
+  "CAL_OFFSET (Bit 21): Calibration Output (raw CC Offset data)\0"
+  "CAL (Bit 20): Calibration Output (raw ADC and CC data)\0"
+  "AUTHCALM (Bit 19): Auto CC Offset Calibration by MAC AutoCCOffset\0"
+  "AUTH (Bit 18): Authentication in progress\0"
+  "SDM (Bit 16): SHUTDOWN triggered via command\0"
+  "SLEEP (Bit 15): SLEEP mode conditions met\0"
+  "XCHG (Bit 14): Charging disabled\0"
+  "XDSG (Bit 13): Discharging disabled\0"
+  "PF (Bit 12): PERMANENT FAILURE mode status\0"
+  "SS (Bit 11): SAFETY mode status\0"
+  "SDV (Bit 10): SHUTDOWN triggered via low pack voltage\0"
+  "SEC1 (Bit 9)\0"
+  "SEC0 (Bit 8)\0"
+  "BTP_INT (Bit 7): Battery Trip Point (BTP) Interrupt output\0"
+  "CHG (Bit 2): CHG FET status\0"
+  "DSG (Bit 1): DSG FET status\0";
+#endif
+const FlagTable OperationStatusFlags::TABLE PROGMEM = {_OPERATION_STATUS_BITS, FLAG_CAPTION(_OPERATION_STATUS_CAPTIONS), sizeof(_OPERATION_STATUS_BITS)};
+
+/**
+  12.2.31 AltManufacturerAccess() 0x0055 ChargingStatus()
+*/
+const byte _CHARGING_STATUS_BITS[] PROGMEM = {15, 14, 13, 12, 11, 10, 9, 8, 6, 5, 4, 3, 2, 1, 0};
+#if FLAG_CAPTIONS
+const char _CHARGING_STATUS_CAPTIONS[] PROGMEM =
+  "VCT (Bit 15): Charge Termination\0"
+  "MCHG (Bit 14): Maintenance Charge\0"
+  "SU (Bit 13): Charge Suspend\0"
+  "IN (Bit 12): Charge Inhibit\0"
+  "HV (Bit 11): High Voltage Region\0"
+  "MV (Bit 10): Mid Voltage Region\0"
+  "LV (Bit 9): Low Voltage Region\0"
+  "PV (Bit 8): Precharge Voltage Region\0"
+  "OT (Bit 6): Over Temperature Region\0"
+  "HT (Bit 5): High Temperature Region\0"
+  "STH (Bit 4): Standard Temperature High Region\0"
+  "RT (Bit 3): Room Temperature Region\0"
+  "STL (Bit 2): Standard Temperature Low Region\0"
+  "LT (Bit 1): Low Temperature Region\0"
+  "UT (Bit 0): Under Temperature Region\0";
+#endif
+const FlagTable ChargingStatusFlags::TABLE PROGMEM = {_CHARGING_STATUS_BITS, FLAG_CAPTION(_CHARGING_STATUS_CAPTIONS), sizeof(_CHARGING_STATUS_BITS)};
+
+/**
+  12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus()
+*/
+const byte _GAUGING_STATUS_BITS[] PROGMEM = {20, 19, 18, 17, 16, 15, 13, 12, 11, 10, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+#if FLAG_CAPTIONS
+const char _GAUGING_STATUS_CAPTIONS[] PROGMEM =
+  "OCVFR (Bit 20): Open Circuit Voltage in Flat Region (during RELAX)\0"
+  "LDMD (Bit 19): LOAD mode\0"
+  "RX (Bit 18): Resistance Update (Toggles after every resistance update)\0"
+  "QMax (Bit 17): QMax Update (Toggles after every QMax update)\0"
+  "VDQ (Bit 16): Discharge Qualified for Learning (based on RU flag)\0"
+  "NSFM (Bit 15): Negative Scale Factor Mode\0"
+  "SLPQMax (Bit 13): QMax Update During Sleep\0"
+  "QEN (Bit 12): Impedance Track Gauging (Ra and QMax updates are enabled)\0"
+  "VOK (Bit 11): Voltage OK for QMax Update\0"
+  "RDIS (Bit 10): Resistance Updates\0"
+  "REST (Bit 8): Rest\0"  // documentation contains a typo
+  "CF (Bit 7): Condition Flag\0"
+  "DSG (Bit 6): Discharge/Relax\0"
+  "EDV (Bit 5): End-of-Discharge Termination Voltage\0"
+  "BAL_EN (Bit 4): Cell Balancing\0"
+  "TC (Bit 3): Terminate Charge\0"
+  "TD (Bit 2): Terminate Discharge\0"
+  "FC (Bit 1): Fully Charged\0"
+  "FD (Bit 0): Fully Discharged\0";
+#endif
+const FlagTable GaugingStatusFlags::TABLE PROGMEM = {_GAUGING_STATUS_BITS, FLAG_CAPTION(_GAUGING_STATUS_CAPTIONS), sizeof(_GAUGING_STATUS_BITS)};
+
+/**
+  12.2.33 AltManufacturerAccess() 0x0057 ManufacturingStatus()
+*/
+const byte _MANUFACTURING_STATUS_BITS[] PROGMEM = {15, 6, 5, 4, 3, 2, 1};
+#if FLAG_CAPTIONS
+const char _MANUFACTURING_STATUS_CAPTIONS[] PROGMEM =
+  "CAL_EN (Bit 15) CALIBRATION Mode\0"
+  "PF_EN (Bit 6) Permanent Failure Mode\0"
+  "LF_EN (Bit 5) Lifetime Data Collection Mode\0"
+  "FET_EN (Bit 4) All FET Action Mode\0"
+  "GAUGE_EN (Bit 3) Gas Gauging Mode\0"
+  "DSG_TEST (Bit 2)Discharge FET Test\0"
+  "CHG_TEST (Bit 1) Charge FET Test\0";
+#endif
+const FlagTable ManufacturingStatusFlags::TABLE PROGMEM = {_MANUFACTURING_STATUS_BITS, FLAG_CAPTION(_MANUFACTURING_STATUS_CAPTIONS), sizeof(_MANUFACTURING_STATUS_BITS)};
+
+/**
+  Data Flash: Settings; Configuration; FET Options; H1
+*/
+const byte _FET_OPTIONS_BITS[] PROGMEM = {2, 3, 4, 5, 6};
+#if FLAG_CAPTIONS
+const char _FET_OPTIONS_CAPTIONS[] PROGMEM =
+  "Bit 2: OTFET - FET action in OVERTEMPERATURE mode\0"
+  "Bit 3: CHGSU - FET action in CHARGE SUSPEND mode\0"
+  "Bit 4: CHGIN - FET action in CHARGE INHIBIT mode\0"
+  "Bit 5: CHGFET - FET action on valid charge termination\0"
+  "Bit 6: SLEEPCHG - CHG FET enabled during sleep\0";
+#endif
+const FlagTable FetOptionsFlags::TABLE PROGMEM = {_FET_OPTIONS_BITS, FLAG_CAPTION(_FET_OPTIONS_CAPTIONS), sizeof(_FET_OPTIONS_BITS)};
+
+/**
+  Data Flash: Settings; Configuration; 0x469B; DA Configuration; H1
+*/
+const byte _DA_CONFIGURATION_BITS[] PROGMEM = {0, 3, 4, 6};
+#if FLAG_CAPTIONS
+const char _DA_CONFIGURATION_CAPTIONS[] PROGMEM =
+  "Bit 0: CC0—Cell Count\0"
+  "Bit 3: IN_SYSTEM_SLEEP—In-system SLEEP mode\0"
+  "Bit 4: SLEEP—SLEEP Mode\0"
+  "Bit 6: CTEMP—Cell Temperature protection source\0";
+#endif
+const FlagTable DaConfigurationFlags::TABLE PROGMEM = {_DA_CONFIGURATION_BITS, FLAG_CAPTION(_DA_CONFIGURATION_CAPTIONS), sizeof(_DA_CONFIGURATION_BITS)};
+
+/**
+  Data Flash: Gas Gauging; State; 0x420E; Update Status; H1
+*/
+const byte _GAS_GAUGING_UPDATE_STATUS_BITS[] PROGMEM = {0, 1, 2, 3};
+#if FLAG_CAPTIONS
+const char _GAS_GAUGING_UPDATE_STATUS_CAPTIONS[] PROGMEM =
+  "Bit 0: Update0 - Update Status\0"
+  "Bit 1: Update0 - Update Status\0"
+  "Bit 2: Enable - Impedance Track gauging and lifetime updating is enabled\0"
+  "Bit 3: QMax_update - QMax was updated in the field (in real conditions)\0";
+#endif
+const FlagTable GasGaugingUpdateStatusFlags::TABLE PROGMEM = {_GAS_GAUGING_UPDATE_STATUS_BITS, FLAG_CAPTION(_GAS_GAUGING_UPDATE_STATUS_CAPTIONS), sizeof(_GAS_GAUGING_UPDATE_STATUS_BITS)};
+
+/**
+  Data Flash: Settings; Configuration; 0x4632; SOC Flag Config A; H2
+*/
+const byte _SOC_FLAG_CONFIG_A_BITS[] PROGMEM = {0, 1, 2, 3, 4, 5, 6, 7, 10, 11};
+#if FLAG_CAPTIONS
+const char _SOC_FLAG_CONFIG_A_CAPTIONS[] PROGMEM =
+  "Bit 0: TDSETV - Enables the TD flag set by the cell voltage threshold\0"
+  "Bit 1: TDCLEARV - Enables the TD flag clear by cell voltage threshold\0"
+  "Bit 2: TDSETRSOC - Enables the TD flag set by RSOC threshold\0"
+  "Bit 3: TDCLEARRSOC - Enables the TD flag cleared by the RSOC threshold\0"
+  "Bit 4: TCSETV - Enables the TC flag set by cell voltage threshold\0"
+  "Bit 5: TCCLEARV - Enables the TC flag clear by cell voltage threshold\0"
+  "Bit 6: TCSETRSOC - Enables the TC flag set by the RSOC threshold\0"
+  "Bit 7: TCCLEARRSOC - Enables the TC flag cleared by the RSOC threshold\0"
+  "Bit 10: FCSETVCT - Enables the FC flag set by primary charge termination\0"
+  "Bit 11: TCSETVCT - Enables the TC flag set by primary charge termination\0";
+#endif
+const FlagTable SOCFlagConfigAFlags::TABLE PROGMEM = {_SOC_FLAG_CONFIG_A_BITS, FLAG_CAPTION(_SOC_FLAG_CONFIG_A_CAPTIONS), sizeof(_SOC_FLAG_CONFIG_A_BITS)};
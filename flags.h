@@ -30,6 +30,46 @@
 
 #include <Arduino.h>
 
+/**
+  1 = the captions of the flags from the documentation are kept in PROGMEM,
+  0 = only the bit indices are kept, the flags are printed in format: "Bit 12: 1".
+
+  The build without captions saves about 6 KB of flash, e.g. to fit the driver next to the application on a 32 KB part.
+
+  Can be disabled with the build flag: -DFLAG_CAPTIONS=0
+*/
+#ifndef FLAG_CAPTIONS
+#define FLAG_CAPTIONS 1
+#endif
+
+#if FLAG_CAPTIONS
+#define FLAG_CAPTION(captions) (captions)
+#else
+#define FLAG_CAPTION(captions) NULL
+#endif
+
+/**
+  @brief Flags of a register in PROGMEM, in the print order.
+*/
+struct FlagTable {
+
+  /**
+    Bit indices in PROGMEM.
+  */
+  const byte *bits;
+
+  /**
+    Captions from the documentation in PROGMEM, one per bit, separated by '\0'.
+    NULL if built without FLAG_CAPTIONS.
+  */
+  PGM_P captions;
+
+  /**
+    Number of the flags.
+  */
+  byte count;
+};
+
 /**
   @brief Structure that stores flag information.
 */
@@ -41,11 +81,24 @@ struct Flag {
   byte n;
 
   /**
-    Caption of the flag from the documentation.
+    Table which contains the caption of the flag, NULL if the bit is not described.
+    @see flagCaption()
   */
-  const char *caption;
+  const FlagTable *table;
 };
 
+/**
+  @brief Position of the bit in the table.
+  @returns -1 if the bit is not described
+*/
+int flagIndex(const FlagTable *table, byte n);
+
+/**
+  @brief Caption of the flag from the documentation.
+  @returns NULL if the bit is not described or built without FLAG_CAPTIONS
+*/
+PGM_P flagCaption(Flag flag);
+
 /**
   @brief 12.1.1 0x00/01 ManufacturerAccessControl()
 
@@ -56,32 +109,33 @@ struct Flag {
 */
 class ManufacturerAccessFlags {
   public:
-    static Flag SEC1() {
-      return {14, PSTR("SEC1 (Bit 14): SECURITY Mode")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag SEC1() {
+      return {14, &TABLE};
     }
-    static Flag SEC0() {
-      return {13, PSTR("SEC0 (Bit 13): SECURITY Mode")};
+    static constexpr Flag SEC0() {
+      return {13, &TABLE};
     }
-    static Flag AUTHCALM() {
-      return {12, PSTR("AUTHCALM (Bit 12): Automatic CALIBRATION mode")};
+    static constexpr Flag AUTHCALM() {
+      return {12, &TABLE};
     }
-    static Flag CheckSumValid() {
-      return {9, PSTR("CheckSumValid (Bit 9): Checksum Valid")};
+    static constexpr Flag CheckSumValid() {
+      return {9, &TABLE};
     }
-    static Flag BTP_INT() {
-      return {7, PSTR("BTP_INT (Bit 7): Battery Trip Point Interrupt")};
+    static constexpr Flag BTP_INT() {
+      return {7, &TABLE};
     }
-    static Flag LDMD() {
-      return {3, PSTR("LDMD (Bit 3): LOAD Mode")};
+    static constexpr Flag LDMD() {
+      return {3, &TABLE};
     }
-    static Flag R_DIS() {
-      return {2, PSTR("R_DIS (Bit 2): Resistance Updates")};
+    static constexpr Flag R_DIS() {
+      return {2, &TABLE};
     }
-    static Flag VOK() {
-      return {1, PSTR("VOK (Bit 1): Voltage OK for QMax Update")};
+    static constexpr Flag VOK() {
+      return {1, &TABLE};
     }
-    static Flag QMax() {
-      return {0, PSTR("QMax (Bit 0): QMax Updates. This bit toggles after every QMax update")};
+    static constexpr Flag QMax() {
+      return {0, &TABLE};
     }
 };
 
@@ -90,48 +144,49 @@ class ManufacturerAccessFlags {
 */
 class BatteryStatusFlags {
   public:
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
     static const byte ERR_CODE = 0b111;
-    static Flag EC0() {
-      return {0, PSTR("EC0 (Bit 0): Error Code")};
+    static constexpr Flag EC0() {
+      return {0, &TABLE};
     }
-    static Flag EC1() {
-      return {1, PSTR("EC1 (Bit 1): Error Code")};
+    static constexpr Flag EC1() {
+      return {1, &TABLE};
     }
-    static Flag EC2() {
-      return {2, PSTR("EC2 (Bit 2): Error Code")};
+    static constexpr Flag EC2() {
+      return {2, &TABLE};
     }
-    static Flag EC3() {
-      return {3, PSTR("EC3 (Bit 3): Error Code")};
+    static constexpr Flag EC3() {
+      return {3, &TABLE};
     }
-    static Flag FD() {
-      return {4, PSTR("FD (Bit 4): Fully Discharged: [Battery ok; Battery fully depleted]")};
+    static constexpr Flag FD() {
+      return {4, &TABLE};
     }
-    static Flag FC() {
-      return {5, PSTR("FC (Bit 5): Fully Charged: [Battery not fully charged; Battery fully charged]")};
+    static constexpr Flag FC() {
+      return {5, &TABLE};
     }
-    static Flag DSG() {
-      return {6, PSTR("DSG (Bit 6): Discharging: [Battery is charging; Battery is discharging]")};
+    static constexpr Flag DSG() {
+      return {6, &TABLE};
     }
-    static Flag INIT() {
-      return {7, PSTR("INIT (Bit 7): Initialization: [Inactive; Active]")};
+    static constexpr Flag INIT() {
+      return {7, &TABLE};
     }
-    static Flag RTA() {
-      return {8, PSTR("RTA (Bit 8): Remaining Time Alarm: [Inactive; Active]")};
+    static constexpr Flag RTA() {
+      return {8, &TABLE};
     }
-    static Flag RCA() {
-      return {9, PSTR("RCA (Bit 9): Remaining Capacity Alarm: [Inactive; Active]")};
+    static constexpr Flag RCA() {
+      return {9, &TABLE};
     }
-    static Flag TDA() {
-      return {11, PSTR("TDA (Bit 11): Terminate Discharge Alarm: [Inactive; Active]")};
+    static constexpr Flag TDA() {
+      return {11, &TABLE};
     }
-    static Flag OTA() {
-      return {12, PSTR("OTA (Bit 12): Overtemperature Alarm: [Inactive; Active]")};
+    static constexpr Flag OTA() {
+      return {12, &TABLE};
     }
-    static Flag TCA() {
-      return {14, PSTR("TCA (Bit 14): Terminate Charge Alarm: [Inactive; Active]")};
+    static constexpr Flag TCA() {
+      return {14, &TABLE};
     }
-    static Flag OCA() {
-      return {15, PSTR("OCA (Bit 15): Overcharged Alarm: [Inactive; Active]")};
+    static constexpr Flag OCA() {
+      return {15, &TABLE};
     }
 };
 
@@ -140,44 +195,45 @@ class BatteryStatusFlags {
 */
 class SafetyAlertFlags {
   public:
-    static Flag DSG() {
-      return {27, PSTR("UTD (Bit 27): Undertemperature During Discharge")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag DSG() {
+      return {27, &TABLE};
     }
-    static Flag UTC() {
-      return {26, PSTR("UTC (Bit 26): Undertemperature During Charge")};
+    static constexpr Flag UTC() {
+      return {26, &TABLE};
     }
-    static Flag CTOS() {
-      return {21, PSTR("CTOS (Bit 21): Charge Timeout Suspend")};
+    static constexpr Flag CTOS() {
+      return {21, &TABLE};
     }
-    static Flag PTOS() {
-      return {19, PSTR("PTOS (Bit 19): Precharge Timeout Suspend")};
+    static constexpr Flag PTOS() {
+      return {19, &TABLE};
     }
-    static Flag OTD() {
-      return {13, PSTR("OTD (Bit 13): Overtemperature During Discharge")};
+    static constexpr Flag OTD() {
+      return {13, &TABLE};
     }
-    static Flag OTC() {
-      return {12, PSTR("OTC (Bit 12): Overtemperature During Charge")};
+    static constexpr Flag OTC() {
+      return {12, &TABLE};
     }
-    static Flag ASCD() {
-      return {10, PSTR("ASCD (Bit 10): Short-Circuit During Discharge")};
+    static constexpr Flag ASCD() {
+      return {10, &TABLE};
     }
-    static Flag ASCC() {
-      return {8, PSTR("ASCC (Bit 8): Short-Circuit During Charge")};
+    static constexpr Flag ASCC() {
+      return {8, &TABLE};
     }
-    static Flag AOLD() {
-      return {6, PSTR("AOLD (Bit 6): Overload During Discharge")};
+    static constexpr Flag AOLD() {
+      return {6, &TABLE};
     }
-    static Flag OCD() {
-      return {4, PSTR("OCD (Bit 4): Overcurrent During Discharge")};
+    static constexpr Flag OCD() {
+      return {4, &TABLE};
     }
-    static Flag OCC() {
-      return {2, PSTR("OCC (Bit 2): Overcurrent During Charge")};
+    static constexpr Flag OCC() {
+      return {2, &TABLE};
     }
-    static Flag COV() {
-      return {1, PSTR("COV (Bit 1): Cell Overvoltage")};
+    static constexpr Flag COV() {
+      return {1, &TABLE};
     }
-    static Flag CUV() {
-      return {0, PSTR("CUV (Bit 0): Cell Undervoltage")};
+    static constexpr Flag CUV() {
+      return {0, &TABLE};
     }
 };
 
@@ -186,44 +242,45 @@ class SafetyAlertFlags {
 */
 class SafetyStatusFlags {
   public:
-    static Flag UTD() {
-      return {27, PSTR("UTD (Bit 27): Undertemperature During Discharge")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag UTD() {
+      return {27, &TABLE};
     }
-    static Flag UTC() {
-      return {26, PSTR("UTC (Bit 26): Undertemperature During Charge")};
+    static constexpr Flag UTC() {
+      return {26, &TABLE};
     }
-    static Flag CTO() {
-      return {20, PSTR("CTO (Bit 20): Charge Timeout")};
+    static constexpr Flag CTO() {
+      return {20, &TABLE};
     }
-    static Flag PTO() {
-      return {18, PSTR("PTO (Bit 18): Precharge Timeout")};
+    static constexpr Flag PTO() {
+      return {18, &TABLE};
     }
-    static Flag OTD() {
-      return {13, PSTR("OTD (Bit 13): Overtemperature During Discharge")};
+    static constexpr Flag OTD() {
+      return {13, &TABLE};
     }
-    static Flag OTC() {
-      return {12, PSTR("OTC (Bit 12): Overtemperature During Charge")};
+    static constexpr Flag OTC() {
+      return {12, &TABLE};
     }
-    static Flag ASCD() {
-      return {10, PSTR("ASCD (Bit 10): Short-Circuit During Discharge")};
+    static constexpr Flag ASCD() {
+      return {10, &TABLE};
     }
-    static Flag ASCC() {
-      return {8, PSTR("ASCC (Bit 8): Short-Circuit During Charge")};
+    static constexpr Flag ASCC() {
+      return {8, &TABLE};
     }
-    static Flag AOLD() {
-      return {6, PSTR("AOLD (Bit 6): Overload During Discharge")};
+    static constexpr Flag AOLD() {
+      return {6, &TABLE};
     }
-    static Flag OCD() {
-      return {4, PSTR("OCD (Bit 4): Overcurrent During Discharge")};
+    static constexpr Flag OCD() {
+      return {4, &TABLE};
     }
-    static Flag OCC() {
-      return {2, PSTR("OCC (Bit 2): Overcurrent During Charge")};
+    static constexpr Flag OCC() {
+      return {2, &TABLE};
     }
-    static Flag COV() {
-      return {1, PSTR("COV (Bit 1): Cell Overvoltage")};
+    static constexpr Flag COV() {
+      return {1, &TABLE};
     }
-    static Flag CUV() {
-      return {0, PSTR("CUV (Bit 0): Cell Undervoltage")};
+    static constexpr Flag CUV() {
+      return {0, &TABLE};
     }
 };
 
@@ -232,26 +289,27 @@ class SafetyStatusFlags {
 */
 class PFStatusFlags {
   public:
-    static Flag DFW() {
-      return {26, PSTR("DFW (Bit 26): Data Flash Wearout Failure")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag DFW() {
+      return {26, &TABLE};
     }
-    static Flag IFC() {
-      return {24, PSTR("IFC (Bit 24): Instruction Flash Checksum Failure")};
+    static constexpr Flag IFC() {
+      return {24, &TABLE};
     }
-    static Flag DFETF() {
-      return {17, PSTR("DFETF (Bit 17): Discharge FET Failure")};
+    static constexpr Flag DFETF() {
+      return {17, &TABLE};
     }
-    static Flag CFETF() {
-      return {16, PSTR("CFETF (Bit 16): Charge FET Failure")};
+    static constexpr Flag CFETF() {
+      return {16, &TABLE};
     }
-    static Flag VIMR() {
-      return {12, PSTR("VIMR (Bit 12): Voltage Imbalance While Pack Is At Rest Failure")};
+    static constexpr Flag VIMR() {
+      return {12, &TABLE};
     }
-    static Flag VIMA() {
-      return {11, PSTR("VIMA (Bit 11): Voltage Imbalance While Pack Is Active Failure")};
+    static constexpr Flag VIMA() {
+      return {11, &TABLE};
     }
-    static Flag SOV() {
-      return {1, PSTR("SOV (Bit 1): Safety Cell Overvoltage Failure")};
+    static constexpr Flag SOV() {
+      return {1, &TABLE};
     }
 };
 
@@ -260,80 +318,81 @@ class PFStatusFlags {
 */
 class OperationStatusFlags {
   public:
-    static Flag EMSHUT() {
-      return {29, PSTR("EMSHUT (Bit 29): Emergency FET Shutdown")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag EMSHUT() {
+      return {29, &TABLE};
     }
-    static Flag CB() {
-      return {28, PSTR("CB (Bit 28): Cell Balancing")};
+    static constexpr Flag CB() {
+      return {28, &TABLE};
     }
-    static Flag SLPCC() {
-      return {27, PSTR("SLPCC (Bit 27): CC Measurement in SLEEP mode")};
+    static constexpr Flag SLPCC() {
+      return {27, &TABLE};
     }
-    static Flag SLPAD() {
-      return {26, PSTR("SLPAD (Bit 26): ADC Measurement in SLEEP mode")};
+    static constexpr Flag SLPAD() {
+      return {26, &TABLE};
     }
-    static Flag SMBLCAL() {
-      return {25, PSTR("SMBLCAL (Bit 25): Auto-offset calibration when Bus low is detected")};
+    static constexpr Flag SMBLCAL() {
+      return {25, &TABLE};
     }
-    static Flag INIT() {
-      return {24, PSTR("INIT (Bit 24): Initialization after full reset")};
+    static constexpr Flag INIT() {
+      return {24, &TABLE};
     }
-    static Flag SLEEPM() {
-      return {23, PSTR("SLEEPM (Bit 23): SLEEP mode")};
+    static constexpr Flag SLEEPM() {
+      return {23, &TABLE};
     }
-    static Flag XL() {
-      return {22, PSTR("XL (Bit 22): 400-kHz mode")};
+    static constexpr Flag XL() {
+      return {22, &TABLE};
     }
-    static Flag CAL_OFFSET() {
-      return {21, PSTR("CAL_OFFSET (Bit 21): Calibration Output (raw CC Offset data)")};
+    static constexpr Flag CAL_OFFSET() {
+      return {21, &TABLE};
     }
-    static Flag CAL() {
-      return {20, PSTR("CAL (Bit 20): Calibration Output (raw ADC and CC data)")};
+    static constexpr Flag CAL() {
+      return {20, &TABLE};
     }
-    static Flag AUTHCALM() {
-      return {19, PSTR("AUTHCALM (Bit 19): Auto CC Offset Calibration by MAC AutoCCOffset")};
+    static constexpr Flag AUTHCALM() {
+      return {19, &TABLE};
     }
-    static Flag AUTH() {
-      return {18, PSTR("AUTH (Bit 18): Authentication in progress")};
+    static constexpr Flag AUTH() {
+      return {18, &TABLE};
     }
-    static Flag SDM() {
-      return {16, PSTR("SDM (Bit 16): SHUTDOWN triggered via command")};
+    static constexpr Flag SDM() {
+      return {16, &TABLE};
     }
 
     // =====
 
-    static Flag SLEEP() {
-      return {15, PSTR("SLEEP (Bit 15): SLEEP mode conditions met")};
+    static constexpr Flag SLEEP() {
+      return {15, &TABLE};
     }
-    static Flag XCHG() {
-      return {14, PSTR("XCHG (Bit 14): Charging disabled")};
+    static constexpr Flag XCHG() {
+      return {14, &TABLE};
     }
-    static Flag XDSG() {
-      return {13, PSTR("XDSG (Bit 13): Discharging disabled")};
+    static constexpr Flag XDSG() {
+      return {13, &TABLE};
     }
-    static Flag PF() {
-      return {12, PSTR("PF (Bit 12): PERMANENT FAILURE mode status")};
+    static constexpr Flag PF() {
+      return {12, &TABLE};
     }
-    static Flag SS() {
-      return {11, PSTR("SS (Bit 11): SAFETY mode status")};
+    static constexpr Flag SS() {
+      return {11, &TABLE};
     }
-    static Flag SDV() {
-      return {10, PSTR("SDV (Bit 10): SHUTDOWN triggered via low pack voltage")};
+    static constexpr Flag SDV() {
+      return {10, &TABLE};
     }
-    static Flag SEC1() {
-      return {9, PSTR("SEC1 (Bit 9)")};
+    static constexpr Flag SEC1() {
+      return {9, &TABLE};
     }
-    static Flag SEC0() {
-      return {8, PSTR("SEC0 (Bit 8)")};
+    static constexpr Flag SEC0() {
+      return {8, &TABLE};
     }
-    static Flag BTP_INT() {
-      return {7, PSTR("BTP_INT (Bit 7): Battery Trip Point (BTP) Interrupt output")};
+    static constexpr Flag BTP_INT() {
+      return {7, &TABLE};
     }
-    static Flag CHG() {
-      return {2, PSTR("CHG (Bit 2): CHG FET status")};
+    static constexpr Flag CHG() {
+      return {2, &TABLE};
     }
-    static Flag DSG() {
-      return {1, PSTR("DSG (Bit 1): DSG FET status")};
+    static constexpr Flag DSG() {
+      return {1, &TABLE};
     }
 };
 
@@ -342,50 +401,51 @@ class OperationStatusFlags {
 */
 class ChargingStatusFlags {
   public:
-    static Flag VCT() {
-      return {15, PSTR("VCT (Bit 15): Charge Termination")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag VCT() {
+      return {15, &TABLE};
     }
-    static Flag MCHG() {
-      return {14, PSTR("MCHG (Bit 14): Maintenance Charge")};
+    static constexpr Flag MCHG() {
+      return {14, &TABLE};
     }
-    static Flag SU() {
-      return {13, PSTR("SU (Bit 13): Charge Suspend")};
+    static constexpr Flag SU() {
+      return {13, &TABLE};
     }
-    static Flag IN() {
-      return {12, PSTR("IN (Bit 12): Charge Inhibit")};
+    static constexpr Flag IN() {
+      return {12, &TABLE};
     }
-    static Flag HV() {
-      return {11, PSTR("HV (Bit 11): High Voltage Region")};
+    static constexpr Flag HV() {
+      return {11, &TABLE};
     }
-    static Flag MV() {
-      return {10, PSTR("MV (Bit 10): Mid Voltage Region")};
+    static constexpr Flag MV() {
+      return {10, &TABLE};
     }
-    static Flag LV() {
-      return {9, PSTR("LV (Bit 9): Low Voltage Region")};
+    static constexpr Flag LV() {
+      return {9, &TABLE};
     }
-    static Flag PV() {
-      return {8, PSTR("PV (Bit 8): Precharge Voltage Region")};
+    static constexpr Flag PV() {
+      return {8, &TABLE};
     }
-    static Flag OT() {
-      return {6, PSTR("OT (Bit 6): Over Temperature Region")};
+    static constexpr Flag OT() {
+      return {6, &TABLE};
     }
-    static Flag HT() {
-      return {5, PSTR("HT (Bit 5): High Temperature Region")};
+    static constexpr Flag HT() {
+      return {5, &TABLE};
     }
-    static Flag STH() {
-      return {4, PSTR("STH (Bit 4): Standard Temperature High Region")};
+    static constexpr Flag STH() {
+      return {4, &TABLE};
     }
-    static Flag RT() {
-      return {3, PSTR("RT (Bit 3): Room Temperature Region")};
+    static constexpr Flag RT() {
+      return {3, &TABLE};
     }
-    static Flag STL() {
-      return {2, PSTR("STL (Bit 2): Standard Temperature Low Region")};
+    static constexpr Flag STL() {
+      return {2, &TABLE};
     }
-    static Flag LT() {
-      return {1, PSTR("LT (Bit 1): Low Temperature Region")};
+    static constexpr Flag LT() {
+      return {1, &TABLE};
     }
-    static Flag UT() {
-      return {0, PSTR("UT (Bit 0): Under Temperature Region")};
+    static constexpr Flag UT() {
+      return {0, &TABLE};
     }
 };
 
@@ -394,62 +454,63 @@ class ChargingStatusFlags {
 */
 class GaugingStatusFlags {
   public:
-    static Flag OCVFR() {
-      return {20, PSTR("OCVFR (Bit 20): Open Circuit Voltage in Flat Region (during RELAX)")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag OCVFR() {
+      return {20, &TABLE};
     }
-    static Flag LDMD() {
-      return {19, PSTR("LDMD (Bit 19): LOAD mode")};
+    static constexpr Flag LDMD() {
+      return {19, &TABLE};
     }
-    static Flag RX() {
-      return {18, PSTR("RX (Bit 18): Resistance Update (Toggles after every resistance update)")};
+    static constexpr Flag RX() {
+      return {18, &TABLE};
     }
-    static Flag QMax() {
-      return {17, PSTR("QMax (Bit 17): QMax Update (Toggles after every QMax update)")};
+    static constexpr Flag QMax() {
+      return {17, &TABLE};
     }
-    static Flag VDQ() {
-      return {16, PSTR("VDQ (Bit 16): Discharge Qualified for Learning (based on RU flag)")};
+    static constexpr Flag VDQ() {
+      return {16, &TABLE};
     }
-    static Flag NSFM() {
-      return {15, PSTR("NSFM (Bit 15): Negative Scale Factor Mode")};
+    static constexpr Flag NSFM() {
+      return {15, &TABLE};
     }
-    static Flag SLPQMax() {
-      return {13, PSTR("SLPQMax (Bit 13): QMax Update During Sleep")};
+    static constexpr Flag SLPQMax() {
+      return {13, &TABLE};
     }
-    static Flag QEN() {
-      return {12, PSTR("QEN (Bit 12): Impedance Track Gauging (Ra and QMax updates are enabled)")};
+    static constexpr Flag QEN() {
+      return {12, &TABLE};
     }
-    static Flag VOK() {
-      return {11, PSTR("VOK (Bit 11): Voltage OK for QMax Update")};
+    static constexpr Flag VOK() {
+      return {11, &TABLE};
     }
-    static Flag RDIS() {
-      return {10, PSTR("RDIS (Bit 10): Resistance Updates")};
+    static constexpr Flag RDIS() {
+      return {10, &TABLE};
     }
-    static Flag REST() {
-      return {8, PSTR("REST (Bit 8): Rest")};  // documentation contains a typo
+    static constexpr Flag REST() {
+      return {8, &TABLE};
     }
-    static Flag CF() {
-      return {7, PSTR("CF (Bit 7): Condition Flag")};
+    static constexpr Flag CF() {
+      return {7, &TABLE};
     }
-    static Flag DSG() {
-      return {6, PSTR("DSG (Bit 6): Discharge/Relax")};
+    static constexpr Flag DSG() {
+      return {6, &TABLE};
     }
-    static Flag EDV() {
-      return {5, PSTR("EDV (Bit 5): End-of-Discharge Termination Voltage")};
+    static constexpr Flag EDV() {
+      return {5, &TABLE};
     }
-    static Flag BAL_EN() {
-      return {4, PSTR("BAL_EN (Bit 4): Cell Balancing")};
+    static constexpr Flag BAL_EN() {
+      return {4, &TABLE};
     }
-    static Flag TC() {
-      return {3, PSTR("TC (Bit 3): Terminate Charge")};
+    static constexpr Flag TC() {
+      return {3, &TABLE};
     }
-    static Flag TD() {
-      return {2, PSTR("TD (Bit 2): Terminate Discharge")};
+    static constexpr Flag TD() {
+      return {2, &TABLE};
     }
-    static Flag FC() {
-      return {1, PSTR("FC (Bit 1): Fully Charged")};
+    static constexpr Flag FC() {
+      return {1, &TABLE};
     }
-    static Flag FD() {
-      return {0, PSTR("FD (Bit 0): Fully Discharged")};
+    static constexpr Flag FD() {
+      return {0, &TABLE};
     }
 };
 
@@ -458,26 +519,27 @@ class GaugingStatusFlags {
 */
 class ManufacturingStatusFlags {
   public:
-    static Flag CAL_EN() {
-      return {15, PSTR("CAL_EN (Bit 15) CALIBRATION Mode")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag CAL_EN() {
+      return {15, &TABLE};
     }
-    static Flag PF_EN() {
-      return {6, PSTR("PF_EN (Bit 6) Permanent Failure Mode")};
+    static constexpr Flag PF_EN() {
+      return {6, &TABLE};
     }
-    static Flag LF_EN() {
-      return {5, PSTR("LF_EN (Bit 5) Lifetime Data Collection Mode")};
+    static constexpr Flag LF_EN() {
+      return {5, &TABLE};
     }
-    static Flag FET_EN() {
-      return {4, PSTR("FET_EN (Bit 4) All FET Action Mode")};
+    static constexpr Flag FET_EN() {
+      return {4, &TABLE};
     }
-    static Flag GAUGE_EN() {
-      return {3, PSTR("GAUGE_EN (Bit 3) Gas Gauging Mode")};
+    static constexpr Flag GAUGE_EN() {
+      return {3, &TABLE};
     }
-    static Flag DSG_TEST() {
-      return {2, PSTR("DSG_TEST (Bit 2)Discharge FET Test")};
+    static constexpr Flag DSG_TEST() {
+      return {2, &TABLE};
     }
-    static Flag CHG_TEST() {
-      return {1, PSTR("CHG_TEST (Bit 1) Charge FET Test")};
+    static constexpr Flag CHG_TEST() {
+      return {1, &TABLE};
     }
 };
 
@@ -510,40 +572,41 @@ class ManufacturingStatusFlags {
 */
 class FetOptionsFlags {
   public:
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
     /**
       - 0 = No FET action for overtemperature condition (default)
       - 1 = CHG and DSG FETs will be turned off for overtemperature conditions.
     */
-    static Flag OTFET() {
-      return {2, PSTR("Bit 2: OTFET - FET action in OVERTEMPERATURE mode")};
+    static constexpr Flag OTFET() {
+      return {2, &TABLE};
     }
     /**
       - 0 = FET active (default)
       - 1 = Charging or precharging disabled, FET off
     */
-    static Flag CHGSU() {
-      return {3, PSTR("Bit 3: CHGSU - FET action in CHARGE SUSPEND mode")};
+    static constexpr Flag CHGSU() {
+      return {3, &TABLE};
     }
     /**
       - 0 = FET active (default)
       - 1 = Charging or precharging disabled, FET off
     */
-    static Flag CHGIN() {
-      return {4, PSTR("Bit 4: CHGIN - FET action in CHARGE INHIBIT mode")};
+    static constexpr Flag CHGIN() {
+      return {4, &TABLE};
     }
     /**
       - 0 = FET active (default)
       - 1 = Charging or precharging disabled, FET off
     */
-    static Flag CHGFET() {
-      return {5, PSTR("Bit 5: CHGFET - FET action on valid charge termination")};
+    static constexpr Flag CHGFET() {
+      return {5, &TABLE};
     }
     /**
       - 0 = CHG FET off during sleep (default)
       - 1 = CHG FET remains on during sleep.
     */
-    static Flag SLEEPCHG() {
-      return {6, PSTR("Bit 6: SLEEPCHG - CHG FET enabled during sleep")};
+    static constexpr Flag SLEEPCHG() {
+      return {6, &TABLE};
     }
 };
 
@@ -563,33 +626,34 @@ class FetOptionsFlags {
 */
 class DaConfigurationFlags {
   public:
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
     /**
       - 0 = 1 cell
       - 1 = 2 cell
     */
-    static Flag CC0() {
-      return {0, PSTR("Bit 0: CC0—Cell Count")};
+    static constexpr Flag CC0() {
+      return {0, &TABLE};
     }
     /**
       - 0 = Disables (default)
       - 1 = Enables
     */
-    static Flag IN_SYSTEM_SLEEP() {
-      return {3, PSTR("Bit 3: IN_SYSTEM_SLEEP—In-system SLEEP mode")};
+    static constexpr Flag IN_SYSTEM_SLEEP() {
+      return {3, &TABLE};
     }
     /**
       - 0 = Disables SLEEP mode
       - 1 = Enables SLEEP mode (default)
     */
-    static Flag SLEEP() {
-      return {4, PSTR("Bit 4: SLEEP—SLEEP Mode")};
+    static constexpr Flag SLEEP() {
+      return {4, &TABLE};
     }
     /**
       - 0 = MAX (default)
       - 1 = Average
     */
-    static Flag CTEMP() {
-      return {6, PSTR("Bit 6: CTEMP—Cell Temperature protection source")};
+    static constexpr Flag CTEMP() {
+      return {6, &TABLE};
     }
 };
 
@@ -604,6 +668,7 @@ class DaConfigurationFlags {
 */
 class GasGaugingUpdateStatusFlags {
   public:
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
     /**
       Bit 1:0: Update1, Update0 - Update Status:
       - 0,0 = Impedance Track gauging and lifetime updating is disabled.
@@ -611,25 +676,25 @@ class GasGaugingUpdateStatusFlags {
       - 1,0 = QMax and Ra table have been updated
     */
     static const byte UPDATE_STATUS = 0b11;
-    static Flag Update0() {
-      return {0, PSTR("Bit 0: Update0 - Update Status")};
+    static constexpr Flag Update0() {
+      return {0, &TABLE};
     }
-    static Flag Update1() {
-      return {1, PSTR("Bit 1: Update0 - Update Status")};
+    static constexpr Flag Update1() {
+      return {1, &TABLE};
     }
     /**
       - 0 = Disabled
       - 1 = Enabled
     */
-    static Flag Enable() {
-      return {2, PSTR("Bit 2: Enable - Impedance Track gauging and lifetime updating is enabled")};
+    static constexpr Flag Enable() {
+      return {2, &TABLE};
     }
     /**
       - 0 = Not updated
       - 1 = Updated
     */
-    static Flag QMax_update() {
-      return {3, PSTR("Bit 3: QMax_update - QMax was updated in the field (in real conditions)")};
+    static constexpr Flag QMax_update() {
+      return {3, &TABLE};
     }
 };
 
@@ -678,34 +743,35 @@ class GasGaugingUpdateStatusFlags {
 */
 class SOCFlagConfigAFlags {
   public:
-    static Flag TDSETV() {
-      return {0, PSTR("Bit 0: TDSETV - Enables the TD flag set by the cell voltage threshold")};
+    static const FlagTable TABLE;  ///< all the flags in PROGMEM, see printFlags()
+    static constexpr Flag TDSETV() {
+      return {0, &TABLE};
     }
-    static Flag TDCLEARV() {
-      return {1, PSTR("Bit 1: TDCLEARV - Enables the TD flag clear by cell voltage threshold")};
+    static constexpr Flag TDCLEARV() {
+      return {1, &TABLE};
     }
-    static Flag TDSETRSOC() {
-      return {2, PSTR("Bit 2: TDSETRSOC - Enables the TD flag set by RSOC threshold")};
+    static constexpr Flag TDSETRSOC() {
+      return {2, &TABLE};
     }
-    static Flag TDCLEARRSOC() {
-      return {3, PSTR("Bit 3: TDCLEARRSOC - Enables the TD flag cleared by the RSOC threshold")};
+    static constexpr Flag TDCLEARRSOC() {
+      return {3, &TABLE};
     }
-    static Flag TCSETV() {
-      return {4, PSTR("Bit 4: TCSETV - Enables the TC flag set by cell voltage threshold")};
+    static constexpr Flag TCSETV() {
+      return {4, &TABLE};
     }
-    static Flag TCCLEARV() {
-      return {5, PSTR("Bit 5: TCCLEARV - Enables the TC flag clear by cell voltage threshold")};
+    static constexpr Flag TCCLEARV() {
+      return {5, &TABLE};
     }
-    static Flag TCSETRSOC() {
-      return {6, PSTR("Bit 6: TCSETRSOC - Enables the TC flag set by the RSOC threshold")};
+    static constexpr Flag TCSETRSOC() {
+      return {6, &TABLE};
     }
-    static Flag TCCLEARRSOC() {
-      return {7, PSTR("Bit 7: TCCLEARRSOC - Enables the TC flag cleared by the RSOC threshold")};
+    static constexpr Flag TCCLEARRSOC() {
+      return {7, &TABLE};
     }
-    static Flag FCSETVCT() {
-      return {10, PSTR("Bit 10: FCSETVCT - Enables the FC flag set by primary charge termination")};
+    static constexpr Flag FCSETVCT() {
+      return {10, &TABLE};
     }
-    static Flag TCSETVCT() {
-      return {11, PSTR("Bit 11: TCSETVCT - Enables the TC flag set by primary charge termination")};
+    static constexpr Flag TCSETVCT() {
+      return {11, &TABLE};
     }
 };
@@ -0,0 +1,196 @@
+/**
+  @file gauge.cpp
+
+  @brief Multiple gauges on several buses and behind I2C multiplexers implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "gauge.h"
+#include "utils.h"
+#include "alt_manufacturer_access.h"
+
+Gauge::Gauge(TwoWire &wire, byte addr, byte muxAddr, byte muxChannel)
+  : wire(&wire), transport(NULL), addr(addr), muxAddr(muxAddr), muxChannel(muxChannel),
+    securityMode(SecurityMode::UNKNOWN), operationStatus(0), operationStatusMs(0),
+    dfShadowValid(0), dfShadow() {}
+
+Gauge::Gauge(GaugeTransport *transport, byte addr)
+  : wire(NULL), transport(transport), addr(addr), muxAddr(GaugeMux::NONE), muxChannel(0),
+    securityMode(SecurityMode::UNKNOWN), operationStatus(0), operationStatusMs(0),
+    dfShadowValid(0), dfShadow() {}
+
+Gauge DEFAULT_GAUGE;
+
+Gauge *_currentGauge = &DEFAULT_GAUGE;
+
+/**
+  The last multiplexer channel that was switched on.
+*/
+TwoWire *_muxWire = NULL;
+byte _muxAddr = GaugeMux::NONE;
+byte _muxChannel = 0;
+
+int _writeMux(TwoWire *wire, byte muxAddr, byte mask) {
+  wire->beginTransmission(muxAddr);
+  wire->write(mask);
+  return wire->endTransmission();
+}
+
+/**
+  Switch the multiplexer to the channel of the gauge.
+
+  Another multiplexer on the same bus is released,
+  otherwise two gauges with the same address would answer together.
+*/
+bool _selectMuxChannel(Gauge *gauge) {
+  if (NULL != gauge->transport) return true;  // not on the Wire, the multiplexers are not touched
+
+  if (GaugeMux::NONE == gauge->muxAddr) {
+    if (GaugeMux::NONE != _muxAddr && _muxWire == gauge->wire) {
+      _writeMux(_muxWire, _muxAddr, 0);
+      _muxAddr = GaugeMux::NONE;
+    }
+    return true;
+  }
+
+  if (_muxWire == gauge->wire && _muxAddr == gauge->muxAddr && _muxChannel == gauge->muxChannel) return true;
+
+  if (GaugeMux::NONE != _muxAddr && _muxWire == gauge->wire && _muxAddr != gauge->muxAddr) {
+    _writeMux(_muxWire, _muxAddr, 0);
+  }
+
+  const bool retval = 0 == _writeMux(gauge->wire, gauge->muxAddr, 1 << (gauge->muxChannel % GaugeMux::CHANNELS));
+  if (retval) {
+    _muxWire = gauge->wire;
+    _muxAddr = gauge->muxAddr;
+    _muxChannel = gauge->muxChannel;
+  } else {
+    _muxAddr = GaugeMux::NONE;  // unknown state, rewrite on the next selection
+  }
+  return retval;
+}
+
+/**
+  @brief Direct all the following requests of the driver to the gauge.
+
+  The channel of the multiplexer is switched only if it differs from the last selected one.
+  The decoded status blocks are forgotten when the gauge is changed,
+  the security mode and the Data Flash shadow copy are kept per gauge.
+
+  @returns whether the multiplexer has acknowledged the channel, true if there is no multiplexer
+
+  @see invalidateStatusBlocksCache()
+*/
+bool selectGauge(Gauge *gauge) {
+  if (gauge != _currentGauge) {
+    invalidateStatusBlocksCache();
+    _currentGauge = gauge;
+  }
+  return _selectMuxChannel(gauge);
+}
+
+/**
+  @brief The gauge to which the requests are directed.
+*/
+Gauge *currentGauge() {
+  return _currentGauge;
+}
+
+/**
+  Wait for the response of the subcommand sent at sentUs and read the block.
+  The echo is polled only for the rest of MAC_COMPLETION_TIMEOUT_US, which has mostly passed already.
+*/
+void _pollGaugeResponse(word MACSubcmd, unsigned long sentUs, byte *buf) {
+  memset(buf, 0, BlockProtocol::RESPONSE_MAX_SIZE);
+
+  if (MacCompletion::POLLING == MAC_COMPLETION_MODE) {
+    do {
+      sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
+      if (BlockProtocol::ADDR_SIZE == rawRequestBytes(buf, BlockProtocol::ADDR_SIZE) && MACSubcmd == composeWord(buf)) {
+        requestBlockData(buf);
+        return;
+      }
+    } while (micros() - sentUs < MAC_COMPLETION_TIMEOUT_US);
+  } else {
+    while (micros() - sentUs < MAC_COMPLETION_TIMEOUT_US);
+  }
+
+  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS);
+  requestBlock(buf);
+}
+
+/**
+  @brief Send the MAC subcommand to every gauge first, then read all the responses.
+
+  The processing time of the subcommand on one gauge overlaps with the traffic of the others,
+  so the wait of MAC_COMPLETION_TIMEOUT_US is paid about once per round instead of once per gauge.
+  The response is accepted only if it echoes the subcommand.
+  If the subcommand is OperationStatus, the result and the security mode are stored into the gauge.
+
+  At most GaugeMux::MAX_POLLED_GAUGES gauges are polled, the selected gauge is restored at the end.
+
+  @returns number of the valid responses
+
+  @see AltManufacturerAccess()
+*/
+byte macPollGauges(Gauge **gauges, byte count, word MACSubcmd, GaugeMacCallback callback) {
+  if (count > GaugeMux::MAX_POLLED_GAUGES) count = GaugeMux::MAX_POLLED_GAUGES;
+
+  Gauge *selected = _currentGauge;
+  unsigned long sentUs[GaugeMux::MAX_POLLED_GAUGES];
+  bool isSent[GaugeMux::MAX_POLLED_GAUGES];
+
+  for (byte i = 0; i < count; i++) {
+    isSent[i] = selectGauge(gauges[i]) && 0 == sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, MACSubcmd);
+    sentUs[i] = micros();
+  }
+
+  byte retval = 0;
+  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], data[BlockProtocol::PAYLOAD_MAX_SIZE];
+  for (byte i = 0; i < count; i++) {
+    Gauge *gauge = gauges[i];
+    byte len = 0;
+    bool isValid = false;
+
+    if (isSent[i] && selectGauge(gauge)) {
+      _pollGaugeResponse(MACSubcmd, sentUs[i], buf);
+      // the stale block of the previous subcommand is valid too, so the echoed subcommand is checked:
+      isValid = isBlockValid(buf) && MACSubcmd == composeWord(buf);
+      if (isValid) len = macBlockData(buf, data);
+    }
+
+    if (isValid) {
+      retval++;
+      if (AltManufacturerCommands::OPERATION_STATUS == MACSubcmd) {
+        gauge->operationStatus = composeDoubleWord(data);
+        gauge->operationStatusMs = millis();
+        setSecurityModeCache((gauge->operationStatus >> OperationStatusFlags::SEC0().n) & 0b11);  // the gauge is selected
+      }
+    }
+    if (NULL != callback) callback(gauge, isValid, data, len);
+  }
+
+  selectGauge(selected);
+  return retval;
+}
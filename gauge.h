@@ -0,0 +1,138 @@
+/**
+  @file gauge.h
+
+  @brief Multiple gauges on several buses and behind I2C multiplexers headers
+
+
+  All the functions of the driver work with the selected gauge, see selectGauge().
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "globals.h"
+
+/**
+  @brief Constants of the TCA9548A I2C multiplexer
+*/
+class GaugeMux {
+  public:
+    static const byte NONE = 0;  ///< The gauge is connected to the bus directly.
+    static const byte TCA9548A_ADDR = 0x70;  ///< Default address of the TCA9548A, A0..A2 = 0; up to 0x77.
+    static const byte CHANNELS = 8;  ///< Number of the channels of the TCA9548A.
+    static const byte MAX_POLLED_GAUGES = 8;  ///< Maximum number of the gauges for macPollGauges().
+};
+
+/**
+  @brief Bus of the gauge other than the Wire library: a simulator, a logger, a bridge.
+
+  The functions have the same meaning as the Wire transactions:
+  - write - the register followed by len bytes of the data, returns the status of TwoWire::endTransmission(), 0 = success;
+  - read - returns the number of the received bytes, as TwoWire::requestFrom().
+
+  @see SimulatedGauge
+*/
+struct GaugeTransport {
+  int (*write)(void *ctx, byte addr, byte reg, const byte *data, byte len);
+  byte (*read)(void *ctx, byte addr, byte *buf, byte len);
+  void *ctx;  ///< passed to the functions as is
+};
+
+/**
+  @brief Bus, address and cached state of a single gauge.
+
+  @code
+    Gauge pack1(Wire, DEVICE_ADDR, GaugeMux::TCA9548A_ADDR, 0);
+    Gauge pack2(Wire, DEVICE_ADDR, GaugeMux::TCA9548A_ADDR, 1);
+    selectGauge(&pack2);
+    Voltage();
+  @endcode
+
+  The gauge connected through the GaugeTransport has no multiplexer.
+*/
+struct Gauge {
+  TwoWire *wire;  ///< NULL if the transport is used
+  GaugeTransport *transport;  ///< NULL = Wire
+  byte addr;  ///< I2C address of the gauge, DEVICE_ADDR by default
+  byte muxAddr;  ///< I2C address of the multiplexer, GaugeMux::NONE if there is no multiplexer
+  byte muxChannel;  ///< channel of the multiplexer [0; 7]
+
+  byte securityMode;  ///< last known SecurityMode, @see getSecurityModeCache()
+  u32 operationStatus;  ///< last OperationStatus obtained by macPollGauges() or by the user
+  unsigned long operationStatusMs;  ///< millis() of the operationStatus, 0 = not obtained
+
+  word dfShadowValid;  ///< bit per valid parameter of dfShadow, @see invalidateDfShadowCache()
+  byte dfShadow[DF_SHADOW::COUNT][DF_SHADOW::VALUE_MAX_SIZE];  ///< values of the shadowed Data Flash parameters, @see DF_SHADOW
+
+  Gauge(TwoWire &wire = Wire, byte addr = DEVICE_ADDR, byte muxAddr = GaugeMux::NONE, byte muxChannel = 0);
+  Gauge(GaugeTransport *transport, byte addr = DEVICE_ADDR);
+};
+
+/**
+  @brief The gauge connected to Wire at DEVICE_ADDR, selected by default.
+*/
+extern Gauge DEFAULT_GAUGE;
+
+/**
+  @brief Direct all the following requests of the driver to the gauge.
+
+  The channel of the multiplexer is switched only if it differs from the last selected one.
+  The decoded status blocks are forgotten when the gauge is changed,
+  the security mode and the Data Flash shadow copy are kept per gauge.
+
+  @returns whether the multiplexer has acknowledged the channel, true if there is no multiplexer
+
+  @see invalidateStatusBlocksCache()
+*/
+bool selectGauge(Gauge *gauge);
+
+/**
+  @brief The gauge to which the requests are directed.
+*/
+Gauge *currentGauge();
+
+/**
+  @brief Receiver of the MAC response of a single gauge.
+  @param isValid - whether the response is valid, data is empty otherwise
+*/
+typedef void (*GaugeMacCallback)(Gauge *gauge, bool isValid, const byte *data, byte len);
+
+/**
+  @brief Send the MAC subcommand to every gauge first, then read all the responses.
+
+  The processing time of the subcommand on one gauge overlaps with the traffic of the others,
+  so the wait of MAC_COMPLETION_TIMEOUT_US is paid about once per round instead of once per gauge.
+  The response is accepted only if it echoes the subcommand.
+  If the subcommand is OperationStatus, the result and the security mode are stored into the gauge.
+
+  At most GaugeMux::MAX_POLLED_GAUGES gauges are polled, the selected gauge is restored at the end.
+
+  @returns number of the valid responses
+
+  @see AltManufacturerAccess()
+*/
+byte macPollGauges(Gauge **gauges, byte count, word MACSubcmd, GaugeMacCallback callback = NULL);
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include <stddef.h>
 
 #include "flags.h"
 
@@ -55,6 +56,10 @@ const int DEVICE_ADDR = 0x55;
 */
 class SecurityMode {
   public:
+    /**
+      (SEC1, SEC0) = (0, 0), not a valid mode of the device
+    */
+    static const byte RESERVED = 0;
     /**
       (SEC1, SEC0) = (0, 1)
     */
@@ -67,6 +72,11 @@ class SecurityMode {
       (SEC1, SEC0) = (1, 1)
     */
     static const byte SEALED = 3;
+    /**
+      Security mode has not been requested yet or was invalidated.
+      @see getSecurityModeCache()
+    */
+    static const byte UNKNOWN = 0xFF;
 };
 
 /**
@@ -91,6 +101,18 @@ class DeviceSecurity {
       @warning [!] Can be used only for Unsealed Device (after using Unseal Key).
     */
     static const u32 DEFAULT_FULL_ACCESS_KEY = 0xFFFFFFFF;
+    /**
+      The longest wait for the new security mode after the key was sent, ms.
+    */
+    static const word TRANSITION_TIMEOUT_MS = 1000;
+    /**
+      Delay before the first check of the new security mode, ms; doubled before every next check.
+    */
+    static const word TRANSITION_POLL_MS = 10;
+    /**
+      The longest delay between the checks of the new security mode, ms.
+    */
+    static const word TRANSITION_MAX_POLL_MS = 160;
 };
 
 /**
@@ -120,6 +142,106 @@ class BlockProtocol {
     static const int MAX = RESPONSE_MAX_SIZE;
 };
 
+/**
+  @brief Constants for waiting of the MAC response
+
+  @see MAC_COMPLETION_MODE
+  @see MAC_COMPLETION_TIMEOUT_US
+  @see AltManufacturerAccess()
+*/
+class MacCompletion {
+  public:
+    /**
+      Wait MAC_COMPLETION_TIMEOUT_US before reading the response.
+    */
+    static const byte FIXED_DELAY = 0;
+    /**
+      Read back 0x3E/0x3F until the device echoes the sent subcommand,
+      but no longer than MAC_COMPLETION_TIMEOUT_US.
+    */
+    static const byte POLLING = 1;
+    /**
+      The delay which was required for the chip to process the request, us.
+    */
+    static const word DEFAULT_TIMEOUT_US = 5000;
+    /**
+      Pause between the reads of 0x3E/0x3F while polling, us.
+    */
+    static const word POLL_INTERVAL_US = 200;
+    /**
+      Width of one bin of the MAC latency histogram, us.
+    */
+    static const word LATENCY_BIN_US = 500;
+    /**
+      Number of bins of the MAC latency histogram.
+      The last bin collects the longer waits and the timeouts.
+    */
+    static const byte LATENCY_BINS = 10;
+    /**
+      Number of the distinct subcommands tracked by the MAC latency histogram.
+    */
+    static const byte LATENCY_SLOTS = 6;
+};
+
+/**
+  @brief Classes of the bus errors and the retry defaults
+
+  The codes from NACK_ADDR to OTHER have the same values as the result of TwoWire::endTransmission().
+
+  @see BUS_RETRIES
+  @see BUS_BACKOFF_US
+  @see busErrorCount()
+*/
+class BusError {
+  public:
+    static const byte OK = 0;  ///< No error.
+    static const byte TOO_LONG = 1;  ///< The data is too long for the transmit buffer.
+    static const byte NACK_ADDR = 2;  ///< NACK on the transmit of the address.
+    static const byte NACK_DATA = 3;  ///< NACK on the transmit of the data.
+    static const byte OTHER = 4;  ///< Other error of the write, including the timeout.
+    static const byte SHORT_READ = 5;  ///< The device returned fewer bytes than requested.
+    static const byte CHECKSUM = 6;  ///< Checksum of the response block does not match.
+    static const byte LENGTH = 7;  ///< Length of the response block is out of the range.
+    static const byte MAC_TIMEOUT = 8;  ///< The device has not echoed the MAC subcommand within MAC_COMPLETION_TIMEOUT_US.
+    static const byte COUNT = 9;  ///< Number of the classes.
+
+    /**
+      Number of the repeats of the failed transaction, besides the first attempt.
+    */
+    static const byte DEFAULT_RETRIES = 2;
+    /**
+      Delay before the first repeat, us; doubled before every next one.
+    */
+    static const word DEFAULT_BACKOFF_US = 500;
+    /**
+      The longest delay between the repeats, us.
+    */
+    static const word MAX_BACKOFF_US = 16000;
+};
+
+/**
+  @brief Shadow copy of the hot Data Flash parameters
+
+  Configuration parameters, such as the protection thresholds, are changed only by the host,
+  so they are requested from the device only once: by the first read, together with the other
+  shadowed parameters from the same block. The following reads are served from RAM without the bus.
+
+  - dfWriteBytes() forgets the shadowed parameters it overwrites, the device read refreshes them;
+  - DeviceReset(), LifetimeDataReset() and any change of the cached security mode forget the whole copy;
+  - every Gauge keeps its own copy, so the selection of another gauge does not forget it.
+
+  Gas Gauging State values (Qmax, Update Status, Cycle Count) are updated by the device and are not shadowed.
+
+  @see invalidateDfShadowCache()
+*/
+class DF_SHADOW {
+  public:
+    static const byte VALUE_MAX_SIZE = 2;  ///< I2, U2, H2
+    static const byte COUNT = 10;  ///< Number of the shadowed parameters.
+    static const byte SAVED_ENTRY_SIZE = 2 + VALUE_MAX_SIZE;  ///< Address LE and value, see dfShadowSave()
+    static const byte SAVED_SIZE = COUNT * SAVED_ENTRY_SIZE;  ///< Buffer enough for dfShadowSave()
+};
+
 /**
   @brief 12.1 Standard Data Commands
 
@@ -257,6 +379,10 @@ class AltManufacturerCommands {
       @see 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert()
     */
     static const word SAFETY_ALERT = 0x0050;
+    /**
+      @see 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus()
+    */
+    static const word SAFETY_STATUS = 0x0051;
     /**
       @see 12.2.28 AltManufacturerAccess() 0x0052 PFAlert()
     */
@@ -451,6 +577,139 @@ class IT_STATUS_3 {
     static const byte RAW_DOD0_2 = 18;
 };
 
+/*
+  Decoded MAC blocks.
+
+  The fields are laid out exactly as the bytes of MACData(), so the block is decoded by a single memcpy().
+  The device and the supported controllers (AVR, ARM, ESP) are Little Endian.
+*/
+
+/**
+  @brief 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1() decoded.
+  @see DA_STATUS_1
+*/
+struct __attribute__((packed)) DAStatus1Data {
+  int16_t cellVoltage1;  ///< AAaa: Cell Voltage 1, mV
+  int16_t cellVoltage2;  ///< BBbb: Cell Voltage 2, mV
+  int16_t reserved1;  ///< CCcc
+  int16_t reserved2;  ///< DDdd
+  int16_t batVoltage;  ///< EEee: BAT Voltage, mV
+  int16_t packVoltage;  ///< FFff: PACK Voltage, mV
+  int16_t cellCurrent1;  ///< GGgg: Cell Current 1, mA
+  int16_t cellCurrent2;  ///< HHhh: Cell Current 2, mA
+  int16_t reserved3;  ///< IIii
+  int16_t reserved4;  ///< JJjj
+  int16_t cellPower1;  ///< KKkk: Cell Power 1, cW
+  int16_t cellPower2;  ///< LLll: Cell Power 2, cW
+  int16_t reserved5;  ///< MMmm
+  int16_t reserved6;  ///< NNnn
+  int16_t power;  ///< OOoo: Power calculated by Voltage() × Current(), cW
+  int16_t avgPower;  ///< PPpp: Average Power calculated by Voltage() × AverageCurrent(), cW
+};
+static_assert(offsetof(DAStatus1Data, cellVoltage1) == DA_STATUS_1::CELL_VOLTAGE_1, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, cellVoltage2) == DA_STATUS_1::CELL_VOLTAGE_2, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, batVoltage) == DA_STATUS_1::BAT_VOLTAGE, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, packVoltage) == DA_STATUS_1::PACK_VOLTAGE, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, cellCurrent1) == DA_STATUS_1::CELL_CURRENT_1, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, cellCurrent2) == DA_STATUS_1::CELL_CURRENT_2, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, cellPower1) == DA_STATUS_1::CELL_POWER_1, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, cellPower2) == DA_STATUS_1::CELL_POWER_2, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, power) == DA_STATUS_1::POWER, "DAStatus1Data layout");
+static_assert(offsetof(DAStatus1Data, avgPower) == DA_STATUS_1::AVG_POWER, "DAStatus1Data layout");
+static_assert(sizeof(DAStatus1Data) == BlockProtocol::PAYLOAD_MAX_SIZE, "DAStatus1Data size");
+
+/**
+  @brief 12.2.39 AltManufacturerAccess() 0x0073 ITStatus1() decoded.
+*/
+struct __attribute__((packed)) ITStatus1Data {
+  int16_t trueRemQ;  ///< AAaa: True Rem Q, mAh
+  int16_t trueRemE;  ///< BBbb: True Rem E, cWh
+  int16_t initialQ;  ///< CCcc: Initial Q
+  int16_t initialE;  ///< DDdd: Initial E
+  int16_t trueFullChgQ;  ///< EEee: TrueFullChgQ
+  int16_t trueFullChgE;  ///< FFff: TrueFullChgE
+  int16_t tSim;  ///< GGgg: T_sim, 0.1 K
+  int16_t tAmbient;  ///< HHhh: T_ambient, 0.1 K
+  int16_t raScale0;  ///< IIii: RaScale 0
+  int16_t raScale1;  ///< JJjj: RaScale 1
+  int16_t compRes1;  ///< KKkk: CompRes1
+  int16_t compRes2;  ///< LLll: CompRes2
+};
+static_assert(sizeof(ITStatus1Data) == 24, "ITStatus1Data size");
+
+/**
+  @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2() decoded.
+  @see IT_STATUS_2
+*/
+struct __attribute__((packed)) ITStatus2Data {
+  byte packGrid;  ///< AA: Pack Grid
+  byte lStatus;  ///< BB: LStatus. Learned status of resistance table
+  byte cellGrid1;  ///< CC: Cell Grid 1
+  byte cellGrid2;  ///< DD: Cell Grid 2
+  byte reserved1;  ///< EE
+  byte reserved2;  ///< FF
+  u32 stateTime;  ///< HHhhGGgg: State Time
+  int16_t dod0_1;  ///< IIii: DOD0_1
+  int16_t dod0_2;  ///< JJjj: DOD0_2
+  int16_t dod0PassedQ;  ///< KKkk: DOD0 Passed Q
+  int16_t dod0PassedEnergy;  ///< LLll: DOD0 Passed Energy
+  int16_t dod0Time;  ///< MMmm: DOD0 Time
+  int16_t dodEoc1;  ///< NNnn: DODEOC_1
+  int16_t dodEoc2;  ///< OOoo: DODEOC_2
+};
+static_assert(offsetof(ITStatus2Data, dod0_1) == IT_STATUS_2::DOD0_1, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dod0_2) == IT_STATUS_2::DOD0_2, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dod0PassedQ) == IT_STATUS_2::DOD0_Passed_Q, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dod0PassedEnergy) == IT_STATUS_2::DOD0_Passed_Energy, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dod0Time) == IT_STATUS_2::DOD0_Time, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dodEoc1) == IT_STATUS_2::DODEOC_1, "ITStatus2Data layout");
+static_assert(offsetof(ITStatus2Data, dodEoc2) == IT_STATUS_2::DODEOC_2, "ITStatus2Data layout");
+static_assert(sizeof(ITStatus2Data) == 24, "ITStatus2Data size");
+
+/**
+  @brief 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3() decoded.
+  @see IT_STATUS_3
+*/
+struct __attribute__((packed)) ITStatus3Data {
+  int16_t qMax1;  ///< AAaa: QMax 1, mAh
+  int16_t qMax2;  ///< BBbb: QMax 2, mAh
+  int16_t qMaxDod0_1;  ///< CCcc: QMaxDOD0_1
+  int16_t qMaxDod0_2;  ///< DDdd: QMaxDOD0_2
+  int16_t qMaxPassedQ;  ///< EEee: QMaxPassedQ, mAh
+  int16_t qMaxTime;  ///< FFff: QMaxTime, hour / 16
+  int16_t tk;  ///< GGgg: Tk. Thermal model “k”
+  int16_t ta;  ///< HHhh: Ta. Thermal model “a”
+  int16_t rawDod0_1;  ///< IIii: RawDOD0_1
+  int16_t rawDod0_2;  ///< JJjj: RawDOD0_2
+};
+static_assert(offsetof(ITStatus3Data, qMax1) == IT_STATUS_3::QMax_1, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, qMax2) == IT_STATUS_3::QMax_2, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, qMaxDod0_1) == IT_STATUS_3::QMaxDOD0_1, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, qMaxDod0_2) == IT_STATUS_3::QMaxDOD0_2, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, qMaxPassedQ) == IT_STATUS_3::QMaxPassedQ, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, qMaxTime) == IT_STATUS_3::QMaxTime, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, tk) == IT_STATUS_3::Tk, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, ta) == IT_STATUS_3::Ta, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, rawDod0_1) == IT_STATUS_3::RAW_DOD0_1, "ITStatus3Data layout");
+static_assert(offsetof(ITStatus3Data, rawDod0_2) == IT_STATUS_3::RAW_DOD0_2, "ITStatus3Data layout");
+static_assert(sizeof(ITStatus3Data) == 20, "ITStatus3Data size");
+
+/**
+  @brief Basic telemetry obtained by readTelemetryFrame() in the native units of the device.
+  @see readStdRange()
+*/
+struct TelemetryFrame {
+  word temperature;  ///< 0x06/07 Temperature(), 0.1 K
+  word voltage;  ///< 0x08/09 Voltage(), mV
+  word batteryStatus;  ///< 0x0A/0B BatteryStatus()
+  int16_t current;  ///< 0x0C/0D Current(), mA
+  word remainingCapacity;  ///< 0x10/11 RemainingCapacity(), mAh
+  word fullChargeCapacity;  ///< 0x12/13 FullChargeCapacity(), mAh
+  int16_t averageCurrent;  ///< 0x14/15 AverageCurrent(), mA
+  word relativeStateOfCharge;  ///< 0x2C/2D RelativeStateOfCharge(), %
+  unsigned long timestamp;  ///< millis() of the reading
+};
+
 /**
   @brief Units of measurement to print to serial port.
 */
@@ -486,7 +745,7 @@ const float DECIPART = 0.1;
 /**
   @brief Number of decimal places
 */
-const float DECIPART_DECIMAL = 1;
+const byte DECIPART_DECIMAL = 1;
 
 /**
   @brief 1/1000 part
@@ -496,3 +755,25 @@ const float PERMIL = 0.001;
   @brief Number of decimal places
 */
 const byte PERMIL_DECIMAL = 3;
+
+/**
+  1 = the measurements are integers in the native units of the device: mV, mA, 0.1 K,
+  0 = the voltages are float in V and the temperature in °C.
+
+  The integer mode removes the float math and the float formatting from the measurement functions.
+
+  Can be enabled with the build flag: -DFIXED_POINT=1
+*/
+#ifndef FIXED_POINT
+#define FIXED_POINT 0
+#endif
+
+/**
+  @brief Type of the value returned by the measurement functions like Voltage() and Temperature().
+  @see FIXED_POINT
+*/
+#if FIXED_POINT
+typedef long Measurement;
+#else
+typedef float Measurement;
+#endif
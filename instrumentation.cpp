@@ -0,0 +1,230 @@
+/**
+  @file instrumentation.cpp
+
+  @brief Compile-time optional counters of the bus traffic and the delays, implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "instrumentation.h"
+#include "utils.h"
+#include "data_flash_access.h"
+
+#if DRIVER_INSTRUMENTATION
+
+/**
+  Counters of the single command.
+*/
+struct _InstrumentSlot {
+  byte family;
+  word code;
+  word transactions;
+  word invalid;
+  u32 bytesOut;
+  u32 bytesIn;
+  u32 busUs;
+  u32 delayUs;
+};
+
+_InstrumentSlot _instrumentSlots[Instrumentation::SLOTS];
+byte _instrumentCount = 0;
+_InstrumentSlot _instrumentTotal;
+
+/**
+  Slot of the last written command, NULL if it does not fit into the table.
+*/
+_InstrumentSlot *_instrumentCurrent = NULL;
+
+/**
+  Number of the following writes to 0x3E which are the words of the security key.
+*/
+byte _instrumentKeyWords = 0;
+
+/**
+  @returns the slot of the command, NULL if the table is full
+*/
+_InstrumentSlot *_instrumentSlot(byte family, word code) {
+  byte i = 0;
+  while (i < _instrumentCount && (_instrumentSlots[i].family != family || _instrumentSlots[i].code != code)) i++;
+
+  if (i == _instrumentCount) {
+    if (_instrumentCount >= Instrumentation::SLOTS) return NULL;
+    memset(&_instrumentSlots[i], 0, sizeof(_InstrumentSlot));
+    _instrumentSlots[i].family = family;
+    _instrumentSlots[i].code = code;
+    _instrumentCount++;
+  }
+
+  return &_instrumentSlots[i];
+}
+
+/**
+  Add the counters to the slot and to the totals.
+*/
+void _instrumentAdd(_InstrumentSlot *slot, word transactions, u32 bytesOut, u32 bytesIn, u32 busUs, u32 delayUs) {
+  _InstrumentSlot *slots[] = {&_instrumentTotal, slot};
+  for (byte i = 0; i < 2; i++) {
+    if (NULL == slots[i]) continue;
+    if (slots[i]->transactions <= 0xFFFF - transactions) slots[i]->transactions += transactions;
+    slots[i]->bytesOut += bytesOut;
+    slots[i]->bytesIn += bytesIn;
+    slots[i]->busUs += busUs;
+    slots[i]->delayUs += delayUs;
+  }
+}
+
+/**
+  Count the write of len data bytes into the register, which took us microseconds.
+  The command of the write is selected as the owner of the following reads and delays.
+*/
+void instrumentWrite(byte reg, const byte *data, int len, unsigned long us) {
+  if (StdCommands::ALT_MANUFACTURER_ACCESS == reg && _instrumentKeyWords > 0) {
+    _instrumentCurrent = NULL;
+  } else if (StdCommands::ALT_MANUFACTURER_ACCESS == reg && len >= 2) {
+    const word code = (data[1] << 8) | data[0];
+    _instrumentCurrent = _instrumentSlot(code >= DF_ADDR::MIN ? Instrumentation::DF : Instrumentation::MAC, code);
+  } else if (StdCommands::ALT_MANUFACTURER_ACCESS != reg
+             && StdCommands::MAC_DATA != reg
+             && StdCommands::MAC_DATA_CHECKSUM != reg
+             && StdCommands::MAC_DATA_CHECKSUM + 1 != reg) {  // + 1 = 0x61 MACDataLength
+    _instrumentCurrent = _instrumentSlot(Instrumentation::STD, reg);
+  }  // otherwise the access belongs to the last MAC command
+
+  _instrumentAdd(_instrumentCurrent, 1, len, 0, us, 0);
+}
+
+/**
+  The logical write into the register is finished, after all its attempts.
+  The retries of the security key word are counted for the same word.
+*/
+void instrumentWriteEnd(byte reg) {
+  if (StdCommands::ALT_MANUFACTURER_ACCESS == reg && _instrumentKeyWords > 0) _instrumentKeyWords--;
+}
+
+/**
+  Count the read of len bytes, which took us microseconds, for the last written command.
+*/
+void instrumentRead(int len, unsigned long us) {
+  _instrumentAdd(_instrumentCurrent, 1, 0, len, us, 0);
+}
+
+/**
+  Count the response of the last written command rejected by the validation.
+*/
+void instrumentValidationFailure() {
+  if (_instrumentTotal.invalid < 0xFFFF) _instrumentTotal.invalid++;
+  if (NULL != _instrumentCurrent && _instrumentCurrent->invalid < 0xFFFF) _instrumentCurrent->invalid++;
+}
+
+/**
+  The next two writes to 0x3E AltManufacturerAccess are the words of the security key:
+  they are counted in the totals only, so the key does not appear in the report as the MAC subcommands.
+*/
+void instrumentSecurityKey() {
+  _instrumentKeyWords = 2;
+}
+
+/**
+  delay() which is counted for the last written command.
+*/
+void instrumentedDelay(unsigned long ms) {
+  const unsigned long start = micros();
+  delay(ms);
+  _instrumentAdd(_instrumentCurrent, 0, 0, 0, 0, micros() - start);
+}
+
+/**
+  delayMicroseconds() which is counted for the last written command.
+*/
+void instrumentedDelayMicroseconds(unsigned int us) {
+  const unsigned long start = micros();
+  delayMicroseconds(us);
+  _instrumentAdd(_instrumentCurrent, 0, 0, 0, 0, micros() - start);
+}
+
+/**
+  Print the single CSV line of the slot.
+*/
+void _printInstrumentSlot(Print &out, const _InstrumentSlot *slot, bool isTotal) {
+  if (isTotal) {
+    out.print(F("total,"));
+  } else {
+    if (Instrumentation::STD == slot->family) out.print(F("std,0x"));
+    else if (Instrumentation::MAC == slot->family) out.print(F("mac,0x"));
+    else out.print(F("df,0x"));
+
+    for (byte shift = (Instrumentation::STD == slot->family ? 4 : 12); shift > 0; shift -= 4) {  // leading zeros
+      if (slot->code >> shift) break;
+      out.print('0');
+    }
+    out.print(slot->code, HEX);
+  }
+
+  out.print(',');
+  out.print(slot->transactions);
+  out.print(',');
+  out.print(slot->bytesOut);
+  out.print(',');
+  out.print(slot->bytesIn);
+  out.print(',');
+  out.print(slot->busUs);
+  out.print(',');
+  out.print(slot->delayUs);
+  out.print(',');
+  out.println(slot->invalid);
+}
+
+/**
+  Print the counters to out in CSV, see Instrumentation.
+  Only the comment line is printed if DRIVER_INSTRUMENTATION is 0.
+*/
+void printInstrumentation(Print &out) {
+  out.println(F("family,command,transactions,bytes_out,bytes_in,bus_us,delay_us,invalid"));
+  for (byte i = 0; i < _instrumentCount; i++) _printInstrumentSlot(out, &_instrumentSlots[i], false);
+  _printInstrumentSlot(out, &_instrumentTotal, true);
+}
+
+void resetInstrumentation() {
+  _instrumentCount = 0;
+  _instrumentCurrent = NULL;
+  _instrumentKeyWords = 0;
+  memset(&_instrumentTotal, 0, sizeof(_instrumentTotal));
+}
+
+#else
+
+void instrumentWrite(byte, const byte *, int, unsigned long) {}
+void instrumentWriteEnd(byte) {}
+void instrumentRead(int, unsigned long) {}
+void instrumentValidationFailure() {}
+void instrumentSecurityKey() {}
+void instrumentedDelay(unsigned long ms) { delay(ms); }
+void instrumentedDelayMicroseconds(unsigned int us) { delayMicroseconds(us); }
+
+void printInstrumentation(Print &out) {
+  out.println(F("# instrumentation is disabled, build with -DDRIVER_INSTRUMENTATION=1"));
+}
+
+void resetInstrumentation() {}
+
+#endif
@@ -0,0 +1,155 @@
+/**
+  @file instrumentation.h
+
+  @brief Compile-time optional counters of the bus traffic and the delays, headers
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+
+/**
+  1 = count the bus transactions, bytes and the time spent in the Wire calls and delays,
+  0 = the hooks are compiled out, the delays are plain delay() calls.
+
+  Can be enabled with the build flag: -DDRIVER_INSTRUMENTATION=1
+*/
+#ifndef DRIVER_INSTRUMENTATION
+#define DRIVER_INSTRUMENTATION 0
+#endif
+
+/**
+  @brief Constants of the instrumentation counters.
+
+  The counters are kept per command in a small table:
+  - std - the register of the Standard Data Command;
+  - mac - the MAC subcommand written to 0x3E AltManufacturerAccess;
+  - df - the Data Flash address (DF_ADDR::MIN and above) written to 0x3E AltManufacturerAccess,
+    alone to read the Data Flash or with the data to write it.
+
+  The polling of 0x3E and the access to 0x40 MACData, 0x60 checksum, 0x61 length
+  belong to the MAC command which was sent last, the reads and the delays belong to the last written command.
+  The commands that do not fit into the table and the words of the security keys are counted in the totals only.
+
+  The report is CSV:
+  <pre>
+    family,command,transactions,bytes_out,bytes_in,bus_us,delay_us,invalid
+    std,0x08,12,12,24,4810,0,0
+    mac,0x0054,3,57,108,6120,0,1
+    total,,15,69,132,10930,0,1
+  </pre>
+
+  - transactions - number of the writes and the reads;
+  - bytes_out, bytes_in - bytes written and read, the address byte excluded;
+  - bus_us - time spent in the Wire calls (or in the transport), us;
+  - delay_us - time spent in the delays of the driver, us;
+  - invalid - number of the responses rejected by the validation.
+
+  @see DRIVER_INSTRUMENTATION
+  @see printInstrumentation()
+*/
+class Instrumentation {
+  public:
+    static const byte STD = 0;
+    static const byte MAC = 1;
+    static const byte DF = 2;
+#if defined(__AVR__)
+    static const byte SLOTS = 8;  ///< 23 bytes of RAM per slot
+#else
+    static const byte SLOTS = 32;
+#endif
+};
+
+#if DRIVER_INSTRUMENTATION
+
+#define INSTRUMENT_START(start) const unsigned long start = micros()
+#define INSTRUMENT_WRITE(reg, data, len, start) instrumentWrite(reg, data, len, micros() - (start))
+#define INSTRUMENT_WRITE_END(reg) instrumentWriteEnd(reg)
+#define INSTRUMENT_READ(len, start) instrumentRead(len, micros() - (start))
+#define INSTRUMENT_INVALID() instrumentValidationFailure()
+#define INSTRUMENT_SECURITY_KEY() instrumentSecurityKey()
+#define DRIVER_DELAY(ms) instrumentedDelay(ms)
+#define DRIVER_DELAY_US(us) instrumentedDelayMicroseconds(us)
+
+#else
+
+#define INSTRUMENT_START(start)
+#define INSTRUMENT_WRITE(reg, data, len, start)
+#define INSTRUMENT_WRITE_END(reg)
+#define INSTRUMENT_READ(len, start)
+#define INSTRUMENT_INVALID()
+#define INSTRUMENT_SECURITY_KEY()
+#define DRIVER_DELAY(ms) delay(ms)
+#define DRIVER_DELAY_US(us) delayMicroseconds(us)
+
+#endif
+
+/**
+  Count the write of len data bytes into the register, which took us microseconds.
+  The command of the write is selected as the owner of the following reads and delays.
+*/
+void instrumentWrite(byte reg, const byte *data, int len, unsigned long us);
+
+/**
+  The logical write into the register is finished, after all its attempts.
+  The retries of the security key word are counted for the same word.
+*/
+void instrumentWriteEnd(byte reg);
+
+/**
+  Count the read of len bytes, which took us microseconds, for the last written command.
+*/
+void instrumentRead(int len, unsigned long us);
+
+/**
+  Count the response of the last written command rejected by the validation.
+*/
+void instrumentValidationFailure();
+
+/**
+  The next two writes to 0x3E AltManufacturerAccess are the words of the security key:
+  they are counted in the totals only, so the key does not appear in the report as the MAC subcommands.
+*/
+void instrumentSecurityKey();
+
+/**
+  delay() which is counted for the last written command.
+*/
+void instrumentedDelay(unsigned long ms);
+
+/**
+  delayMicroseconds() which is counted for the last written command.
+*/
+void instrumentedDelayMicroseconds(unsigned int us);
+
+/**
+  Print the counters to out in CSV, see Instrumentation.
+  Only the comment line is printed if DRIVER_INSTRUMENTATION is 0.
+*/
+void printInstrumentation(Print &out = Serial);
+
+void resetInstrumentation();
@@ -0,0 +1,221 @@
+/**
+  @file learning_cycle.cpp
+
+  @brief Unattended Learning Cycle of the Impedance Track, implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "learning_cycle.h"
+
+const char _PHASE_IDLE[] PROGMEM = "IDLE";
+const char _PHASE_CHARGE[] PROGMEM = "CHARGE";
+const char _PHASE_RELAX_CHARGED[] PROGMEM = "RELAX_CHARGED";
+const char _PHASE_DISCHARGE[] PROGMEM = "DISCHARGE";
+const char _PHASE_RELAX_DISCHARGED[] PROGMEM = "RELAX_DISCHARGED";
+const char _PHASE_DONE[] PROGMEM = "DONE";
+const char _PHASE_FAILED[] PROGMEM = "FAILED";
+
+/**
+  Names of the phases in the order of the LearningCycle codes.
+*/
+PGM_P const _PHASE_NAMES[] PROGMEM = {
+  _PHASE_IDLE,
+  _PHASE_CHARGE,
+  _PHASE_RELAX_CHARGED,
+  _PHASE_DISCHARGE,
+  _PHASE_RELAX_DISCHARGED,
+  _PHASE_DONE,
+  _PHASE_FAILED
+};
+
+/**
+  @brief Name of the phase for printing.
+*/
+PGM_P learningCyclePhaseName(byte phase) {
+  if (phase > LearningCycle::FAILED) return NULL;
+  return (PGM_P) pgm_read_ptr(&_PHASE_NAMES[phase]);
+}
+
+/**
+  Put the FETs into the state of the phase and start the phase.
+  The gauge of the cycle should be selected.
+*/
+void _learningCycleEnter(LearningCycleState *cycle, byte phase) {
+  if (LearningCycle::CHARGE == phase && cycle->charges >= LearningCycle::MAX_CHARGES) phase = LearningCycle::FAILED;
+
+  const byte previous = cycle->phase;
+  cycle->phase = phase;
+  cycle->phaseStartMs = millis();
+
+  switch (phase) {
+    case LearningCycle::CHARGE:
+      cycle->charges++;
+      manufactoryDischargeFet(false);
+      manufactoryChargeFet(true);
+      break;
+    case LearningCycle::DISCHARGE:
+      manufactoryChargeFet(false);
+      manufactoryDischargeFet(true);
+      break;
+    case LearningCycle::RELAX_CHARGED:
+    case LearningCycle::RELAX_DISCHARGED:
+      manufactoryChargeFet(false);
+      manufactoryDischargeFet(false);
+      break;
+    default:  // IDLE, DONE, FAILED
+      fetControl(true);  // FETs are controlled by the firmware again
+      break;
+  }
+
+  if (NULL != cycle->onPhase) cycle->onPhase(cycle, previous);
+}
+
+/**
+  End of the relax: GaugingStatus()[REST] after the minimal time of the phase.
+  @returns whether the relax has finished, the Update Status is read in that case
+*/
+bool _learningCycleRelaxed(LearningCycleState *cycle, unsigned long minMs) {
+  if (millis() - cycle->phaseStartMs < minMs) return false;  // no bus traffic before the minimal time
+
+  u32 gaugingStatus = 0;
+  if (!rawGaugingStatus(&gaugingStatus)) return false;
+  if (!bitRead(gaugingStatus, GaugingStatusFlags::REST().n)) return false;
+
+  byte updateStatus = 0;
+  if (!dfReadBytes(DF_ADDR::GAS_GAUGING_UPDATE_STATUS, &updateStatus, sizeof(updateStatus))) return false;
+
+  cycle->updateStatus = updateStatus;
+  return true;
+}
+
+/**
+  Read what the phase needs and advance it.
+*/
+void _learningCycleCheck(LearningCycleState *cycle) {
+  static const byte CF_MASK = 0b11;
+  static const byte CF_RESISTANCE_UPDATED = 0b10;  // [CF1, CF0] = 1, 0: QMax and resistance table updated
+
+  switch (cycle->phase) {
+    case LearningCycle::CHARGE:
+      if (bitRead(rawBatteryStatus(), BatteryStatusFlags::FC().n)) _learningCycleEnter(cycle, LearningCycle::RELAX_CHARGED);
+      break;
+    case LearningCycle::DISCHARGE:
+      if (bitRead(rawBatteryStatus(), BatteryStatusFlags::FD().n)) _learningCycleEnter(cycle, LearningCycle::RELAX_DISCHARGED);
+      break;
+    case LearningCycle::RELAX_CHARGED:
+      if (_learningCycleRelaxed(cycle, LearningCycle::MIN_RELAX_CHARGED_MS)) {
+        const bool isUpdated = CF_RESISTANCE_UPDATED == (cycle->updateStatus & CF_MASK);
+        _learningCycleEnter(cycle, isUpdated ? LearningCycle::DONE : LearningCycle::DISCHARGE);
+      }
+      break;
+    case LearningCycle::RELAX_DISCHARGED:
+      if (_learningCycleRelaxed(cycle, LearningCycle::MIN_RELAX_DISCHARGED_MS)) _learningCycleEnter(cycle, LearningCycle::CHARGE);
+      break;
+    default:
+      return;
+  }
+
+  const bool isRunning = LearningCycle::DONE != cycle->phase && LearningCycle::FAILED != cycle->phase;
+  if (isRunning && millis() - cycle->phaseStartMs >= LearningCycle::PHASE_TIMEOUT_MS) {
+    _learningCycleEnter(cycle, LearningCycle::FAILED);
+  }
+}
+
+/**
+  Run the function with the gauge of the cycle selected and nothing printed.
+*/
+void _learningCycleRun(LearningCycleState *cycle, void (*fn)(LearningCycleState *cycle, byte phase), byte phase) {
+  Gauge *previous = currentGauge();
+  const bool silence = SILENCE;
+  SILENCE = true;
+
+  if (selectGauge(cycle->gauge)) fn(cycle, phase);
+
+  SILENCE = silence;
+  selectGauge(previous);
+}
+
+void _learningCycleCheckFn(LearningCycleState *cycle, byte) {
+  _learningCycleCheck(cycle);
+}
+
+/**
+  @brief Start the cycle of the gauge from the CHARGE phase.
+
+  @param onPhase - receiver of the phase changes, NULL = none
+*/
+void learningCycleBegin(LearningCycleState *cycle, Gauge *gauge, unsigned long checkPeriodMs, LearningCyclePhaseFn onPhase) {
+  memset(cycle, 0, sizeof(LearningCycleState));
+  cycle->gauge = gauge;
+  cycle->checkPeriodMs = checkPeriodMs;
+  cycle->onPhase = onPhase;
+  cycle->lastCheckMs = millis();
+
+  _learningCycleRun(cycle, _learningCycleEnter, LearningCycle::CHARGE);
+}
+
+/**
+  @brief Check the gauge if its period has passed and advance the phase, should be called from loop().
+
+  The gauge of the cycle is selected for the check, the previously selected gauge is restored.
+  Nothing is printed, regardless of SILENCE.
+
+  @returns the current phase
+*/
+byte learningCycleTick(LearningCycleState *cycle) {
+  const bool isRunning = LearningCycle::IDLE != cycle->phase
+                         && LearningCycle::DONE != cycle->phase
+                         && LearningCycle::FAILED != cycle->phase;
+  if (!isRunning) return cycle->phase;
+
+  const unsigned long now = millis();
+  if (now - cycle->lastCheckMs < cycle->checkPeriodMs) return cycle->phase;
+  cycle->lastCheckMs = now;
+
+  _learningCycleRun(cycle, _learningCycleCheckFn, cycle->phase);
+  return cycle->phase;
+}
+
+/**
+  @brief Tick all the cycles, one call per loop().
+  @returns number of the cycles which are not finished yet
+*/
+byte learningCycleTick(LearningCycleState *cycles, byte count) {
+  byte retval = 0;
+  for (byte i = 0; i < count; i++) {
+    const byte phase = learningCycleTick(&cycles[i]);
+    if (LearningCycle::DONE != phase && LearningCycle::FAILED != phase && LearningCycle::IDLE != phase) retval++;
+  }
+  return retval;
+}
+
+/**
+  @brief Stop the cycle (IDLE) and return the FETs to the firmware control.
+*/
+void learningCycleAbort(LearningCycleState *cycle) {
+  const bool isRunning = LearningCycle::IDLE != cycle->phase
+                         && LearningCycle::DONE != cycle->phase
+                         && LearningCycle::FAILED != cycle->phase;
+  if (isRunning) _learningCycleRun(cycle, _learningCycleEnter, LearningCycle::IDLE);
+}
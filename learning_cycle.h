@@ -0,0 +1,133 @@
+/**
+  @file learning_cycle.h
+
+  @brief Unattended Learning Cycle of the Impedance Track, headers
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "gauge.h"
+#include "service.h"
+
+/**
+  @brief Phases and timings of the unattended Learning Cycle.
+
+  <pre>
+    CHARGE -> RELAX_CHARGED -> DISCHARGE -> RELAX_DISCHARGED -> CHARGE -> RELAX_CHARGED -> DONE
+  </pre>
+
+  - CHARGE: CHG FET on, DSG FET off, until BatteryStatus()[FC];
+  - RELAX_CHARGED: both FETs off, until GaugingStatus()[REST] and at least MIN_RELAX_CHARGED_MS;
+    DONE if the Gas Gauging Update Status reports the updated resistance table ([CF1, CF0] = 1, 0: 0x06, 0x0E),
+    DISCHARGE otherwise;
+  - DISCHARGE: CHG FET off, DSG FET on, until BatteryStatus()[FD];
+  - RELAX_DISCHARGED: both FETs off, until GaugingStatus()[REST] and at least MIN_RELAX_DISCHARGED_MS, then CHARGE.
+
+  The charger and the load are external, the FETs only connect them.
+  Every check reads only what the phase needs: BatteryStatus() in CHARGE and DISCHARGE,
+  GaugingStatus() in the relax phases and the Update Status once at the end of the relax.
+  At DONE and FAILED the FETs are returned to the firmware control, see fetControl().
+
+  The device parameters should be written by learningCycleInit() before learningCycleBegin().
+
+  @see https://www.linkedin.com/pulse/gas-gauging-device-bq28z610-learning-cycle-practical-guide-oleksii-ngk8f
+*/
+class LearningCycle {
+  public:
+    static const byte IDLE = 0;
+    static const byte CHARGE = 1;
+    static const byte RELAX_CHARGED = 2;
+    static const byte DISCHARGE = 3;
+    static const byte RELAX_DISCHARGED = 4;
+    static const byte DONE = 5;
+    static const byte FAILED = 6;
+
+    static const unsigned long DEFAULT_CHECK_PERIOD_MS = 10000;  ///< period of the device checks of one gauge
+    static const unsigned long MIN_RELAX_CHARGED_MS = 2UL * 3600 * 1000;  ///< 2 hours
+    static const unsigned long MIN_RELAX_DISCHARGED_MS = 5UL * 3600 * 1000;  ///< 5 hours
+    static const unsigned long PHASE_TIMEOUT_MS = 12UL * 3600 * 1000;  ///< the longest phase, FAILED after it
+    static const byte MAX_CHARGES = 3;  ///< FAILED if the table is not updated after this number of the full charges
+};
+
+struct LearningCycleState;
+
+/**
+  @brief Receiver of the phase change, e.g. for logging; the gauge of the cycle is selected.
+*/
+typedef void (*LearningCyclePhaseFn)(LearningCycleState *cycle, byte previous);
+
+/**
+  @brief State of the Learning Cycle of a single gauge, see LearningCycle.
+
+  Several gauges are cycled in parallel by the separate states, every tick checks only the gauges which are due.
+*/
+struct LearningCycleState {
+  Gauge *gauge;
+  byte phase;  ///< LearningCycle::IDLE ... LearningCycle::FAILED
+  byte charges;  ///< number of the full charges
+  byte updateStatus;  ///< Gas Gauging Update Status read at the end of the last relax
+  unsigned long phaseStartMs;  ///< millis() of the phase start
+  unsigned long lastCheckMs;  ///< millis() of the last check
+  unsigned long checkPeriodMs;
+  LearningCyclePhaseFn onPhase;  ///< NULL = none
+};
+
+/**
+  @brief Start the cycle of the gauge from the CHARGE phase.
+
+  @param onPhase - receiver of the phase changes, NULL = none
+*/
+void learningCycleBegin(LearningCycleState *cycle, Gauge *gauge,
+                        unsigned long checkPeriodMs = LearningCycle::DEFAULT_CHECK_PERIOD_MS,
+                        LearningCyclePhaseFn onPhase = NULL);
+
+/**
+  @brief Check the gauge if its period has passed and advance the phase, should be called from loop().
+
+  The gauge of the cycle is selected for the check, the previously selected gauge is restored.
+  Nothing is printed, regardless of SILENCE.
+
+  @returns the current phase
+*/
+byte learningCycleTick(LearningCycleState *cycle);
+
+/**
+  @brief Tick all the cycles, one call per loop().
+  @returns number of the cycles which are not finished yet
+*/
+byte learningCycleTick(LearningCycleState *cycles, byte count);
+
+/**
+  @brief Stop the cycle (IDLE) and return the FETs to the firmware control.
+*/
+void learningCycleAbort(LearningCycleState *cycle);
+
+/**
+  @brief Name of the phase for printing.
+*/
+PGM_P learningCyclePhaseName(byte phase);
@@ -0,0 +1,230 @@
+/**
+  @file learning_log.cpp
+
+  @brief Ring buffer of the Learning Cycle samples implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "learning_log.h"
+
+LearningSample _learningLog[LearningLog::CAPACITY];
+word _learningLogHead = 0;  ///< index of the oldest sample
+word _learningLogCount = 0;
+word _learningLogDropped = 0;
+
+unsigned long _learningLogPeriodMs = LearningLog::DEFAULT_PERIOD_MS;
+unsigned long _learningLogLastMs = 0;
+bool _learningLogIsStarted = false;
+LearningLogSpill _learningLogSpill = NULL;
+
+/**
+  @brief Start the logging.
+
+  @param periodMs - sample period, ms
+  @param spill - receiver of the samples pushed out of the full buffer, NULL = the samples are dropped
+*/
+void learningLogBegin(unsigned long periodMs, LearningLogSpill spill) {
+  _learningLogPeriodMs = periodMs;
+  _learningLogSpill = spill;
+  _learningLogIsStarted = true;
+  _learningLogLastMs = millis() - periodMs;  // the first sample is taken on the nearest tick
+}
+
+/**
+  @brief Take the sample if the period has passed, should be called from loop().
+  @returns whether the sample has been taken
+*/
+bool learningLogTick() {
+  if (!_learningLogIsStarted || millis() - _learningLogLastMs < _learningLogPeriodMs) return false;
+  _learningLogLastMs = millis();
+  return learningLogSample();
+}
+
+void _learningLogPush(const LearningSample *sample) {
+  if (_learningLogCount == LearningLog::CAPACITY) {
+    if (NULL != _learningLogSpill) _learningLogSpill(&_learningLog[_learningLogHead]);
+    else if (_learningLogDropped < 0xFFFF) _learningLogDropped++;
+
+    _learningLogHead = (_learningLogHead + 1) % LearningLog::CAPACITY;
+    _learningLogCount--;
+  }
+  _learningLog[(_learningLogHead + _learningLogCount) % LearningLog::CAPACITY] = *sample;
+  _learningLogCount++;
+}
+
+/**
+  @brief Take the sample now, nothing is printed.
+
+  Q Max of the cells, of the pack and the Update Status lie in the Data Flash one after another,
+  so they are read by a single request.
+
+  @returns false if a read failed or the device responded with invalid data, the sample is not stored in that case
+*/
+bool learningLogSample() {
+  const bool _silence = SILENCE;
+  SILENCE = true;
+
+  LearningSample sample;
+  memset(&sample, 0, sizeof(sample));
+  sample.time = millis() / 1000;
+
+  DAStatus1Data daStatus1;
+  u32 gaugingStatus = 0;
+  word current, temperature, soc;
+  byte df[DF_ADDR::GAS_GAUGING_UPDATE_STATUS - DF_ADDR::Q_MAX_CELL_1 + 1];
+  const bool isValid = DAStatus1(&daStatus1)
+                       && readRaw<CurrentRegister>(&current)
+                       && readRaw<TemperatureRegister>(&temperature)
+                       && readRaw<RelativeStateOfChargeRegister>(&soc)
+                       && rawGaugingStatus(&gaugingStatus)
+                       && dfReadBytes(DF_ADDR::Q_MAX_CELL_1, df, sizeof(df));
+  SILENCE = _silence;
+  if (!isValid) return false;
+
+  sample.cellVoltage1 = daStatus1.cellVoltage1;
+  sample.cellVoltage2 = daStatus1.cellVoltage2;
+  sample.packVoltage = daStatus1.packVoltage;
+  sample.current = (int16_t) CurrentRegister::native(current);
+  sample.temperature = temperature;
+  sample.soc = soc;
+  sample.qMaxCell1 = composeWord(df, DF_ADDR::Q_MAX_CELL_1 - DF_ADDR::Q_MAX_CELL_1);
+  sample.qMaxCell2 = composeWord(df, DF_ADDR::Q_MAX_CELL_2 - DF_ADDR::Q_MAX_CELL_1);
+  sample.qMaxPack = composeWord(df, DF_ADDR::Q_MAX_PACK - DF_ADDR::Q_MAX_CELL_1);
+  sample.gaugingStatus = gaugingStatus;
+  sample.updateStatus = df[DF_ADDR::GAS_GAUGING_UPDATE_STATUS - DF_ADDR::Q_MAX_CELL_1];
+
+  _learningLogPush(&sample);
+  return true;
+}
+
+/**
+  @brief Number of the samples in RAM.
+*/
+word learningLogCount() {
+  return _learningLogCount;
+}
+
+/**
+  @brief Number of the samples that were lost because the buffer was full and there was no spill.
+*/
+word learningLogDropped() {
+  return _learningLogDropped;
+}
+
+/**
+  @brief The sample by index, 0 = the oldest.
+*/
+bool learningLogGet(word i, LearningSample *retval) {
+  if (i >= _learningLogCount) return false;
+  *retval = _learningLog[(_learningLogHead + i) % LearningLog::CAPACITY];
+  return true;
+}
+
+/**
+  @brief Remove all the samples.
+*/
+void learningLogClear() {
+  _learningLogHead = 0;
+  _learningLogCount = 0;
+  _learningLogDropped = 0;
+}
+
+/**
+  Fields of the sample in the order of declaration.
+*/
+void _learningSampleFields(const LearningSample *sample, u32 *fields) {
+  byte i = 0;
+  fields[i++] = sample->time;
+  fields[i++] = (long) sample->cellVoltage1;
+  fields[i++] = (long) sample->cellVoltage2;
+  fields[i++] = (long) sample->packVoltage;
+  fields[i++] = (long) sample->current;
+  fields[i++] = sample->temperature;
+  fields[i++] = sample->soc;
+  fields[i++] = (long) sample->qMaxCell1;
+  fields[i++] = (long) sample->qMaxCell2;
+  fields[i++] = (long) sample->qMaxPack;
+  fields[i++] = sample->gaugingStatus;
+  fields[i++] = sample->updateStatus;
+}
+
+/**
+  Write the bytes and continue the CRC.
+*/
+void _learningLogWrite(Print &out, const byte *data, byte len, word *crc) {
+  out.write(data, len);
+  *crc = crc16(data, len, *crc);
+}
+
+/**
+  Write the signed difference as zigzag varint: 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3, ...
+*/
+void _learningLogWriteDelta(Print &out, u32 delta, word *crc) {
+  const int32_t signedDelta = (int32_t) delta;  // long is 64-bit on the LP64 hosts
+  u32 value = ((u32) signedDelta << 1) ^ (u32) (signedDelta >> 31);
+
+  byte buf[5];
+  byte len = 0;
+  do {
+    buf[len] = value & 0x7F;
+    value >>= 7;
+    if (0 != value) buf[len] |= 0x80;
+    len++;
+  } while (0 != value);
+  _learningLogWrite(out, buf, len, crc);
+}
+
+/**
+  @brief Write all the samples in the compressed format, see LearningLog.
+
+  @param clear - remove the written samples
+  @returns number of the written samples
+*/
+word learningLogFlush(Print &out, bool clear) {
+  const word count = _learningLogCount;
+  const word periodS = _learningLogPeriodMs / 1000;
+  word crc = 0xFFFF;
+
+  const byte header[LearningLog::HEADER_SIZE] = {
+    'L', 'G', LearningLog::VERSION, LearningLog::FIELDS,
+    (byte)(count & 0xFF), (byte)(count >> 8), (byte)(periodS & 0xFF), (byte)(periodS >> 8)
+  };
+  _learningLogWrite(out, header, sizeof(header), &crc);
+
+  u32 previous[LearningLog::FIELDS], fields[LearningLog::FIELDS];
+  memset(previous, 0, sizeof(previous));
+  for (word i = 0; i < count; i++) {
+    _learningSampleFields(&_learningLog[(_learningLogHead + i) % LearningLog::CAPACITY], fields);
+    for (byte f = 0; f < LearningLog::FIELDS; f++) {
+      _learningLogWriteDelta(out, fields[f] - previous[f], &crc);
+      previous[f] = fields[f];
+    }
+  }
+
+  const byte end[] = {(byte)(crc & 0xFF), (byte)(crc >> 8)};
+  out.write(end, sizeof(end));
+
+  if (clear) learningLogClear();
+  return count;
+}
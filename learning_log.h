@@ -0,0 +1,136 @@
+/**
+  @file learning_log.h
+
+  @brief Ring buffer of the Learning Cycle samples headers
+
+
+  The samples are taken in the background and flushed in bulk, delta-compressed.
+  @see learningCycleLog()
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "std_data_commands.h"
+#include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+
+/**
+  @brief Constants of the Learning Cycle log.
+
+  <pre>
+  Flushed log:
+    'L', 'G', VERSION, FIELDS, count LE (2 bytes), period in seconds LE (2 bytes)
+    samples: for every field of LearningSample in the order of declaration,
+             zigzag varint of the difference with the previous sample (with 0 for the first sample)
+    crc16() of all the bytes above, LE
+  </pre>
+*/
+class LearningLog {
+  public:
+    static const byte VERSION = 1;
+    static const byte FIELDS = 12;  ///< Number of the fields of LearningSample.
+    static const byte HEADER_SIZE = 8;
+#if defined(__AVR__)
+    static const word CAPACITY = 24;  ///< Number of the samples kept in RAM.
+#else
+    static const word CAPACITY = 512;  ///< Number of the samples kept in RAM.
+#endif
+    static const unsigned long DEFAULT_PERIOD_MS = 60000;
+};
+
+/**
+  @brief The data of learningCycleLog() in the native units of the device.
+*/
+struct __attribute__((packed)) LearningSample {
+  u32 time;  ///< seconds since the start of the controller
+  int16_t cellVoltage1;  ///< mV
+  int16_t cellVoltage2;  ///< mV
+  int16_t packVoltage;  ///< mV
+  int16_t current;  ///< mA
+  word temperature;  ///< 0.1 K
+  word soc;  ///< RelativeStateOfCharge(), %
+  int16_t qMaxCell1;  ///< mAh
+  int16_t qMaxCell2;  ///< mAh
+  int16_t qMaxPack;  ///< mAh
+  u32 gaugingStatus;
+  byte updateStatus;  ///< Gas Gauging Update Status
+};
+
+/**
+  @brief Receiver of the oldest sample when the ring buffer is full, e.g. writer to the external EEPROM or SD card.
+*/
+typedef void (*LearningLogSpill)(const LearningSample *sample);
+
+/**
+  @brief Start the logging.
+
+  @param periodMs - sample period, ms
+  @param spill - receiver of the samples pushed out of the full buffer, NULL = the samples are dropped
+*/
+void learningLogBegin(unsigned long periodMs = LearningLog::DEFAULT_PERIOD_MS, LearningLogSpill spill = NULL);
+
+/**
+  @brief Take the sample if the period has passed, should be called from loop().
+  @returns whether the sample has been taken
+*/
+bool learningLogTick();
+
+/**
+  @brief Take the sample now, nothing is printed.
+  @returns false if a read failed or the device responded with invalid data, the sample is not stored in that case
+*/
+bool learningLogSample();
+
+/**
+  @brief Number of the samples in RAM.
+*/
+word learningLogCount();
+
+/**
+  @brief Number of the samples that were lost because the buffer was full and there was no spill.
+*/
+word learningLogDropped();
+
+/**
+  @brief The sample by index, 0 = the oldest.
+*/
+bool learningLogGet(word i, LearningSample *retval);
+
+/**
+  @brief Remove all the samples.
+*/
+void learningLogClear();
+
+/**
+  @brief Write all the samples in the compressed format, see LearningLog.
+
+  @param clear - remove the written samples
+  @returns number of the written samples
+*/
+word learningLogFlush(Print &out, bool clear = true);
@@ -0,0 +1,163 @@
+/**
+  @file protection.cpp
+
+  @brief Table-driven evaluation of the protection conditions
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "protection.h"
+
+/**
+  Single condition: the bit of the status word must have the expected value.
+*/
+struct _ProtectionTerm {
+  byte result;  ///< Protection bit which requires the condition
+  byte statusWord;  ///< StatusWord
+  byte bit;  ///< Bit index of the flag, e.g. SafetyStatusFlags::OTC().n
+  bool expected;
+};
+
+/**
+  All the documented conditions, the result bit is set if all its terms match.
+*/
+const _ProtectionTerm _PROTECTION_TERMS[] PROGMEM = {
+  // 2.2 Cell Undervoltage Protection
+  {Protection::CUV_ALERT, StatusWord::SAFETY_ALERT, SafetyAlertFlags::CUV().n, true},
+  {Protection::CUV_TRIP, StatusWord::SAFETY_STATUS, SafetyStatusFlags::CUV().n, true},
+  {Protection::CUV_TRIP, StatusWord::BATTERY_STATUS, BatteryStatusFlags::FD().n, true},
+  {Protection::CUV_TRIP, StatusWord::BATTERY_STATUS, BatteryStatusFlags::TDA().n, true},
+  {Protection::CUV_TRIP, StatusWord::OPERATION_STATUS, OperationStatusFlags::XDSG().n, true},
+
+  // 2.6.2 Short Circuit in Charge Protection
+  {Protection::ASCC_ALERT, StatusWord::SAFETY_ALERT, SafetyAlertFlags::ASCC().n, true},
+  {Protection::ASCC_TRIP, StatusWord::SAFETY_STATUS, SafetyStatusFlags::ASCC().n, true},
+  {Protection::ASCC_TRIP, StatusWord::BATTERY_STATUS, BatteryStatusFlags::TCA().n, true},
+  {Protection::ASCC_TRIP, StatusWord::OPERATION_STATUS, OperationStatusFlags::XCHG().n, true},
+
+  // 2.6.3 Short Circuit in Discharge Protection
+  {Protection::ASCD_ALERT, StatusWord::SAFETY_ALERT, SafetyAlertFlags::ASCD().n, true},
+  {Protection::ASCD_TRIP, StatusWord::SAFETY_STATUS, SafetyStatusFlags::ASCD().n, true},
+  {Protection::ASCD_TRIP, StatusWord::OPERATION_STATUS, OperationStatusFlags::XDSG().n, true},
+
+  // 2.8 Overtemperature in Charge Protection
+  {Protection::OTC_ALERT, StatusWord::SAFETY_ALERT, SafetyAlertFlags::OTC().n, true},
+  {Protection::OTC_TRIP, StatusWord::SAFETY_ALERT, SafetyAlertFlags::OTC().n, false},
+  {Protection::OTC_TRIP, StatusWord::SAFETY_STATUS, SafetyStatusFlags::OTC().n, true},
+  {Protection::OTC_TRIP, StatusWord::BATTERY_STATUS, BatteryStatusFlags::OTA().n, true},
+  {Protection::OTC_TRIP, StatusWord::BATTERY_STATUS, BatteryStatusFlags::TCA().n, false},
+  {Protection::OTC_TRIP, StatusWord::OPERATION_STATUS, OperationStatusFlags::XCHG().n, true},
+
+  // Chapter 3 Permanent Fail
+  {Protection::PF, StatusWord::OPERATION_STATUS, OperationStatusFlags::PF().n, true},
+  {Protection::PF, StatusWord::BATTERY_STATUS, BatteryStatusFlags::TCA().n, true},
+  {Protection::PF, StatusWord::BATTERY_STATUS, BatteryStatusFlags::TDA().n, true},
+};
+
+const char _PROTECTION_NAMES[] PROGMEM = "CUV_ALERT\0CUV_TRIP\0ASCC_ALERT\0ASCC_TRIP\0ASCD_ALERT\0ASCD_TRIP\0OTC_ALERT\0OTC_TRIP\0PF";
+
+u32 _protectionWord(const ProtectionStatus *status, byte statusWord) {
+  switch (statusWord) {
+    case StatusWord::SAFETY_ALERT: return status->safetyAlert;
+    case StatusWord::SAFETY_STATUS: return status->safetyStatus;
+    case StatusWord::OPERATION_STATUS: return status->operationStatus;
+    case StatusWord::BATTERY_STATUS: return status->batteryStatus;
+  }
+  return 0;
+}
+
+/**
+  @brief Read all the status words of the protections: 3 MAC transactions and 1 standard command, no printing.
+  @returns false if the device responded with invalid data or BatteryStatus was not read completely
+*/
+bool readProtectionStatus(ProtectionStatus *status) {
+  if (!rawSafetyAlert(&status->safetyAlert)) return false;  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
+  if (!rawSafetyStatus(&status->safetyStatus)) return false;  // 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
+  if (!rawOperationStatus(&status->operationStatus)) return false;  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
+  if (!rawBatteryStatus(&status->batteryStatus)) return false;  // 12.1.6 0x0A/0B BatteryStatus()
+  status->timestamp = millis();
+  return true;
+}
+
+/**
+  @brief Match all the conditions of the table against the status words, no bus access.
+  @returns bitmap of the met conditions, see Protection
+*/
+word evaluateProtections(const ProtectionStatus *status) {
+  word retval = (1 << Protection::COUNT) - 1;  // every condition is met until a term does not match
+
+  const byte count = sizeof(_PROTECTION_TERMS) / sizeof(_PROTECTION_TERMS[0]);
+  for (byte i = 0; i < count; i++) {
+    const _ProtectionTerm *term = &_PROTECTION_TERMS[i];
+    const byte result = pgm_read_byte(&term->result);
+    if (!bitRead(retval, result)) continue;  // already failed
+
+    const bool value = bitRead(_protectionWord(status, pgm_read_byte(&term->statusWord)), pgm_read_byte(&term->bit));
+    if (value != (bool) pgm_read_byte(&term->expected)) bitClear(retval, result);
+  }
+  return retval;
+}
+
+/**
+  @brief Read the status words and evaluate the protections.
+
+  @param result - bitmap of the met conditions, see Protection
+  @param status - receives the status words, can be NULL
+  @returns false if the device responded with invalid data, the result is not changed then
+*/
+bool protectionCheck(word *result, ProtectionStatus *status) {
+  ProtectionStatus _status;
+  if (NULL == status) status = &_status;
+
+  if (!readProtectionStatus(status)) return false;
+  *result = evaluateProtections(status);
+  return true;
+}
+
+/**
+  @brief Sampler reader: the bitmap of protectionCheck().
+  @see samplerAdd()
+*/
+bool sampleProtections(u32 *value) {
+  word result = 0;
+  if (!protectionCheck(&result)) return false;
+  *value = result;
+  return true;
+}
+
+/**
+  @brief Print the names of the met conditions: "Protections: CUV_ALERT OTC_TRIP"
+*/
+void printProtections(word result) {
+  PGM_PRINT("Protections:");
+  PGM_P name = _PROTECTION_NAMES;
+  for (byte i = 0; i < Protection::COUNT; i++) {
+    if (bitRead(result, i)) {
+      Serial.print(' ');
+      printPgm(name);
+    }
+    name += strlen_P(name) + 1;
+  }
+  if (0 == result) PGM_PRINT(" none");
+  Serial.println();
+}
@@ -0,0 +1,101 @@
+/**
+  @file protection.h
+
+  @brief Table-driven evaluation of the protection conditions
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "flags.h"
+#include "utils.h"
+#include "std_data_commands.h"
+#include "alt_manufacturer_access.h"
+#include "status_watcher.h"
+
+/**
+  @brief Bits of the result of evaluateProtections().
+
+  ALERT - the protection is pending, TRIP - all the documented trip conditions are met.
+  Recovery is the transition of the TRIP bit from 1 to 0.
+*/
+class Protection {
+  public:
+    static const byte CUV_ALERT = 0;  ///< 2.2 Cell Undervoltage: SafetyAlert()[CUV] = 1
+    static const byte CUV_TRIP = 1;  ///< 2.2 SafetyStatus()[CUV] = 1, BatteryStatus()[FD] = 1, [TDA] = 1, OperationStatus()[XDSG] = 1
+    static const byte ASCC_ALERT = 2;  ///< 2.6.2 Short Circuit in Charge: SafetyAlert()[ASCC] = 1
+    static const byte ASCC_TRIP = 3;  ///< 2.6.2 SafetyStatus()[ASCC] = 1, BatteryStatus()[TCA] = 1, OperationStatus()[XCHG] = 1
+    static const byte ASCD_ALERT = 4;  ///< 2.6.3 Short Circuit in Discharge: SafetyAlert()[ASCD] = 1
+    static const byte ASCD_TRIP = 5;  ///< 2.6.3 SafetyStatus()[ASCD] = 1, OperationStatus()[XDSG] = 1
+    static const byte OTC_ALERT = 6;  ///< 2.8 Overtemperature in Charge: SafetyAlert()[OTC] = 1
+    static const byte OTC_TRIP = 7;  ///< 2.8 SafetyAlert()[OTC] = 0, SafetyStatus()[OTC] = 1, BatteryStatus()[OTA] = 1, [TCA] = 0, OperationStatus()[XCHG] = 1
+    static const byte PF = 8;  ///< 3 Permanent Fail: OperationStatus()[PF] = 1, BatteryStatus()[TCA] = 1, [TDA] = 1
+    static const byte COUNT = 9;
+};
+
+/**
+  @brief Status words required by all the protection conditions, each is read once per cycle.
+*/
+struct ProtectionStatus {
+  u32 safetyAlert;  ///< 12.2.26 0x0050 SafetyAlert
+  u32 safetyStatus;  ///< 12.2.27 0x0051 SafetyStatus
+  u32 operationStatus;  ///< 12.2.30 0x0054 OperationStatus
+  word batteryStatus;  ///< 12.1.6 0x0A/0B BatteryStatus
+  unsigned long timestamp;  ///< millis() of the read
+};
+
+/**
+  @brief Read all the status words of the protections: 3 MAC transactions and 1 standard command, no printing.
+  @returns false if the device responded with invalid data or BatteryStatus was not read completely
+*/
+bool readProtectionStatus(ProtectionStatus *status);
+
+/**
+  @brief Match all the conditions of the table against the status words, no bus access.
+  @returns bitmap of the met conditions, see Protection
+*/
+word evaluateProtections(const ProtectionStatus *status);
+
+/**
+  @brief Read the status words and evaluate the protections.
+
+  @param result - bitmap of the met conditions, see Protection
+  @param status - receives the status words, can be NULL
+  @returns false if the device responded with invalid data, the result is not changed then
+*/
+bool protectionCheck(word *result, ProtectionStatus *status = NULL);
+
+/**
+  @brief Sampler reader: the bitmap of protectionCheck().
+  @see samplerAdd()
+*/
+bool sampleProtections(u32 *value);
+
+/**
+  @brief Print the names of the met conditions: "Protections: CUV_ALERT OTC_TRIP"
+*/
+void printProtections(word result);
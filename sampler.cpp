@@ -0,0 +1,259 @@
+/**
+  @file sampler.cpp
+
+  @brief Cooperative telemetry sampler implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "sampler.h"
+
+/**
+  Sampled register.
+*/
+struct _SamplerTask {
+  SamplerReadFn read;
+  SamplerCallback callback;
+  unsigned long periodMs;
+  unsigned long lastMs;  ///< millis() of the last sample
+  u32 value;
+  bool isValid;  ///< whether the value was obtained at least once
+  bool isDue;  ///< the first sample has not been taken yet
+};
+
+_SamplerTask _samplerTasks[Sampler::MAX_TASKS];
+byte _samplerCount = 0;
+byte _samplerNext = 0;  ///< the task from which the next tick starts
+
+/**
+  @brief Register the value to be sampled every periodMs.
+
+  The first sample is taken on the nearest samplerTick().
+
+  @param read - reader of the value, e.g. sampleCurrent()
+  @param periodMs - sample period, ms
+  @param callback - is called with every new value, can be NULL
+  @returns the task identifier, or -1 if there is no free slot
+
+  @see Sampler::MAX_TASKS
+*/
+int samplerAdd(SamplerReadFn read, unsigned long periodMs, SamplerCallback callback) {
+  if (_samplerCount >= Sampler::MAX_TASKS || NULL == read) return -1;
+
+  _SamplerTask *task = &_samplerTasks[_samplerCount];
+  memset(task, 0, sizeof(_SamplerTask));
+  task->read = read;
+  task->callback = callback;
+  task->periodMs = periodMs;
+  task->isDue = true;
+
+  return _samplerCount++;
+}
+
+/**
+  @brief Change the sample period of the task.
+*/
+void samplerSetPeriod(byte id, unsigned long periodMs) {
+  if (id < _samplerCount) _samplerTasks[id].periodMs = periodMs;
+}
+
+/**
+  @brief Sample period of the task, 0 if there is no such task.
+*/
+unsigned long samplerPeriod(byte id) {
+  return id < _samplerCount ? _samplerTasks[id].periodMs : 0;
+}
+
+/**
+  @brief Number of the registered tasks.
+*/
+byte samplerCount() {
+  return _samplerCount;
+}
+
+/**
+  @brief Remove all the tasks.
+*/
+void samplerClear() {
+  _samplerCount = 0;
+  _samplerNext = 0;
+}
+
+/**
+  @brief The last sampled value of the task.
+  @returns false if the value was not obtained yet
+*/
+bool samplerValue(byte id, u32 *retval) {
+  if (id >= _samplerCount || !_samplerTasks[id].isValid) return false;
+  *retval = _samplerTasks[id].value;
+  return true;
+}
+
+/**
+  @brief Time of the last sample of the task, millis().
+*/
+unsigned long samplerTimestamp(byte id) {
+  return id < _samplerCount ? _samplerTasks[id].lastMs : 0;
+}
+
+/**
+  Store the new value of the task and notify the callback.
+*/
+void _samplerStore(byte id, u32 value) {
+  _SamplerTask *task = &_samplerTasks[id];
+  task->value = value;
+  task->isValid = true;
+  if (NULL != task->callback) task->callback(id, value);
+}
+
+/**
+  @brief Perform the due reads.
+
+  Should be called from loop() as often as possible.
+
+  The tasks are checked starting from the one following the last served task,
+  so the fast tasks cannot starve the slow ones.
+  Tasks with the same reader due at the same tick share a single read.
+
+  @param maxReads - limit of the bus reads per call
+  @returns number of the bus reads performed
+*/
+byte samplerTick(byte maxReads) {
+  if (0 == _samplerCount) return 0;
+
+  const unsigned long now = millis();
+  byte reads = 0;
+
+  for (byte n = 0; n < _samplerCount && reads < maxReads; n++) {
+    const byte id = (_samplerNext + n) % _samplerCount;
+    _SamplerTask *task = &_samplerTasks[id];
+    if (!task->isDue && now - task->lastMs < task->periodMs) continue;
+
+    u32 value = 0;
+    const bool isRead = task->read(&value);
+    reads++;
+
+    // the read failure is retried after the period, so a dead bus does not take the whole loop
+    task->lastMs = now;
+    task->isDue = false;
+    _samplerNext = (id + 1) % _samplerCount;
+    if (!isRead) continue;
+
+    _samplerStore(id, value);
+
+    // coalesce the other due tasks with the same reader
+    for (byte other = 0; other < _samplerCount; other++) {
+      _SamplerTask *otherTask = &_samplerTasks[other];
+      if (other == id || otherTask->read != task->read) continue;
+      if (!otherTask->isDue && now - otherTask->lastMs < otherTask->periodMs) continue;
+
+      otherTask->lastMs = now;
+      otherTask->isDue = false;
+      _samplerStore(other, value);
+    }
+  }
+
+  return reads;
+}
+
+bool sampleVoltage(u32 *retval) {
+  return sampleRegister<VoltageRegister>(retval);
+}
+
+bool sampleCurrent(u32 *retval) {
+  return sampleRegister<CurrentRegister>(retval);
+}
+
+bool sampleAverageCurrent(u32 *retval) {
+  return sampleRegister<AverageCurrentRegister>(retval);
+}
+
+bool sampleTemperature(u32 *retval) {
+  return sampleRegister<TemperatureRegister>(retval);
+}
+
+bool sampleRelativeStateOfCharge(u32 *retval) {
+  return sampleRegister<RelativeStateOfChargeRegister>(retval);
+}
+
+bool sampleRemainingCapacity(u32 *retval) {
+  return sampleRegister<RemainingCapacityRegister>(retval);
+}
+
+bool sampleBatteryStatus(u32 *retval) {
+  return sampleRegister<BatteryStatusRegister>(retval);
+}
+
+bool sampleOperationStatus(u32 *retval) {
+  return rawOperationStatus(retval);
+}
+
+bool sampleSafetyStatus(u32 *retval) {
+  return rawSafetyStatus(retval);
+}
+
+bool sampleGaugingStatus(u32 *retval) {
+  return rawGaugingStatus(retval);
+}
+
+bool sampleCellVoltage1(u32 *retval) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, Sampler::COALESCE_MS)) return false;
+  *retval = (word) daStatus1.cellVoltage1;
+  return true;
+}
+
+bool sampleCellVoltage2(u32 *retval) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, Sampler::COALESCE_MS)) return false;
+  *retval = (word) daStatus1.cellVoltage2;
+  return true;
+}
+
+bool sampleDod0PassedQ(u32 *retval) {
+  ITStatus2Data itStatus2;
+  if (!ITStatus2(&itStatus2, Sampler::COALESCE_MS)) return false;
+  *retval = (long) itStatus2.dod0PassedQ;
+  return true;
+}
+
+bool sampleQMax1(u32 *retval) {
+  ITStatus3Data itStatus3;
+  if (!ITStatus3(&itStatus3, Sampler::COALESCE_MS)) return false;
+  *retval = (word) itStatus3.qMax1;
+  return true;
+}
+
+bool sampleQMax2(u32 *retval) {
+  ITStatus3Data itStatus3;
+  if (!ITStatus3(&itStatus3, Sampler::COALESCE_MS)) return false;
+  *retval = (word) itStatus3.qMax2;
+  return true;
+}
+
+bool sampleCycleCount(u32 *retval) {
+  byte buf[2] = {0, 0};
+  if (!rawDfReadBytes(DF_ADDR::GAS_GAUGING_CYCLE_COUNT, buf, sizeof(buf))) return false;
+  *retval = (buf[1] << 8) | buf[0];
+  return true;
+}
@@ -0,0 +1,165 @@
+/**
+  @file sampler.h
+
+  @brief Cooperative telemetry sampler headers
+
+
+  Each register has its own sample period. samplerTick() is called from loop(),
+  performs the reads that are due and never waits with delay().
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "std_data_commands.h"
+#include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+
+/**
+  @brief Reader of a sampled value in the native units of the device.
+
+  Signed values are sign-extended into u32, cast the result back: (int) value.
+
+  @returns whether the value was obtained
+*/
+typedef bool (*SamplerReadFn)(u32 *retval);
+
+/**
+  @brief Receiver of a new sampled value.
+  @param id - the task identifier returned by samplerAdd()
+*/
+typedef void (*SamplerCallback)(byte id, u32 value);
+
+/**
+  @brief Sampler constants
+*/
+class Sampler {
+  public:
+    static const byte MAX_TASKS = 12;  ///< Maximum number of the registered tasks.
+    static const byte MAX_READS_PER_TICK = 2;  ///< Default limit of the reads performed by a single samplerTick().
+    /**
+      The MAC blocks read by one tick are reused by the other tasks of the same tick, ms.
+      @see DAStatus1(DAStatus1Data*, unsigned long)
+    */
+    static const byte COALESCE_MS = 50;
+};
+
+/**
+  @brief Register the value to be sampled every periodMs.
+
+  The first sample is taken on the nearest samplerTick().
+
+  @param read - reader of the value, e.g. sampleCurrent()
+  @param periodMs - sample period, ms
+  @param callback - is called with every new value, can be NULL
+  @returns the task identifier, or -1 if there is no free slot
+
+  @see Sampler::MAX_TASKS
+*/
+int samplerAdd(SamplerReadFn read, unsigned long periodMs, SamplerCallback callback = NULL);
+
+/**
+  @brief Change the sample period of the task.
+*/
+void samplerSetPeriod(byte id, unsigned long periodMs);
+
+/**
+  @brief Sample period of the task, 0 if there is no such task.
+*/
+unsigned long samplerPeriod(byte id);
+
+/**
+  @brief Number of the registered tasks.
+*/
+byte samplerCount();
+
+/**
+  @brief Remove all the tasks.
+*/
+void samplerClear();
+
+/**
+  @brief The last sampled value of the task.
+  @returns false if the value was not obtained yet
+*/
+bool samplerValue(byte id, u32 *retval);
+
+/**
+  @brief Time of the last sample of the task, millis().
+*/
+unsigned long samplerTimestamp(byte id);
+
+/**
+  @brief Perform the due reads.
+
+  Should be called from loop() as often as possible.
+
+  The tasks are checked starting from the one following the last served task,
+  so the fast tasks cannot starve the slow ones.
+  Tasks with the same reader due at the same tick share a single read.
+
+  @param maxReads - limit of the bus reads per call
+  @returns number of the bus reads performed
+*/
+byte samplerTick(byte maxReads = Sampler::MAX_READS_PER_TICK);
+
+/**
+  @brief Reader of any standard register for samplerAdd(), e.g. sampleRegister<FullChargeCapacityRegister>.
+
+  The value is native, sign-extended if the register is signed.
+
+  @returns false if the register was not read
+  @see std_registers.h
+*/
+template <class Reg>
+bool sampleRegister(u32 *retval) {
+  word raw;
+  if (!readRaw<Reg>(&raw)) return false;
+  *retval = Reg::native(raw);
+  return true;
+}
+
+/*
+  Ready readers for samplerAdd().
+*/
+
+bool sampleVoltage(u32 *retval);  ///< 12.1.5 0x08/09 Voltage(), mV
+bool sampleCurrent(u32 *retval);  ///< 12.1.7 0x0C/0D Current(), mA (signed)
+bool sampleAverageCurrent(u32 *retval);  ///< 12.1.11 0x14/15 AverageCurrent(), mA (signed)
+bool sampleTemperature(u32 *retval);  ///< 12.1.4 0x06/07 Temperature(), 0.1 K
+bool sampleRelativeStateOfCharge(u32 *retval);  ///< 12.1.23 0x2C/2D RelativeStateOfCharge(), %
+bool sampleRemainingCapacity(u32 *retval);  ///< 12.1.9 0x10/11 RemainingCapacity(), mAh
+bool sampleBatteryStatus(u32 *retval);  ///< 12.1.6 0x0A/0B BatteryStatus()
+bool sampleOperationStatus(u32 *retval);  ///< 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
+bool sampleSafetyStatus(u32 *retval);  ///< 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
+bool sampleGaugingStatus(u32 *retval);  ///< 12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus
+bool sampleCellVoltage1(u32 *retval);  ///< 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1: Cell Voltage 1, mV
+bool sampleCellVoltage2(u32 *retval);  ///< 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1: Cell Voltage 2, mV
+bool sampleDod0PassedQ(u32 *retval);  ///< 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2: DOD0 Passed Q (signed)
+bool sampleQMax1(u32 *retval);  ///< 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3: QMax 1, mAh
+bool sampleQMax2(u32 *retval);  ///< 12.2.41 AltManufacturerAccess() 0x0075 ITStatus3: QMax 2, mAh
+bool sampleCycleCount(u32 *retval);  ///< Gas Gauging; State; 0x4240; Cycle Count; U2 from the Data Flash
@@ -44,28 +44,99 @@
     0, 1 = Full Access - doesn't work correct! It's (0, 0) in fact
     1, 0 = Unsealed
     1, 1 = Sealed
-*/
-int securityMode() {
-  const bool _silence = SILENCE;
-  if (!DEBUG) SILENCE = true;
-
-  const u32 operationStatus = OperationStatus();
 
-  SILENCE = _silence;
+  The result is stored into the security mode cache.
 
-  if (DEBUG) printLongSplitBin(operationStatus);
+  @see getSecurityModeCache()
+*/
+int securityMode() {
+  const int retval = rawSecurityMode();
 
-  const byte retval = (operationStatus >> OperationStatusFlags::SEC0().n) & 0b11;
   if (!SILENCE) {
     PGM_PRINT("=== Security mode: ");
     if (SecurityMode::SEALED == retval) PGM_PRINTLN("Sealed");
     else if (SecurityMode::UNSEALED == retval) PGM_PRINTLN("Unsealed");
     else if (SecurityMode::FULL_ACCESS == retval) PGM_PRINTLN("Full Access");
+    else if (SecurityMode::UNKNOWN == retval) printInvalidData();
     else PGM_PRINTLN("Reserved");
   }
   return retval;
 }
 
+/**
+  @brief Request current security mode of the device without printing.
+
+  The result is stored into the security mode cache.
+
+  @returns SecurityMode::UNKNOWN if the device responded with invalid data.
+
+  @see securityMode()
+  @see rawOperationStatus()
+*/
+int rawSecurityMode() {
+  u32 operationStatus = 0;
+  if (!rawOperationStatus(&operationStatus)) return SecurityMode::UNKNOWN;
+
+  const byte retval = (operationStatus >> OperationStatusFlags::SEC0().n) & 0b11;
+  setSecurityModeCache(retval);
+  return retval;
+}
+
+/**
+  @brief Security mode of the device known for the current session.
+
+  The device is requested only if the mode is not known yet or the cache was invalidated.
+
+  @see securityMode()
+  @see invalidateSecurityModeCache()
+*/
+int cachedSecurityMode() {
+  const byte retval = getSecurityModeCache();
+  if (SecurityMode::UNKNOWN != retval) return retval;
+  return rawSecurityMode();
+}
+
+/**
+  Send both words of the security key to AltManufacturerAccess().
+*/
+void _sendSecurityKey(u32 key) {
+  if (DEBUG) {
+    PGM_PRINT("== Security key: ");
+    printLongHex(key);
+    Serial.println();
+  }
+
+  INSTRUMENT_SECURITY_KEY();
+  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, key & 0xFFFF);
+  DRIVER_DELAY(5);
+  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, (key >> 16) & 0xFFFF);
+  invalidateSecurityModeCache();  // the key may be wrong, so the result is not known until requested
+}
+
+/**
+  Poll OperationStatus()[SEC1, SEC0] with the growing delay until the mode is not lower than the target
+  or DeviceSecurity::TRANSITION_TIMEOUT_MS has passed.
+
+  SecurityMode values grow from FULL_ACCESS to SEALED, so "not lower" is the numerically not greater value;
+  SecurityMode::RESERVED is not a valid mode and is never accepted.
+
+  @returns whether the target mode is reached
+*/
+bool _waitSecurityMode(byte target) {
+  const unsigned long start = millis();
+  word pollMs = DeviceSecurity::TRANSITION_POLL_MS;
+
+  while (true) {
+    DRIVER_DELAY(pollMs);
+
+    const int mode = rawSecurityMode();
+    if (SecurityMode::UNKNOWN != mode && SecurityMode::RESERVED != mode && mode <= target) return true;
+    if (millis() - start >= DeviceSecurity::TRANSITION_TIMEOUT_MS) return false;
+
+    if (pollMs < DeviceSecurity::TRANSITION_MAX_POLL_MS) pollMs <<= 1;
+  }
+}
+
 /**
   @brief 9.5.2 SEALED to UNSEALED
 
@@ -77,24 +148,23 @@ int securityMode() {
   in FULL ACCESS mode. To return to the SEALED mode, either a hardware reset is needed,
   or the MAC SealDevice() command is needed to transit from FULL ACCESS or UNSEALED to SEALED.
 
+  The transition is verified by polling of OperationStatus() instead of the fixed delay,
+  the cached security mode holds the result.
+
+  @returns whether the device became UNSEALED or FULL ACCESS within DeviceSecurity::TRANSITION_TIMEOUT_MS
+
   @see SealDevice()
   @see securityMode()
   @see DeviceSecurity::DEFAULT_UNSEAL_KEY
 */
-void unsealDevice(u32 key) {
+bool unsealDevice(u32 key) {
   if (!SILENCE) PGM_PRINTLN("=== unsealDevice");
 
-  if (DEBUG) {
-    PGM_PRINT("== Unseal key: ");
-    printLongHex(key);
-    Serial.println();
-  }
-
-  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, key & 0xFFFF);
-  delay(5);
-  sendCommand(StdCommands::ALT_MANUFACTURER_ACCESS, (key >> 16) & 0xFFFF);
+  _sendSecurityKey(key);
+  const bool retval = _waitSecurityMode(SecurityMode::UNSEALED);
 
-  delay(1000); // long delay is necessary
+  if (!retval && !SILENCE) PGM_PRINTLN("[!] The device is still SEALED.");
+  return retval;
 }
 
 /**
@@ -107,13 +177,23 @@ void unsealDevice(u32 key) {
   word of the Full Access Key to AltManufacturerAccess(), followed by the second word of the Full Access Key to
   AltManufacturerAccess(). In FULL ACCESS mode, the command to go to boot ROM can be sent.
 
+  The transition is verified by polling of OperationStatus() instead of the fixed delay,
+  the cached security mode holds the result.
+
+  @returns whether the device became FULL ACCESS within DeviceSecurity::TRANSITION_TIMEOUT_MS
+
   @see DeviceSecurity::DEFAULT_FULL_ACCESS_KEY
   @see SealDevice()
   @see securityMode()
 */
-void fullAccessDevice(u32 key) {
+bool fullAccessDevice(u32 key) {
   if (!SILENCE) PGM_PRINTLN("=== fullAccessDevice");
-  unsealDevice(key);
+
+  _sendSecurityKey(key);
+  const bool retval = _waitSecurityMode(SecurityMode::FULL_ACCESS);
+
+  if (!retval && !SILENCE) PGM_PRINTLN("[!] The device is not in FULL ACCESS mode.");
+  return retval;
 }
 
 /**
@@ -131,10 +211,10 @@ void manufactoryChargeFet(bool mode) {
 
   if (chg == mode) return;  // only toggle in proper state
 
-  const int _securityMode = securityMode();
-  if (SecurityMode::SEALED == _securityMode) {
+  // the cached mode is enough: the unsealed device stays unsealed until it is sealed by the driver or reset
+  if (SecurityMode::SEALED == cachedSecurityMode()) {
     // should remain unsealed
-    unsealDevice();  // 9.5.2 SEALED to UNSEALED
+    if (!unsealDevice()) return;  // 9.5.2 SEALED to UNSEALED
   }
 
   // only toggle in proper state
@@ -157,10 +237,10 @@ void manufactoryDischargeFet(bool mode) {
 
   if (dsg == mode) return;  // only toggle in proper state
 
-  const int _securityMode = securityMode();
-  if (SecurityMode::SEALED == _securityMode) {
+  // the cached mode is enough: the unsealed device stays unsealed until it is sealed by the driver or reset
+  if (SecurityMode::SEALED == cachedSecurityMode()) {
     // should remain unsealed
-    unsealDevice();  // 9.5.2 SEALED to UNSEALED
+    if (!unsealDevice()) return;  // 9.5.2 SEALED to UNSEALED
   }
 
   DischargeFET();  // 12.2.14 AltManufacturerAccess() 0x0020 DSG FET
@@ -177,8 +257,8 @@ void fetControl(bool mode) {
 
   if (fetEn == mode) return;  // only toggle in proper state
 
-  const int _securityMode = securityMode();
-  if (SecurityMode::SEALED == _securityMode) unsealDevice();  // 9.5.2 SEALED to UNSEALED
+  const int _securityMode = cachedSecurityMode();
+  if (SecurityMode::SEALED == _securityMode && !unsealDevice()) return;  // 9.5.2 SEALED to UNSEALED
 
   FETControl();  // 12.2.16 AltManufacturerAccess() 0x0022 FET Control
 
@@ -195,14 +275,7 @@ void fetControl(bool mode) {
   @see BatteryStatusFlags
 */
 bool isPermanentFail() {
-  const bool _silence = SILENCE;
-  SILENCE = true;
-  const u32 operationStatus = OperationStatus();  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
-  const word batteryStatus = BatteryStatus();
-  const bool retval = bitRead(operationStatus, OperationStatusFlags::PF().n)
-                      && bitRead(batteryStatus, BatteryStatusFlags::TCA().n)
-                      && bitRead(batteryStatus, BatteryStatusFlags::TDA().n);
-  SILENCE = _silence;
+  const bool retval = rawIsPermanentFail();
   if (!SILENCE) {
     if (retval) PGM_PRINTLN("\nThe device is in Permanent Fail!");
     else PGM_PRINTLN("\nPermanent Fail: Not detected");
@@ -211,142 +284,151 @@ bool isPermanentFail() {
 }
 
 /**
-  @see DAStatus1()
-  @see DA_STATUS_1
+  @brief Chapter 3: Permanent Fail, no printing.
+  @see isPermanentFail()
 */
-float cellVoltage1() {
-  const bool _silence = SILENCE;
-  SILENCE = true;
+bool rawIsPermanentFail() {
+  u32 operationStatus = 0;
+  if (!rawOperationStatus(&operationStatus)) return false;  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
+
+  const word batteryStatus = rawBatteryStatus();
+  return bitRead(operationStatus, OperationStatusFlags::PF().n)
+         && bitRead(batteryStatus, BatteryStatusFlags::TCA().n)
+         && bitRead(batteryStatus, BatteryStatusFlags::TDA().n);
+}
 
-  byte daStatus1[BlockProtocol::MAX];
-  DAStatus1(daStatus1);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
+/**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
 
-  SILENCE = _silence;
+  @see DAStatus1()
+  @see DA_STATUS_1
+*/
+Measurement cellVoltage1(unsigned long maxAge) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, maxAge)) return 0;  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
 
-  const int cellVoltage1 = composeWord(daStatus1, DA_STATUS_1::CELL_VOLTAGE_1);
-  const float retval = PERMIL * cellVoltage1;
+  const Measurement retval = MEASURE_MILLIS(daStatus1.cellVoltage1);
 
-  if (!SILENCE) printFloat(PSTR("Cell Voltage 1"), retval, PERMIL_DECIMAL, Units::V());
+  if (!SILENCE) printMeasurement(PSTR("Cell Voltage 1"), retval, Units::V());
   return retval;
 }
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float cellVoltage2() {
-  const bool _silence = SILENCE;
-  SILENCE = true;
+Measurement cellVoltage2(unsigned long maxAge) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, maxAge)) return 0;  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
 
-  byte daStatus1[BlockProtocol::MAX];
-  DAStatus1(daStatus1);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
+  const Measurement retval = MEASURE_MILLIS(daStatus1.cellVoltage2);
 
-  SILENCE = _silence;
-
-  const int cellVoltage2 = composeWord(daStatus1, DA_STATUS_1::CELL_VOLTAGE_2);
-  const float retval = PERMIL * cellVoltage2;
-
-  if (!SILENCE) printFloat(PSTR("Cell Voltage 2"), retval, PERMIL_DECIMAL, Units::V());
+  if (!SILENCE) printMeasurement(PSTR("Cell Voltage 2"), retval, Units::V());
   return retval;
 }
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float batVoltage() {
-  const bool _silence = SILENCE;
-  SILENCE = true;
-
-  byte daStatus1[BlockProtocol::MAX];
-  DAStatus1(daStatus1);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
-
-  SILENCE = _silence;
+Measurement batVoltage(unsigned long maxAge) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, maxAge)) return 0;  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
 
-  const int batVoltage = composeWord(daStatus1, DA_STATUS_1::BAT_VOLTAGE);
-  const float retval = PERMIL * batVoltage;
+  const Measurement retval = MEASURE_MILLIS(daStatus1.batVoltage);
 
-  if (!SILENCE) printFloat(PSTR("BAT Voltage"), retval, PERMIL_DECIMAL, Units::V());
+  if (!SILENCE) printMeasurement(PSTR("BAT Voltage"), retval, Units::V());
   return retval;
 }
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float packVoltage() {
-  const bool _silence = SILENCE;
-  SILENCE = true;
+Measurement packVoltage(unsigned long maxAge) {
+  DAStatus1Data daStatus1;
+  if (!DAStatus1(&daStatus1, maxAge)) return 0;  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
 
-  byte daStatus1[BlockProtocol::MAX];
-  DAStatus1(daStatus1);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
+  const Measurement retval = MEASURE_MILLIS(daStatus1.packVoltage);
 
-  SILENCE = _silence;
+  if (!SILENCE) printMeasurement(PSTR("PACK Voltage"), retval, Units::V());
+  return retval;
+}
 
-  const int packVoltage = composeWord(daStatus1, DA_STATUS_1::PACK_VOLTAGE);
-  const float retval = PERMIL * packVoltage;
+/**
+  @brief The status words passed by the caller, or read from the device into the buffer.
+  @returns NULL if the device responded with invalid data
+*/
+const ProtectionStatus *_useProtectionStatus(const ProtectionStatus *status, ProtectionStatus *buf) {
+  if (NULL != status) return status;
+  if (readProtectionStatus(buf)) return buf;
 
-  if (!SILENCE) printPremil(PSTR("PACK Voltage"), retval, Units::V());
-  return retval;
+  printInvalidData();
+  return NULL;
 }
 
 /**
   @brief 2.2 Cell Undervoltage Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void CellUndervoltageProtectionCheck() {
+void CellUndervoltageProtectionCheck(const ProtectionStatus *status) {
   PGM_PRINTLN("\n=== 2.2 Cell Undervoltage Protection:");
 
-  const bool _silence = SILENCE;
-  SILENCE = true;
-  const u32 safetyAlert = SafetyAlert();  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
-  const u32 safetyStatus = SafetyStatus();  // 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
-  const word batteryStatus = BatteryStatus();  // 12.1.6 0x0A/0B BatteryStatus()
-  const u32 operationStatus = OperationStatus();  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
-  SILENCE = _silence;
+  ProtectionStatus _status;
+  status = _useProtectionStatus(status, &_status);
+  if (NULL == status) return;
 
-  printFlag(PSTR("SafetyAlert()[CUV]"), safetyAlert, SafetyAlertFlags::CUV);
-  printFlag(PSTR("SafetyStatus()[CUV]"), safetyStatus, SafetyStatusFlags::CUV);
-  printFlag(PSTR("BatteryStatus()[TDA]"), batteryStatus, BatteryStatusFlags::TDA);
-  printFlag(PSTR("BatteryStatus()[FD]"), batteryStatus, BatteryStatusFlags::FD);
-  printFlag(PSTR("BatteryStatus()[TDA]"), batteryStatus, BatteryStatusFlags::TDA);
-  printFlag(PSTR("OperationStatus()[XDSG]"), operationStatus, OperationStatusFlags::XDSG);
+  printFlag(PSTR("SafetyAlert()[CUV]"), status->safetyAlert, SafetyAlertFlags::CUV);
+  printFlag(PSTR("SafetyStatus()[CUV]"), status->safetyStatus, SafetyStatusFlags::CUV);
+  printFlag(PSTR("BatteryStatus()[TDA]"), status->batteryStatus, BatteryStatusFlags::TDA);
+  printFlag(PSTR("BatteryStatus()[FD]"), status->batteryStatus, BatteryStatusFlags::FD);
+  printFlag(PSTR("OperationStatus()[XDSG]"), status->operationStatus, OperationStatusFlags::XDSG);
 }
 
 /**
   @brief 2.6.2 Short Circuit in Charge Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void ShortCircuitInChargeProtectionCheck() {
+void ShortCircuitInChargeProtectionCheck(const ProtectionStatus *status) {
   PGM_PRINTLN("\n=== 2.6.2 Short Circuit in Charge Protection:");
 
-  const bool _silence = SILENCE;
-  SILENCE = true;
-  const u32 safetyAlert = SafetyAlert();  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
-  const u32 safetyStatus = SafetyStatus();  // 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
-  const word batteryStatus = BatteryStatus();  // 12.1.6 0x0A/0B BatteryStatus()
-  const u32 operationStatus = OperationStatus();  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
-  SILENCE = _silence;
+  ProtectionStatus _status;
+  status = _useProtectionStatus(status, &_status);
+  if (NULL == status) return;
 
-  printFlag(PSTR("SafetyAlert()[ASCC]"), safetyAlert, SafetyAlertFlags::ASCC);
-  printFlag(PSTR("SafetyStatus()[ASCC]"), safetyStatus, SafetyStatusFlags::ASCC);
-  printFlag(PSTR("BatteryStatus()[TCA]"), batteryStatus, BatteryStatusFlags::TCA);
-  printFlag(PSTR("OperationStatus()[XCHG]"), operationStatus, OperationStatusFlags::XCHG);
+  printFlag(PSTR("SafetyAlert()[ASCC]"), status->safetyAlert, SafetyAlertFlags::ASCC);
+  printFlag(PSTR("SafetyStatus()[ASCC]"), status->safetyStatus, SafetyStatusFlags::ASCC);
+  printFlag(PSTR("BatteryStatus()[TCA]"), status->batteryStatus, BatteryStatusFlags::TCA);
+  printFlag(PSTR("OperationStatus()[XCHG]"), status->operationStatus, OperationStatusFlags::XCHG);
 }
 
 /**
   @brief 2.6.3 Short Circuit in Discharge Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void ShortCircuitInDischargeProtectionCheck() {
+void ShortCircuitInDischargeProtectionCheck(const ProtectionStatus *status) {
   PGM_PRINTLN("\n=== 2.6.3 Short Circuit in Discharge Protection:");
 
-  const bool _silence = SILENCE;
-  SILENCE = true;
-  const u32 safetyAlert = SafetyAlert();  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
-  const u32 safetyStatus = SafetyStatus();  // 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
-  SILENCE = _silence;
+  ProtectionStatus _status;
+  status = _useProtectionStatus(status, &_status);
+  if (NULL == status) return;
 
-  printFlag(PSTR("SafetyAlert()[ASCD]"), safetyAlert, SafetyAlertFlags::ASCD);
-  printFlag(PSTR("SafetyStatus()[ASCD]"), safetyStatus, SafetyStatusFlags::ASCD);
-  printFlag(PSTR("OperationStatus()[XDSG]"), safetyStatus, OperationStatusFlags::XDSG);
+  printFlag(PSTR("SafetyAlert()[ASCD]"), status->safetyAlert, SafetyAlertFlags::ASCD);
+  printFlag(PSTR("SafetyStatus()[ASCD]"), status->safetyStatus, SafetyStatusFlags::ASCD);
+  printFlag(PSTR("OperationStatus()[XDSG]"), status->operationStatus, OperationStatusFlags::XDSG);
 }
 
 /**
@@ -359,6 +441,8 @@ void ShortCircuitInDischargeProtectionCheck() {
   - BatteryStatus()[TCA] = 0
   - OperationStatus()[XCHG] = 1
 
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
+
   @see SafetyAlertFlags
   @see SafetyStatusFlags
   @see BatteryStatusFlags
@@ -366,32 +450,32 @@ void ShortCircuitInDischargeProtectionCheck() {
   @see DF_ADDR::OTC_THRESHOLD
   @see DF_ADDR::OTC_RECOVERY
 */
-void OvertemperatureInChargeProtectionCheck() {
+void OvertemperatureInChargeProtectionCheck(const ProtectionStatus *status) {
   PGM_PRINTLN("\n=== 2.8 Overtemperature in Charge Protection");
-  const boolean silence = SILENCE;
 
+  ProtectionStatus _status;
+  status = _useProtectionStatus(status, &_status);
+  if (NULL == status) return;
+
+  const boolean silence = SILENCE;
   SILENCE = true;
-  const u32 safetyAlert = SafetyAlert();  // 12.2.26 AltManufacturerAccess() 0x0050 SafetyAlert
-  const u32 safetyStatus = SafetyStatus();  // 12.2.27 AltManufacturerAccess() 0x0051 SafetyStatus
-  const word batteryStatus = BatteryStatus();  // 12.1.6 0x0A/0B BatteryStatus()
-  const u32 operationStatus = OperationStatus();  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
 
   // 13.10.8 OTC—Overtemperature in Charge. Protections.OTC
-  const float otcThreshold = DECIPART * dfReadI2(DF_ADDR::OTC_THRESHOLD);  // 46.0 °C
-  const float otcRecovery = DECIPART * dfReadI2(DF_ADDR::OTC_RECOVERY);  // 43.0 °C
+  const int otcThreshold = dfReadI2(DF_ADDR::OTC_THRESHOLD);  // 460 = 46.0 °C
+  const int otcRecovery = dfReadI2(DF_ADDR::OTC_RECOVERY);  // 430 = 43.0 °C
 
   SILENCE = false;
   Temperature();  // 12.1.4 0x06/07 Temperature()
   ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
   ChargingCurrent();  // 12.1.26 0x32/33 ChargingCurrent()
-  printFlag(PSTR("SafetyAlert()[OTC]"), safetyAlert, SafetyAlertFlags::OTC);  // OTC (Bit 12): Overtemperature During Charge
-  printFlag(PSTR("SafetyStatus()[OTC]"), safetyStatus, SafetyStatusFlags::OTC);  // OTC (Bit 12): Overtemperature During Charge
-  printFlag(PSTR("BatteryStatus()[OTA]"), batteryStatus, BatteryStatusFlags::OTA);  // OTA (Bit 12): Overtemperature Alarm
-  printFlag(PSTR("BatteryStatus()[TCA]"), batteryStatus, BatteryStatusFlags::TCA);  // TCA (Bit 14): Terminate Charge Alarm
-  printFlag(PSTR("OperationStatus()[XCHG]"), operationStatus, OperationStatusFlags::XCHG);  // XCHG (Bit 14): Charging disabled
+  printFlag(PSTR("SafetyAlert()[OTC]"), status->safetyAlert, SafetyAlertFlags::OTC);  // OTC (Bit 12): Overtemperature During Charge
+  printFlag(PSTR("SafetyStatus()[OTC]"), status->safetyStatus, SafetyStatusFlags::OTC);  // OTC (Bit 12): Overtemperature During Charge
+  printFlag(PSTR("BatteryStatus()[OTA]"), status->batteryStatus, BatteryStatusFlags::OTA);  // OTA (Bit 12): Overtemperature Alarm
+  printFlag(PSTR("BatteryStatus()[TCA]"), status->batteryStatus, BatteryStatusFlags::TCA);  // TCA (Bit 14): Terminate Charge Alarm
+  printFlag(PSTR("OperationStatus()[XCHG]"), status->operationStatus, OperationStatusFlags::XCHG);  // XCHG (Bit 14): Charging disabled
   Serial.println();
-  printFloat(PSTR("OTCThreshold"), otcThreshold, DECIPART_DECIMAL, Units::CELSIUS);
-  printFloat(PSTR("OTCRecovery"), otcRecovery, DECIPART_DECIMAL, Units::CELSIUS);
+  printFixed(PSTR("OTCThreshold"), otcThreshold, DECIPART_DECIMAL, Units::CELSIUS());
+  printFixed(PSTR("OTCRecovery"), otcRecovery, DECIPART_DECIMAL, Units::CELSIUS());
   SILENCE = silence;
 }
 
@@ -404,23 +488,26 @@ void OvertemperatureInChargeProtectionCheck() {
   @see ChargingVoltage()
   @see OperationStatusFlags
   @see BatteryStatusFlags
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void PermanentFailCheck() {
+void PermanentFailCheck(const ProtectionStatus *status) {
   PGM_PRINTLN("\n=== 3 Permanent Fail");
 
+  ProtectionStatus _status;
+  status = _useProtectionStatus(status, &_status);
+  if (NULL == status) return;
+
   const bool _silence = SILENCE;
   SILENCE = true;
-  const word batteryStatus = BatteryStatus();  // 12.1.6 0x0A/0B BatteryStatus()
-  const u32 operationStatus = OperationStatus();  // 12.2.30 AltManufacturerAccess() 0x0054 OperationStatus
-  const float chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
+  const Measurement chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
   const int chargingCurrent = ChargingCurrent();  // 12.1.26 0x32/33 ChargingCurrent()
   SILENCE = _silence;
 
-  printFlag(PSTR("OperationStatus()[PF]"), operationStatus, OperationStatusFlags::PF);
-  printFlag(PSTR("BatteryStatus()[TCA]"), batteryStatus, BatteryStatusFlags::TCA);
-  printFlag(PSTR("BatteryStatus()[TDA]"), batteryStatus, BatteryStatusFlags::TDA);
+  printFlag(PSTR("OperationStatus()[PF]"), status->operationStatus, OperationStatusFlags::PF);
+  printFlag(PSTR("BatteryStatus()[TCA]"), status->batteryStatus, BatteryStatusFlags::TCA);
+  printFlag(PSTR("BatteryStatus()[TDA]"), status->batteryStatus, BatteryStatusFlags::TDA);
   printInteger(PSTR("ChargingCurrent()"), chargingCurrent, Units::MA());
-  printFloat(PSTR("ChargingVoltage()"), chargingVoltage, PERMIL_DECIMAL, Units::V());
+  printMeasurement(PSTR("ChargingVoltage()"), chargingVoltage, Units::V());
 }
 
 /**
@@ -442,7 +529,7 @@ void fetsStatus() {
   securityMode();
 
   const int chargingCurrent = ChargingCurrent();  // 12.1.26 0x32/33 ChargingCurrent()
-  const float chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
+  const Measurement chargingVoltage = ChargingVoltage();  // 12.1.25 0x30/31 ChargingVoltage()
 
   SILENCE = true;
 
@@ -462,45 +549,49 @@ void fetsStatus() {
   @brief Enable or Disable turning charging FET off at 60% SOC
   @see How to Stop Battery Charging at a Specific Percentage:
        https://www.linkedin.com/pulse/how-stop-battery-charging-specific-percentage-oleksii-sylichenko-vpmkf
+  All parameters are written by the single Data Flash transaction:
+  FET Options in one window, SOC Flag Config A and the TC thresholds in another one.
+
+  @returns number of the write transactions, or -1 if the parameters could not be written, see dfTransactionCommit()
+
   @see dfWriteFetOptionsCHGFET()
   @see dfWriteTcSetRsocThreshold()
   @see dfWriteTcClearRsocThreshold()
   @see dfWriteSocFlagConfigA()
+  @see dfTransactionCommit()
 */
-void setEnabledChargingSocThreshold(bool enabled) {
-  dfWriteFetOptionsCHGFET(enabled);  // If FET Options[CHGFET] = 1 and GaugingStatus()[TC] = 1, CHG FET turns off
-
-  if (!enabled) return;
+int setEnabledChargingSocThreshold(bool enabled) {
+  DfTransaction tx;
+  dfTransactionBegin(&tx);
 
-  const byte STOP_THRESHOLD = 60, RESUME_THRESHOLD = 55;
+  // If FET Options[CHGFET] = 1 and GaugingStatus()[TC] = 1, CHG FET turns off
+  dfTransactionSetBit(&tx, DF_ADDR::FET_OPTIONS, FetOptionsFlags::CHGFET().n, enabled);
 
-  const byte setThreshold = dfReadTcSetRsocThreshold();
-  if (STOP_THRESHOLD != setThreshold) dfWriteTcSetRsocThreshold(STOP_THRESHOLD);
+  if (enabled) {
+    const byte STOP_THRESHOLD = 60, RESUME_THRESHOLD = 55;
 
-  const byte clearThreshold = dfReadTcClearRsocThreshold();
-  if (RESUME_THRESHOLD != clearThreshold) dfWriteTcClearRsocThreshold(RESUME_THRESHOLD);
+    dfTransactionSetByte(&tx, DF_ADDR::TC_SET_RSOC_THRESHOLD, STOP_THRESHOLD);
+    dfTransactionSetByte(&tx, DF_ADDR::TC_CLEAR_RSOC_THRESHOLD, RESUME_THRESHOLD);
 
-  word socFlagConfigA = dfReadSocFlagConfigA();
-  const word _socFlagConfigA = socFlagConfigA;
-
-  bitClear(socFlagConfigA, SOCFlagConfigAFlags::TCSETV().n);  // Disable the TC flag set by cell voltage threshold
-  bitClear(socFlagConfigA, SOCFlagConfigAFlags::TCCLEARV().n);  // Disable the TC flag clear by cell voltage threshold
-
-  bitSet(socFlagConfigA, SOCFlagConfigAFlags::TCSETRSOC().n);  // Enables the TC flag set by the RSOC threshold
-  bitSet(socFlagConfigA, SOCFlagConfigAFlags::TCCLEARRSOC().n);  // Enables the TC flag cleared by the RSOC threshold
+    // SOC Flag Config A is H2 in Little Endian, the bits 4-7 are in the byte at its address:
+    dfTransactionSetBit(&tx, DF_ADDR::SOC_FLAG_CONFIG_A, SOCFlagConfigAFlags::TCSETV().n, false);  // Disable the TC flag set by cell voltage threshold
+    dfTransactionSetBit(&tx, DF_ADDR::SOC_FLAG_CONFIG_A, SOCFlagConfigAFlags::TCCLEARV().n, false);  // Disable the TC flag clear by cell voltage threshold
+    dfTransactionSetBit(&tx, DF_ADDR::SOC_FLAG_CONFIG_A, SOCFlagConfigAFlags::TCSETRSOC().n, true);  // Enables the TC flag set by the RSOC threshold
+    dfTransactionSetBit(&tx, DF_ADDR::SOC_FLAG_CONFIG_A, SOCFlagConfigAFlags::TCCLEARRSOC().n, true);  // Enables the TC flag cleared by the RSOC threshold
+  }
 
-  if (_socFlagConfigA != socFlagConfigA) dfWriteSocFlagConfigA(socFlagConfigA);
+  return dfTransactionCommit(&tx);
 }
 
 /**
   @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2
+  @param maxAge - ITStatus2() read not older than maxAge is reused, ms; 0 = always request the device
   @returns KKkk: DOD0 Passed Q. Passed charge since DOD0
 */
-int dod0PassedQ() {
-  byte buf[BlockProtocol::RESPONSE_MAX_SIZE];
-  memset(buf, 0, sizeof(buf));
-  ITStatus2(buf);
-  return composeWord(buf, IT_STATUS_2::DOD0_Passed_Q);  // KKkk: DOD0 Passed Q. Passed charge since DOD0
+int dod0PassedQ(unsigned long maxAge) {
+  ITStatus2Data itStatus2;
+  if (!ITStatus2(&itStatus2, maxAge)) return 0;
+  return itStatus2.dod0PassedQ;  // KKkk: DOD0 Passed Q. Passed charge since DOD0
 }
 
 /**
@@ -556,37 +647,47 @@ void learningCycleLog() {
   const bool _silence = SILENCE;
   SILENCE = true;
 
-  byte buf[BlockProtocol::MAX];
-  memset(buf, 0, sizeof(buf));
-  DAStatus1(buf);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
+  DAStatus1Data daStatus1;
+  memset(&daStatus1, 0, sizeof(daStatus1));
+  DAStatus1(&daStatus1);  // 12.2.37 AltManufacturerAccess() 0x0071 DAStatus1
 
-  const word cellVoltage1 = composeWord(buf, DA_STATUS_1::CELL_VOLTAGE_1);
-  const word cellVoltage2 = composeWord(buf, DA_STATUS_1::CELL_VOLTAGE_2);
-  const word packVoltage = composeWord(buf, DA_STATUS_1::PACK_VOLTAGE);
+  const word cellVoltage1 = daStatus1.cellVoltage1;
+  const word cellVoltage2 = daStatus1.cellVoltage2;
+  const word packVoltage = daStatus1.packVoltage;
 
   const word soc = RelativeStateOfCharge();  // 12.1.23 0x2C/2D RelativeStateOfCharge()
   const u32 gaugingStatus = GaugingStatus();  // 12.2.32 AltManufacturerAccess() 0x0056 GaugingStatus
 
   const int current = Current();
-  const float t = Temperature();
+  const long t = TemperatureRegister::fixed(rawTemperature()) / 10;  // 0.1 °C
 
   const int qMaxCell1 = dfReadQmaxCell1();
   const int qMaxCell2 = dfReadQmaxCell2();
   const int qMaxPack = dfReadQmaxPack();
   const byte updateStatus = dfReadGasGaugingUpdateStatus();
 
-  Serial.println("cellVoltage1:" + String(cellVoltage1)
-                 + ",cellVoltage2:" + String(cellVoltage2)
-                 + ",pack:" + String(packVoltage)
-                 + ",current:" + String(current)
-                 + ",t:" + String(t, 1)
-                 + ",soc:" + String(soc)
-                 + ",qMaxCell1:" + String(qMaxCell1)
-                 + ",qMaxCell2:" + String(qMaxCell2)
-                 + ",qMaxPack:" + String(qMaxPack)
-                 + ",gaugingStatus:" + String(gaugingStatus, BIN)
-                 + ",updateStatus:" + String(updateStatus, HEX)
-                );
+  PGM_PRINT("cellVoltage1:");
+  Serial.print(cellVoltage1);
+  PGM_PRINT(",cellVoltage2:");
+  Serial.print(cellVoltage2);
+  PGM_PRINT(",pack:");
+  Serial.print(packVoltage);
+  PGM_PRINT(",current:");
+  Serial.print(current);
+  PGM_PRINT(",t:");
+  printFixed(t, DECIPART_DECIMAL, NULL);
+  PGM_PRINT(",soc:");
+  Serial.print(soc);
+  PGM_PRINT(",qMaxCell1:");
+  Serial.print(qMaxCell1);
+  PGM_PRINT(",qMaxCell2:");
+  Serial.print(qMaxCell2);
+  PGM_PRINT(",qMaxPack:");
+  Serial.print(qMaxPack);
+  PGM_PRINT(",gaugingStatus:");
+  Serial.print(gaugingStatus, BIN);
+  PGM_PRINT(",updateStatus:");
+  Serial.println(updateStatus, HEX);
   SILENCE = _silence;
 }
 
@@ -35,6 +35,7 @@
 #include "std_data_commands.h"
 #include "alt_manufacturer_access.h"
 #include "data_flash_access.h"
+#include "protection.h"
 
 /**
   @brief Request current security mode of the device.
@@ -52,9 +53,35 @@
     0, 1 = Full Access - doesn't work correct! It's (0, 0) in fact
     1, 0 = Unsealed
     1, 1 = Sealed
+
+  The result is stored into the security mode cache.
+
+  @see getSecurityModeCache()
 */
 int securityMode();
 
+/**
+  @brief Security mode of the device known for the current session.
+
+  The device is requested only if the mode is not known yet or the cache was invalidated.
+
+  @see securityMode()
+  @see invalidateSecurityModeCache()
+*/
+int cachedSecurityMode();
+
+/**
+  @brief Request current security mode of the device without printing.
+
+  The result is stored into the security mode cache.
+
+  @returns SecurityMode::UNKNOWN if the device responded with invalid data.
+
+  @see securityMode()
+  @see rawOperationStatus()
+*/
+int rawSecurityMode();
+
 /**
   @brief 9.5.2 SEALED to UNSEALED
 
@@ -66,11 +93,16 @@ int securityMode();
   in FULL ACCESS mode. To return to the SEALED mode, either a hardware reset is needed,
   or the MAC SealDevice() command is needed to transit from FULL ACCESS or UNSEALED to SEALED.
 
+  The transition is verified by polling of OperationStatus() instead of the fixed delay,
+  the cached security mode holds the result.
+
+  @returns whether the device became UNSEALED or FULL ACCESS within DeviceSecurity::TRANSITION_TIMEOUT_MS
+
   @see SealDevice()
   @see securityMode()
   @see DeviceSecurity::DEFAULT_UNSEAL_KEY
 */
-void unsealDevice(u32 key = DeviceSecurity::DEFAULT_UNSEAL_KEY);
+bool unsealDevice(u32 key = DeviceSecurity::DEFAULT_UNSEAL_KEY);
 
 /**
   @brief 9.5.3 UNSEALED to FULL ACCESS
@@ -82,11 +114,16 @@ void unsealDevice(u32 key = DeviceSecurity::DEFAULT_UNSEAL_KEY);
   word of the Full Access Key to AltManufacturerAccess(), followed by the second word of the Full Access Key to
   AltManufacturerAccess(). In FULL ACCESS mode, the command to go to boot ROM can be sent.
 
+  The transition is verified by polling of OperationStatus() instead of the fixed delay,
+  the cached security mode holds the result.
+
+  @returns whether the device became FULL ACCESS within DeviceSecurity::TRANSITION_TIMEOUT_MS
+
   @see DeviceSecurity::DEFAULT_FULL_ACCESS_KEY
   @see SealDevice()
   @see securityMode()
 */
-void fullAccessDevice(u32 key = DeviceSecurity::DEFAULT_FULL_ACCESS_KEY);
+bool fullAccessDevice(u32 key = DeviceSecurity::DEFAULT_FULL_ACCESS_KEY);
 
 /**
   @brief Brings Charge FET into desired mode.
@@ -122,43 +159,67 @@ void fetControl(bool mode);
 bool isPermanentFail();
 
 /**
+  @brief Chapter 3: Permanent Fail, no printing.
+  @see isPermanentFail()
+*/
+bool rawIsPermanentFail();
+
+/**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float cellVoltage1();
+Measurement cellVoltage1(unsigned long maxAge = 0);
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float cellVoltage2();
+Measurement cellVoltage2(unsigned long maxAge = 0);
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float batVoltage();
+Measurement batVoltage(unsigned long maxAge = 0);
 
 /**
+  @returns the voltage, V, or mV if FIXED_POINT
+  @param maxAge - DAStatus1() read not older than maxAge is reused, ms; 0 = always request the device
+
   @see DAStatus1()
   @see DA_STATUS_1
 */
-float packVoltage();
+Measurement packVoltage(unsigned long maxAge = 0);
 
 /**
   @brief 2.2 Cell Undervoltage Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void CellUndervoltageProtectionCheck();
+void CellUndervoltageProtectionCheck(const ProtectionStatus *status = NULL);
 
 /**
   @brief 2.6.2 Short Circuit in Charge Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void ShortCircuitInChargeProtectionCheck();
+void ShortCircuitInChargeProtectionCheck(const ProtectionStatus *status = NULL);
 
 /**
   @brief 2.6.3 Short Circuit in Discharge Protection
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void ShortCircuitInDischargeProtectionCheck();
+void ShortCircuitInDischargeProtectionCheck(const ProtectionStatus *status = NULL);
 
 /**
   @brief 2.8 Overtemperature in Charge Protection
@@ -170,6 +231,8 @@ void ShortCircuitInDischargeProtectionCheck();
   - BatteryStatus()[TCA] = 0
   - OperationStatus()[XCHG] = 1
 
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
+
   @see SafetyAlertFlags
   @see SafetyStatusFlags
   @see BatteryStatusFlags
@@ -177,12 +240,14 @@ void ShortCircuitInDischargeProtectionCheck();
   @see DF_ADDR::OTC_THRESHOLD
   @see DF_ADDR::OTC_RECOVERY
 */
-void OvertemperatureInChargeProtectionCheck();
+void OvertemperatureInChargeProtectionCheck(const ProtectionStatus *status = NULL);
 
 /**
   @brief Chapter 3 Permanent Fail
+
+  @param status - status words read once for all the checks by readProtectionStatus(), NULL = request the device
 */
-void PermanentFailCheck();
+void PermanentFailCheck(const ProtectionStatus *status = NULL);
 
 /**
   @brief Print flags that correspond to the FETs status.
@@ -193,12 +258,18 @@ void fetsStatus();
   @brief Enable or Disable turning charging FET off at 60% SOC
   @see How to Stop Battery Charging at a Specific Percentage:
        https://www.linkedin.com/pulse/how-stop-battery-charging-specific-percentage-oleksii-sylichenko-vpmkf
+  All parameters are written by the single Data Flash transaction:
+  FET Options in one window, SOC Flag Config A and the TC thresholds in another one.
+
+  @returns number of the write transactions, or -1 if the parameters could not be written, see dfTransactionCommit()
+
   @see dfWriteFetOptionsCHGFET()
   @see dfWriteTcSetRsocThreshold()
   @see dfWriteTcClearRsocThreshold()
   @see dfWriteSocFlagConfigA()
+  @see dfTransactionCommit()
 */
-void setEnabledChargingSocThreshold(bool enabled);
+int setEnabledChargingSocThreshold(bool enabled);
 
 /**
   @brief Write initial parameters to the Gas Gauging Device.
@@ -242,9 +313,10 @@ void learningCycleLog();
 
 /**
   @brief 12.2.40 AltManufacturerAccess() 0x0074 ITStatus2
+  @param maxAge - ITStatus2() read not older than maxAge is reused, ms; 0 = always request the device
   @returns KKkk: DOD0 Passed Q. Passed charge since DOD0
 */
-int dod0PassedQ();
+int dod0PassedQ(unsigned long maxAge = 0);
 
 /**
   @brief Overcurrent in Charge trip threshold
@@ -0,0 +1,295 @@
+/**
+  @file simulated_gauge.cpp
+
+  @brief Simulated BQ28Z610 behind the GaugeTransport
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "simulated_gauge.h"
+#include "flags.h"
+
+/**
+  Status of TwoWire::endTransmission(): address sent, NACK received.
+*/
+const int _SIM_NACK_ADDR = 2;
+
+/**
+  Status of TwoWire::endTransmission(): data too long to fit in the transmit buffer.
+*/
+const int _SIM_DATA_TOO_LONG = 1;
+
+/**
+  SEC1, SEC0 bits of the security mode.
+  @param sec0 - number of the SEC0 bit, SEC1 is the next one
+*/
+u32 _simSecBits(byte securityMode, byte sec0) {
+  return (u32) (securityMode & 0b11) << sec0;
+}
+
+/**
+  ManufacturerAccessControl() shows (0, 0) instead of (0, 1) in FULL ACCESS mode, the same as the real device.
+*/
+void _simUpdateControl(SimulatedGauge *sim) {
+  const byte mode = SecurityMode::FULL_ACCESS == sim->securityMode ? 0 : sim->securityMode;
+  const word control = _simSecBits(mode, ManufacturerAccessFlags::SEC0().n);
+  sim->regs[StdCommands::MANUFACTURER_ACCESS_CONTROL] = control & 0xFF;
+  sim->regs[StdCommands::MANUFACTURER_ACCESS_CONTROL + 1] = (control >> 8) & 0xFF;
+}
+
+void _simTransferDelay(SimulatedGauge *sim, int bytes) {
+  if (sim->byteUs > 0) delayMicroseconds(sim->byteUs * bytes);
+}
+
+bool _simIsDfAddr(SimulatedGauge *sim, word addr) {
+  return NULL != sim->df && addr >= DF_ADDR::MIN && addr - DF_ADDR::MIN < sim->dfSize;
+}
+
+/**
+  Publish the response of the subcommand: echo, data, checksum and length.
+*/
+void _simRespond(SimulatedGauge *sim, word MACSubcmd) {
+  byte *block = sim->regs + StdCommands::ALT_MANUFACTURER_ACCESS;
+  byte *data = sim->regs + SimulatedGaugeConfig::MAC_DATA;
+  memset(data, 0, BlockProtocol::PAYLOAD_MAX_SIZE);
+
+  byte len = 0;
+  if (_simIsDfAddr(sim, MACSubcmd)) {
+    if (SecurityMode::SEALED != sim->securityMode) {
+      const word offset = MACSubcmd - DF_ADDR::MIN;
+      len = min((word) BlockProtocol::PAYLOAD_MAX_SIZE, (word) (sim->dfSize - offset));
+      memcpy(data, sim->df + offset, len);
+    }
+  } else if (AltManufacturerCommands::OPERATION_STATUS == MACSubcmd) {
+    const byte sec0 = OperationStatusFlags::SEC0().n;
+    const u32 value = (sim->operationStatus & ~_simSecBits(0b11, sec0)) | _simSecBits(sim->securityMode, sec0);
+    for (len = 0; len < 4; len++) data[len] = (value >> (8 * len)) & 0xFF;
+  } else if (NULL != sim->macHandler) {
+    len = min(sim->macHandler(MACSubcmd, data), (byte) BlockProtocol::PAYLOAD_MAX_SIZE);
+  } else {
+    len = BlockProtocol::PAYLOAD_MAX_SIZE;
+  }
+
+  block[0] = MACSubcmd & 0xFF;
+  block[1] = (MACSubcmd >> 8) & 0xFF;
+  sim->regs[StdCommands::MAC_DATA_CHECKSUM] = checksum(block, BlockProtocol::ADDR_SIZE + len);
+  sim->regs[StdCommands::MAC_DATA_CHECKSUM + 1] = len + BlockProtocol::SERVICE_SIZE;
+}
+
+/**
+  Publish the response if the subcommand has been processed.
+*/
+void _simProcess(SimulatedGauge *sim) {
+  if (!sim->isPending) return;
+
+  const unsigned long latency = NULL != sim->latencyFn ? sim->latencyFn(sim->pendingSubcmd) : sim->macLatencyUs;
+  if (micros() - sim->pendingSinceUs < latency) return;
+
+  sim->isPending = false;
+  _simRespond(sim, sim->pendingSubcmd);
+}
+
+/**
+  The word written to 0x3E: the security key, a command without the response, or a subcommand.
+*/
+void _simSubcommand(SimulatedGauge *sim, word value) {
+  const u32 key = ((u32) value << 16) | sim->lastWord;
+  sim->lastWord = value;
+  sim->macCommands++;
+
+  if (SecurityMode::SEALED == sim->securityMode && DeviceSecurity::DEFAULT_UNSEAL_KEY == key) {
+    sim->securityMode = SecurityMode::UNSEALED;
+    _simUpdateControl(sim);
+    return;
+  }
+  if (SecurityMode::UNSEALED == sim->securityMode && DeviceSecurity::DEFAULT_FULL_ACCESS_KEY == key) {
+    sim->securityMode = SecurityMode::FULL_ACCESS;
+    _simUpdateControl(sim);
+    return;
+  }
+
+  switch (value) {
+    case AltManufacturerCommands::SEAL_DEVICE:
+      sim->securityMode = SecurityMode::SEALED;
+      _simUpdateControl(sim);
+      return;
+    case AltManufacturerCommands::DEVICE_RESET:
+      sim->isPending = false;
+      return;
+  }
+
+  sim->isPending = true;
+  sim->pendingSubcmd = value;
+  sim->pendingSinceUs = micros();
+  sim->regs[StdCommands::ALT_MANUFACTURER_ACCESS] = 0xFF;  // no echo until the response is ready
+  sim->regs[StdCommands::ALT_MANUFACTURER_ACCESS + 1] = 0xFF;
+}
+
+/**
+  Checksum and length written to 0x60 after the address and data were written to 0x3E.
+*/
+void _simDfWrite(SimulatedGauge *sim) {
+  const byte *block = sim->regs + StdCommands::ALT_MANUFACTURER_ACCESS;
+  const word addr = block[0] | (block[1] << 8);
+  const int dataLen = (int) sim->regs[StdCommands::MAC_DATA_CHECKSUM + 1] - BlockProtocol::SERVICE_SIZE;
+
+  if (dataLen < 1 || dataLen > BlockProtocol::PAYLOAD_MAX_SIZE) return;
+  if (checksum((byte*) block, BlockProtocol::ADDR_SIZE + dataLen) != sim->regs[StdCommands::MAC_DATA_CHECKSUM]) return;
+  if (SecurityMode::SEALED == sim->securityMode) return;
+
+  for (int i = 0; i < dataLen; i++) {
+    if (_simIsDfAddr(sim, addr + i)) sim->df[addr + i - DF_ADDR::MIN] = block[BlockProtocol::ADDR_SIZE + i];
+  }
+  sim->dfWrites++;
+}
+
+/**
+  @brief Reset the simulator to the power-up state.
+
+  @param df - memory for the Data Flash image, filled with 0xFF; can be NULL if the Data Flash is not used
+  @param dfSize - size of the memory, up to 0x2000
+*/
+void simulatedGaugeBegin(SimulatedGauge *sim, byte *df, word dfSize) {
+  memset(sim, 0, sizeof(SimulatedGauge));
+  sim->addr = DEVICE_ADDR;
+  sim->df = df;
+  sim->dfSize = NULL == df ? 0 : min(dfSize, (word) (DF_ADDR::MAX - DF_ADDR::MIN + 1));
+  if (NULL != df) memset(df, 0xFF, sim->dfSize);
+
+  sim->securityMode = SecurityMode::FULL_ACCESS;
+  sim->macLatencyUs = SimulatedGaugeConfig::DEFAULT_MAC_LATENCY_US;
+  _simUpdateControl(sim);
+}
+
+/**
+  @brief Transport to be passed to the Gauge constructor.
+*/
+GaugeTransport simulatedGaugeTransport(SimulatedGauge *sim) {
+  GaugeTransport retval = {simulatedGaugeWrite, simulatedGaugeRead, sim};
+  return retval;
+}
+
+/**
+  @brief Set the value of the Standard Data Command, order of bytes is Normal.
+*/
+void simulatedGaugeSetRegister(SimulatedGauge *sim, byte reg, word value) {
+  if (reg + 1 >= StdCommands::ALT_MANUFACTURER_ACCESS) return;
+  sim->regs[reg] = value & 0xFF;
+  sim->regs[reg + 1] = (value >> 8) & 0xFF;
+}
+
+/**
+  Value of the hex digit, -1 if the char is not a hex digit.
+*/
+int _simHexDigit(char c) {
+  if ('0' <= c && c <= '9') return c - '0';
+  if ('a' <= c && c <= 'f') return c - 'a' + 10;
+  if ('A' <= c && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+  @brief Seed the Data Flash by one line of the dfReadAllData() dump:
+  <pre>
+    0x4000: [ 87 2F 2D C0 ... ]
+  </pre>
+
+  @returns number of the bytes stored, 0 if the line is not recognized
+*/
+int simulatedGaugeLoadDumpLine(SimulatedGauge *sim, const char *line) {
+  if ('0' != line[0] || ('x' != line[1] && 'X' != line[1])) return 0;
+
+  word addr = 0;
+  const char *p = line + 2;
+  for (int d; (d = _simHexDigit(*p)) >= 0; p++) addr = (addr << 4) | d;
+  if (':' != *p) return 0;
+
+  int stored = 0;
+  for (p++; *p && ']' != *p; p++) {
+    const int hi = _simHexDigit(p[0]);
+    if (hi < 0) continue;
+    const int lo = _simHexDigit(p[1]);
+    if (lo < 0) return stored;
+
+    if (_simIsDfAddr(sim, addr)) {
+      sim->df[addr - DF_ADDR::MIN] = (hi << 4) | lo;
+      stored++;
+    }
+    addr++;
+    p++;
+  }
+  return stored;
+}
+
+/**
+  @brief TwoWire::endTransmission()-compatible write, see GaugeTransport.
+*/
+int simulatedGaugeWrite(void *ctx, byte addr, byte reg, const byte *data, byte len) {
+  SimulatedGauge *sim = (SimulatedGauge*) ctx;
+  if (addr != sim->addr) return _SIM_NACK_ADDR;
+  if (reg + len > SimulatedGaugeConfig::REGISTERS_SIZE) return _SIM_DATA_TOO_LONG;
+
+  sim->writes++;
+  _simTransferDelay(sim, 1 + len);
+  _simProcess(sim);
+  sim->pointer = reg;
+
+  if (StdCommands::ALT_MANUFACTURER_ACCESS == reg && BlockProtocol::ADDR_SIZE == len) {
+    _simSubcommand(sim, data[0] | (data[1] << 8));
+    return 0;
+  }
+
+  if (StdCommands::MANUFACTURER_ACCESS_CONTROL == reg && 2 == len) {  // 12.1.1 ManufacturerAccess(), same as 0x3E
+    _simSubcommand(sim, data[0] | (data[1] << 8));
+    return 0;
+  }
+
+  if (0 == len) return 0;  // the register for the next read
+
+  if (StdCommands::ALT_MANUFACTURER_ACCESS == reg) {  // the address and data of the Data Flash write
+    sim->isPending = false;
+    memcpy(sim->regs + reg, data, len);
+  } else if (StdCommands::MAC_DATA_CHECKSUM == reg && BlockProtocol::CHECKSUM_AND_LENGTH_SIZE == len) {
+    memcpy(sim->regs + reg, data, len);
+    _simDfWrite(sim);
+  }
+  return 0;
+}
+
+/**
+  @brief TwoWire::requestFrom()-compatible read, see GaugeTransport.
+*/
+byte simulatedGaugeRead(void *ctx, byte addr, byte *buf, byte len) {
+  SimulatedGauge *sim = (SimulatedGauge*) ctx;
+  if (addr != sim->addr) return 0;
+
+  sim->reads++;
+  _simTransferDelay(sim, len);
+  _simProcess(sim);
+
+  for (byte i = 0; i < len; i++) {
+    buf[i] = sim->pointer < SimulatedGaugeConfig::REGISTERS_SIZE ? sim->regs[sim->pointer] : 0xFF;
+    sim->pointer++;
+  }
+  return len;
+}
@@ -0,0 +1,150 @@
+/**
+  @file simulated_gauge.h
+
+  @brief Simulated BQ28Z610 behind the GaugeTransport
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "gauge.h"
+#include "data_flash_access.h"
+
+/**
+  @brief Constants of the simulated gauge.
+
+  Register file of the device as it is streamed by the reads:
+  <pre>
+    0x00..0x3D  Standard Data Commands, Little Endian
+    0x3E, 0x3F  AltManufacturerAccess(): echo of the completed subcommand
+    0x40..0x5F  MACData(): 32 data bytes of the response
+    0x60        MACDataSum(): checksum of the subcommand and data
+    0x61        MACDataLength(): subcommand + data + checksum + length
+  </pre>
+
+  The read continues from the register of the last write and moves forward,
+  so the block is read either by one request of 36 bytes or by several shorter ones.
+*/
+class SimulatedGaugeConfig {
+  public:
+    static const byte REGISTERS_SIZE = 0x62;
+    static const byte MAC_DATA = 0x40;  ///< MACData()
+    static const unsigned long DEFAULT_MAC_LATENCY_US = 2000;  ///< processing time of the MAC subcommand
+};
+
+/**
+  @brief State of the simulated gauge.
+
+  - Standard registers are set by simulatedGaugeSetRegister(), zeros by default;
+  - MAC responses: OperationStatus() with the SEC bits of the current security mode,
+    Data Flash rows 0x4000..0x5FFF, other subcommands by macHandler, or 32 zero bytes;
+  - the response is published after the latency of the subcommand, until then 0x3E/0x3F read 0xFFFF,
+    so both MAC_COMPLETION_MODE can be exercised;
+  - Data Flash writes are applied when the checksum and the length are valid, are ignored in SEALED mode;
+  - DeviceSecurity::DEFAULT_UNSEAL_KEY and DEFAULT_FULL_ACCESS_KEY, SealDevice().
+
+  The Data Flash memory is supplied by the caller, seeded by simulatedGaugeLoadDumpLine().
+
+  @code
+    byte df[0x2000];
+    SimulatedGauge sim;
+    simulatedGaugeBegin(&sim, df, sizeof(df));
+    GaugeTransport transport = simulatedGaugeTransport(&sim);
+    Gauge simGauge(&transport);
+    selectGauge(&simGauge);
+  @endcode
+*/
+struct SimulatedGauge {
+  byte addr;  ///< DEVICE_ADDR by default, other addresses are not acknowledged
+  byte regs[SimulatedGaugeConfig::REGISTERS_SIZE];
+  byte pointer;  ///< register of the next byte to be read
+
+  byte *df;  ///< Data Flash image starting from DF_ADDR::MIN
+  word dfSize;
+
+  byte securityMode;  ///< SecurityMode, FULL_ACCESS by default
+  u32 operationStatus;  ///< OperationStatus() without the SEC bits
+  word lastWord;  ///< the previous word written to 0x3E, for the security keys
+
+  bool isPending;  ///< the subcommand is being processed
+  word pendingSubcmd;
+  unsigned long pendingSinceUs;
+
+  unsigned long macLatencyUs;  ///< processing time of the subcommands
+  unsigned long (*latencyFn)(word MACSubcmd);  ///< per-subcommand processing time, overrides macLatencyUs if set
+  unsigned long byteUs;  ///< transfer time of one byte, 0 = native speed; about 90 us at 100 kHz
+
+  /**
+    Response of the other subcommands: fill data (up to 32 bytes), return its length.
+  */
+  byte (*macHandler)(word MACSubcmd, byte *data);
+
+  // Statistics:
+  u32 writes;  ///< write transactions
+  u32 reads;  ///< read transactions
+  u32 macCommands;  ///< MAC subcommands processed
+  u32 dfWrites;  ///< Data Flash writes applied
+};
+
+/**
+  @brief Reset the simulator to the power-up state.
+
+  @param df - memory for the Data Flash image, filled with 0xFF; can be NULL if the Data Flash is not used
+  @param dfSize - size of the memory, up to 0x2000
+*/
+void simulatedGaugeBegin(SimulatedGauge *sim, byte *df, word dfSize);
+
+/**
+  @brief Transport to be passed to the Gauge constructor.
+*/
+GaugeTransport simulatedGaugeTransport(SimulatedGauge *sim);
+
+/**
+  @brief Set the value of the Standard Data Command, order of bytes is Normal.
+*/
+void simulatedGaugeSetRegister(SimulatedGauge *sim, byte reg, word value);
+
+/**
+  @brief Seed the Data Flash by one line of the dfReadAllData() dump:
+  <pre>
+    0x4000: [ 87 2F 2D C0 ... ]
+  </pre>
+
+  @returns number of the bytes stored, 0 if the line is not recognized
+*/
+int simulatedGaugeLoadDumpLine(SimulatedGauge *sim, const char *line);
+
+/**
+  @brief TwoWire::endTransmission()-compatible write, see GaugeTransport.
+*/
+int simulatedGaugeWrite(void *ctx, byte addr, byte reg, const byte *data, byte len);
+
+/**
+  @brief TwoWire::requestFrom()-compatible read, see GaugeTransport.
+*/
+byte simulatedGaugeRead(void *ctx, byte addr, byte *buf, byte len);
@@ -0,0 +1,181 @@
+/**
+  @file status_watcher.cpp
+
+  @brief Change detection of the status words implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "status_watcher.h"
+
+/**
+  Description of the status word.
+*/
+struct _StatusWordInfo {
+  PGM_P caption;
+  const FlagTable *flags;
+};
+
+_StatusWordInfo _statusWordInfo(byte statusWord) {
+  switch (statusWord) {
+    case StatusWord::SAFETY_ALERT: return {PSTR("SafetyAlert"), &SafetyAlertFlags::TABLE};
+    case StatusWord::SAFETY_STATUS: return {PSTR("SafetyStatus"), &SafetyStatusFlags::TABLE};
+    case StatusWord::PF_ALERT: return {PSTR("PFAlert"), &PFStatusFlags::TABLE};
+    case StatusWord::PF_STATUS: return {PSTR("PFStatus"), &PFStatusFlags::TABLE};
+    case StatusWord::OPERATION_STATUS: return {PSTR("OperationStatus"), &OperationStatusFlags::TABLE};
+    case StatusWord::GAUGING_STATUS: return {PSTR("GaugingStatus"), &GaugingStatusFlags::TABLE};
+    case StatusWord::BATTERY_STATUS: return {PSTR("BatteryStatus"), &BatteryStatusFlags::TABLE};
+  }
+  return {PSTR("?"), NULL};
+}
+
+/**
+  Last value, mask and state of the status word.
+*/
+struct _WatchedWord {
+  u32 value;
+  u32 mask;
+  bool isValid;  ///< the baseline has been set
+};
+
+_WatchedWord _watchedWords[StatusWord::COUNT] = {
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false},
+  {0, 0xFFFFFFFF, false}
+};
+
+StatusChangeCallback _statusChangeCallback = NULL;
+
+/**
+  @brief Set the receiver of the changes of all the status words, NULL = no callback.
+*/
+void statusWatcherSetCallback(StatusChangeCallback callback) {
+  _statusChangeCallback = callback;
+}
+
+/**
+  @brief Report only the bits of the mask, all the bits are watched by default.
+*/
+void statusWatcherSetMask(byte statusWord, u32 mask) {
+  if (statusWord < StatusWord::COUNT) _watchedWords[statusWord].mask = mask;
+}
+
+/**
+  @brief Forget the last values, the next update sets the baseline without reporting.
+*/
+void statusWatcherReset() {
+  for (byte i = 0; i < StatusWord::COUNT; i++) _watchedWords[i].isValid = false;
+}
+
+/**
+  @brief Find the description of the bit of the status word.
+  @returns the flag with the table NULL if the bit is not described
+*/
+Flag statusFlag(byte statusWord, byte n) {
+  const FlagTable *flags = _statusWordInfo(statusWord).flags;
+  return {n, flagIndex(flags, n) < 0 ? NULL : flags};
+}
+
+/**
+  @brief Compare the value with the last one and report the changed bits.
+
+  The value can be obtained by any means, e.g. from the async transaction or from the sampler.
+  The first value of the word sets the baseline and is not reported.
+
+  @returns bits that have changed and are in the mask
+*/
+u32 statusWatcherUpdate(byte statusWord, u32 value) {
+  if (statusWord >= StatusWord::COUNT) return 0;
+
+  _WatchedWord *watched = &_watchedWords[statusWord];
+  const u32 changed = watched->isValid ? (watched->value ^ value) & watched->mask : 0;
+  watched->value = value;
+  watched->isValid = true;
+
+  if (0 != changed && NULL != _statusChangeCallback) {
+    for (byte n = 0; n < 32; n++) {
+      if (bitRead(changed, n)) _statusChangeCallback(statusWord, statusFlag(statusWord, n), bitRead(value, n));
+    }
+  }
+  return changed;
+}
+
+/**
+  @brief Request the status word from the device without printing and update the watcher.
+  @returns bits that have changed and are in the mask, 0 if the device responded with invalid data
+*/
+u32 statusWatcherPoll(byte statusWord) {
+  u32 value = 0;
+  bool isRead = false;
+  switch (statusWord) {
+    case StatusWord::SAFETY_ALERT: isRead = rawSafetyAlert(&value); break;
+    case StatusWord::SAFETY_STATUS: isRead = rawSafetyStatus(&value); break;
+    case StatusWord::PF_ALERT: isRead = rawPFAlert(&value); break;
+    case StatusWord::PF_STATUS: isRead = rawPFStatus(&value); break;
+    case StatusWord::OPERATION_STATUS: isRead = rawOperationStatus(&value); break;
+    case StatusWord::GAUGING_STATUS: isRead = rawGaugingStatus(&value); break;
+    case StatusWord::BATTERY_STATUS: {
+      word batteryStatus;
+      isRead = rawBatteryStatus(&batteryStatus);
+      value = batteryStatus;
+      break;
+    }
+  }
+  return isRead ? statusWatcherUpdate(statusWord, value) : 0;
+}
+
+/**
+  @brief Poll all the status words.
+  @returns number of the words that have changed
+*/
+byte statusWatcherPollAll() {
+  byte retval = 0;
+  for (byte i = 0; i < StatusWord::COUNT; i++) {
+    if (0 != statusWatcherPoll(i)) retval++;
+  }
+  return retval;
+}
+
+/**
+  @brief The last value of the status word.
+  @returns false if the word has not been obtained yet
+*/
+bool statusWatcherValue(byte statusWord, u32 *retval) {
+  if (statusWord >= StatusWord::COUNT || !_watchedWords[statusWord].isValid) return false;
+  *retval = _watchedWords[statusWord].value;
+  return true;
+}
+
+/**
+  @brief Ready callback: print the change in format: "SafetyStatus: OTC (Bit 12): Overtemperature During Charge: 1"
+  @see statusWatcherSetCallback()
+*/
+void printStatusChange(byte statusWord, Flag flag, bool value) {
+  printPgm(_statusWordInfo(statusWord).caption);
+  PGM_PRINT(": ");
+  printFlag(value ? 0xFFFFFFFF : 0, flag);
+}
@@ -0,0 +1,124 @@
+/**
+  @file status_watcher.h
+
+  @brief Change detection of the status words headers
+
+
+  The last value of every status word is kept, only the changed bits are reported.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "flags.h"
+#include "utils.h"
+#include "std_data_commands.h"
+#include "alt_manufacturer_access.h"
+
+/**
+  @brief Watched status words.
+*/
+class StatusWord {
+  public:
+    static const byte SAFETY_ALERT = 0;  ///< 12.2.26 0x0050 SafetyAlert
+    static const byte SAFETY_STATUS = 1;  ///< 12.2.27 0x0051 SafetyStatus
+    static const byte PF_ALERT = 2;  ///< 12.2.28 0x0052 PFAlert, the bits are the same as PFStatus
+    static const byte PF_STATUS = 3;  ///< 12.2.29 0x0053 PFStatus
+    static const byte OPERATION_STATUS = 4;  ///< 12.2.30 0x0054 OperationStatus
+    static const byte GAUGING_STATUS = 5;  ///< 12.2.32 0x0056 GaugingStatus
+    static const byte BATTERY_STATUS = 6;  ///< 12.1.6 0x0A/0B BatteryStatus
+    static const byte COUNT = 7;
+};
+
+/**
+  @brief Receiver of a changed bit.
+
+  @param statusWord - StatusWord
+  @param flag - the bit index and the table of flags.h, the table is NULL if the bit is not described, see flagCaption()
+  @param value - the new value of the bit
+*/
+typedef void (*StatusChangeCallback)(byte statusWord, Flag flag, bool value);
+
+/**
+  @brief Set the receiver of the changes of all the status words, NULL = no callback.
+*/
+void statusWatcherSetCallback(StatusChangeCallback callback);
+
+/**
+  @brief Report only the bits of the mask, all the bits are watched by default.
+
+  @code
+    // react only on the trips of OTC and ASCD
+    statusWatcherSetMask(StatusWord::SAFETY_STATUS, bit(SafetyStatusFlags::OTC().n) | bit(SafetyStatusFlags::ASCD().n));
+  @endcode
+*/
+void statusWatcherSetMask(byte statusWord, u32 mask);
+
+/**
+  @brief Forget the last values, the next update sets the baseline without reporting.
+*/
+void statusWatcherReset();
+
+/**
+  @brief Compare the value with the last one and report the changed bits.
+
+  The value can be obtained by any means, e.g. from the async transaction or from the sampler.
+  The first value of the word sets the baseline and is not reported.
+
+  @returns bits that have changed and are in the mask
+*/
+u32 statusWatcherUpdate(byte statusWord, u32 value);
+
+/**
+  @brief Request the status word from the device without printing and update the watcher.
+  @returns bits that have changed and are in the mask, 0 if the device responded with invalid data
+*/
+u32 statusWatcherPoll(byte statusWord);
+
+/**
+  @brief Poll all the status words.
+  @returns number of the words that have changed
+*/
+byte statusWatcherPollAll();
+
+/**
+  @brief The last value of the status word.
+  @returns false if the word has not been obtained yet
+*/
+bool statusWatcherValue(byte statusWord, u32 *retval);
+
+/**
+  @brief Find the description of the bit of the status word.
+  @returns the flag with the table NULL if the bit is not described
+*/
+Flag statusFlag(byte statusWord, byte n);
+
+/**
+  @brief Ready callback: print the change in format: "SafetyStatus: OTC (Bit 12): Overtemperature During Charge: 1"
+  @see statusWatcherSetCallback()
+*/
+void printStatusChange(byte statusWord, Flag flag, bool value);
@@ -74,19 +74,10 @@
 word ManufacturerAccessControl() {
   if (!SILENCE) PGM_PRINTLN("\n=== 12.1.1 0x00/01 ManufacturerAccess() Control:");
 
-  sendCommand(StdCommands::MANUFACTURER_ACCESS_CONTROL);
-  const word retval = requestWord();
+  const word retval = rawManufacturerAccessControl();
   if (!SILENCE) {
     if (DEBUG) printWordBin(retval);
-    printFlag(retval, ManufacturerAccessFlags::SEC1());  // SEC1 (Bit 14): SECURITY Mode
-    printFlag(retval, ManufacturerAccessFlags::SEC0());  // SEC0 (Bit 13): SECURITY Mode
-    printFlag(retval, ManufacturerAccessFlags::AUTHCALM());  // AUTHCALM (Bit 12): Automatic CALIBRATION mode
-    printFlag(retval, ManufacturerAccessFlags::CheckSumValid());  // CheckSumValid (Bit 9): Checksum Valid
-    printFlag(retval, ManufacturerAccessFlags::BTP_INT());  // BTP_INT (Bit 7): Battery Trip Point Interrupt
-    printFlag(retval, ManufacturerAccessFlags::LDMD());  // LDMD (Bit 3): LOAD Mode
-    printFlag(retval, ManufacturerAccessFlags::R_DIS());  // R_DIS (Bit 2): Resistance Updates
-    printFlag(retval, ManufacturerAccessFlags::VOK());  // VOK (Bit 1): Voltage OK for QMax Update
-    printFlag(retval, ManufacturerAccessFlags::QMax());  // QMax (Bit 0): QMax Updates. This bit toggles after every QMax update
+    printFlags(retval, &ManufacturerAccessFlags::TABLE);
   }
   return retval;
 }
@@ -97,26 +88,23 @@ word ManufacturerAccessControl() {
   measured by the gas gauge, and is used for the gauging algorithm.
   It reports either InternalTemperature() or external thermistor temperature,
   depending on the setting of the [TEMPS] bit in Pack configuration.
-*/
-float Temperature() {
-  sendCommand(StdCommands::TEMPERATURE);
-
-  const float kelvin = DECIPART * requestWord();
-  const float celsius = KELVIN_TO_CELSIUS(kelvin);
-  if (!SILENCE) printFloat(PSTR("=== 12.1.4 0x06/07 Temperature()"), celsius, DECIPART_DECIMAL, Units::CELSIUS());
 
-  return celsius;
+  The result is in °C, or in 0.1 K if FIXED_POINT.
+*/
+Measurement Temperature() {
+  const word raw = rawTemperature();
+  if (!SILENCE) printRegister<TemperatureRegister>(PSTR("=== 12.1.4 0x06/07 Temperature()"), raw);
+  return MEASURE_DECIKELVIN(raw);
 }
 
 /**
   @brief 12.1.5 0x08/09 Voltage
-  @returns the sum of the measured cell voltages.
+  @returns the sum of the measured cell voltages, V, or mV if FIXED_POINT.
 */
-float Voltage() {
-  sendCommand(StdCommands::VOLTAGE);
-  const float retval = PERMIL * requestWord();
-  if (!SILENCE) printFloat(PSTR("=== 12.1.5 0x08/09 Voltage()"), retval, PERMIL_DECIMAL, Units::V());
-  return retval;
+Measurement Voltage() {
+  const word raw = rawVoltage();
+  if (!SILENCE) printRegister<VoltageRegister>(PSTR("=== 12.1.5 0x08/09 Voltage()"), raw);
+  return MEASURE_MILLIS(raw);
 }
 
 /**
@@ -167,8 +155,7 @@ float Voltage() {
   </pre>
 */
 word BatteryStatus() {
-  sendCommand(StdCommands::BATTERY_STATUS);
-  const word retval = requestWord();
+  const word retval = rawBatteryStatus();
   if (!SILENCE) {
     PGM_PRINTLN("=== 12.1.6 0x0A/0B BatteryStatus()");
     if (DEBUG) printWordBin(retval, true);
@@ -184,16 +171,7 @@ word BatteryStatus() {
     else if (0x6 == errorCode) PGM_PRINTLN("BadSize");
     else if (0x7 == errorCode) PGM_PRINTLN("UnknownError");
 
-    printFlag(retval, BatteryStatusFlags::FD());  // Bit 4: FD—Fully Discharged
-    printFlag(retval, BatteryStatusFlags::FC());  // Bit 5: FC—Fully Charged
-    printFlag(retval, BatteryStatusFlags::DSG());  // Bit 6: DSG—Discharging
-    printFlag(retval, BatteryStatusFlags::INIT());  // Bit 7: INIT—Initialization
-    printFlag(retval, BatteryStatusFlags::RTA());  // Bit 8: RTA—Remaining Time Alarm
-    printFlag(retval, BatteryStatusFlags::RCA());  // Bit 9: RCA—Remaining Capacity Alarm
-    printFlag(retval, BatteryStatusFlags::TDA());  // Bit 11: TDA—Terminate Discharge Alarm
-    printFlag(retval, BatteryStatusFlags::OTA());  // Bit 12: OTA—Overtemperature Alarm
-    printFlag(retval, BatteryStatusFlags::TCA());  // Bit 14: TCA—Terminate Charge Alarm
-    printFlag(retval, BatteryStatusFlags::OCA());  // Bit 15: OCA—Overcharged Alarm
+    printFlags(retval, &BatteryStatusFlags::TABLE, 4);  // from FD (Bit 4), the error code EC3..EC0 is printed above
   }
   return retval;
 }
@@ -203,8 +181,7 @@ word BatteryStatus() {
   @returns the measured current from the coulomb counter.
 */
 int Current() {
-  sendCommand(StdCommands::CURRENT);
-  const int retval = requestWord();
+  const int retval = rawCurrent();
   if (!SILENCE) printInteger(PSTR("=== 12.1.7 0x0C/0D Current()"), retval, Units::MA());
   return retval;
 }
@@ -214,8 +191,7 @@ int Current() {
   @returns the predicted remaining battery capacity.
 */
 word RemainingCapacity() {
-  sendCommand(StdCommands::REMAINING_CAPACITY);
-  const word retval = requestWord();
+  const word retval = rawRemainingCapacity();
   if (!SILENCE) printInteger(PSTR("=== 12.1.9 0x10/11 RemainingCapacity()"), retval, Units::MAH());
   return retval;
 }
@@ -225,8 +201,7 @@ word RemainingCapacity() {
   @returns the predicted battery capacity when fully charged.
 */
 word FullChargeCapacity() {
-  sendCommand(StdCommands::FULL_CHARGE_CAPACITY);
-  const word retval = requestWord();
+  const word retval = rawFullChargeCapacity();
   if (!SILENCE) printInteger(PSTR("=== 12.1.10 0x12/13 FullChargeCapacity()"), retval, Units::MAH());
   return retval;
 }
@@ -238,8 +213,7 @@ word FullChargeCapacity() {
   @returns a signed integer value that is the average current flow through the sense resistor.
 */
 int AverageCurrent() {
-  sendCommand(StdCommands::AVERAGE_CURRENT);
-  const word retval = requestWord();
+  const word retval = rawAverageCurrent();
   if (!SILENCE) printInteger(PSTR("=== 12.1.11 0x14/15 AverageCurrent()"), retval, Units::MA());
   return retval;
 }
@@ -249,8 +223,7 @@ int AverageCurrent() {
   @returns the number of discharge cycles the battery has experienced.
 */
 word CycleCount() {
-  sendCommand(StdCommands::CYCLE_COUNT);
-  const word retval = requestWord();
+  const word retval = rawCycleCount();
   if (!SILENCE) printInteger(PSTR("=== 12.1.22 0x2A/2B CycleCount()"), retval);
   return retval;
 }
@@ -260,8 +233,7 @@ word CycleCount() {
   @returns the predicted remaining battery capacity as a percentage of FullChargeCapacity().
 */
 word RelativeStateOfCharge() {
-  sendCommand(StdCommands::RELATIVE_STATE_OF_CHARGE);
-  const word retval = requestWord();
+  const word retval = rawRelativeStateOfCharge();
   if (!SILENCE) printInteger(PSTR("=== 12.1.23 0x2C/2D RelativeStateOfCharge()"), retval, Units::PERCENT());
   return retval;
 }
@@ -271,21 +243,19 @@ word RelativeStateOfCharge() {
   @returns the state-of-health (SOH) information of the battery in percentage of design capacity.
 */
 word StateOfHealth() {
-  sendCommand(StdCommands::STATE_OF_HEALTH);
-  const word retval = requestWord();
+  const word retval = rawStateOfHealth();
   if (!SILENCE) printInteger(PSTR("=== 12.1.24 0x2E/2F State-of-Health (SOH)"), retval, Units::PERCENT());
   return retval;
 }
 
 /**
   @brief 12.1.25 0x30/31 ChargingVoltage
-  @returns the desired charging voltage.
+  @returns the desired charging voltage, V, or mV if FIXED_POINT.
 */
-float ChargingVoltage() {
-  sendCommand(StdCommands::CHARGING_VOLTAGE);
-  const float retval = PERMIL * requestWord();
-  if (!SILENCE) printFloat(PSTR("=== 12.1.25 0x30/31 ChargingVoltage()"), retval, PERMIL_DECIMAL, Units::V());
-  return retval;
+Measurement ChargingVoltage() {
+  const word raw = rawChargingVoltage();
+  if (!SILENCE) printRegister<ChargingVoltageRegister>(PSTR("=== 12.1.25 0x30/31 ChargingVoltage()"), raw);
+  return MEASURE_MILLIS(raw);
 }
 
 /**
@@ -293,8 +263,7 @@ float ChargingVoltage() {
   @returns the desired charging current.
 */
 word ChargingCurrent() {
-  sendCommand(StdCommands::CHARGING_CURRENT);
-  const word retval = requestWord();
+  const word retval = rawChargingCurrent();
   if (!SILENCE) printInteger(PSTR("=== 12.1.26 0x32/33 ChargingCurrent()"), retval, Units::MA());
   return retval;
 }
@@ -304,8 +273,221 @@ word ChargingCurrent() {
   @returns the theoretical maximum pack capacity.
 */
 word DesignCapacity() {
-  sendCommand(StdCommands::DESIGN_CAPACITY);
-  const word retval = requestWord();
+  const word retval = rawDesignCapacity();
   if (!SILENCE) printInteger(PSTR("=== 12.1.27 0x3C/3D DesignCapacity()"), retval, Units::MAH());
   return retval;
 }
+
+/*
+  Raw accessors.
+
+  The functions return the value of the register in the native units of the device
+  and do not print anything, regardless of SILENCE and DEBUG.
+*/
+
+/**
+  @brief 12.1.1 0x00/01 ManufacturerAccessControl, no printing.
+  @returns the Control bits.
+  @see ManufacturerAccessControl()
+*/
+word rawManufacturerAccessControl() {
+  return readRaw<ManufacturerAccessControlRegister>();
+}
+
+/**
+  @brief 12.1.4 0x06/07 Temperature, no printing.
+  @returns temperature in units 0.1 K.
+  @see Temperature()
+*/
+word rawTemperature() {
+  return readRaw<TemperatureRegister>();
+}
+
+/**
+  @brief 12.1.5 0x08/09 Voltage, no printing.
+  @returns the sum of the measured cell voltages, mV.
+  @see Voltage()
+*/
+word rawVoltage() {
+  return readRaw<VoltageRegister>();
+}
+
+/**
+  @brief 12.1.6 0x0A/0B BatteryStatus, no printing.
+  @returns the BatteryStatus flags.
+  @see BatteryStatus()
+*/
+word rawBatteryStatus() {
+  return readRaw<BatteryStatusRegister>();
+}
+
+/**
+  @brief 12.1.6 0x0A/0B BatteryStatus, no printing.
+  @param retval - receives the BatteryStatus flags
+  @returns false if the command was not sent or the response is short
+  @see BatteryStatus()
+*/
+bool rawBatteryStatus(word *retval) {
+  return readRaw<BatteryStatusRegister>(retval);
+}
+
+/**
+  @brief 12.1.7 0x0C/0D Current, no printing.
+  @returns the measured current from the coulomb counter, mA.
+  @see Current()
+*/
+int rawCurrent() {
+  return (int) readNative<CurrentRegister>();
+}
+
+/**
+  @brief 12.1.9 0x10/11 RemainingCapacity, no printing.
+  @returns the predicted remaining battery capacity, mAh.
+  @see RemainingCapacity()
+*/
+word rawRemainingCapacity() {
+  return readRaw<RemainingCapacityRegister>();
+}
+
+/**
+  @brief 12.1.10 0x12/13 FullChargeCapacity, no printing.
+  @returns the predicted battery capacity when fully charged, mAh.
+  @see FullChargeCapacity()
+*/
+word rawFullChargeCapacity() {
+  return readRaw<FullChargeCapacityRegister>();
+}
+
+/**
+  @brief 12.1.11 0x14/15 AverageCurrent, no printing.
+  @returns the average current flow through the sense resistor, mA.
+  @see AverageCurrent()
+*/
+int rawAverageCurrent() {
+  return (int) readNative<AverageCurrentRegister>();
+}
+
+/**
+  @brief 12.1.22 0x2A/2B CycleCount, no printing.
+  @returns the number of discharge cycles the battery has experienced.
+  @see CycleCount()
+*/
+word rawCycleCount() {
+  return readRaw<CycleCountRegister>();
+}
+
+/**
+  @brief 12.1.23 0x2C/2D RelativeStateOfCharge, no printing.
+  @returns the predicted remaining battery capacity as a percentage of FullChargeCapacity().
+  @see RelativeStateOfCharge()
+*/
+word rawRelativeStateOfCharge() {
+  return readRaw<RelativeStateOfChargeRegister>();
+}
+
+/**
+  @brief 12.1.24 0x2E/2F State-of-Health (SOH), no printing.
+  @returns the state-of-health in percentage of design capacity.
+  @see StateOfHealth()
+*/
+word rawStateOfHealth() {
+  return readRaw<StateOfHealthRegister>();
+}
+
+/**
+  @brief 12.1.25 0x30/31 ChargingVoltage, no printing.
+  @returns the desired charging voltage, mV.
+  @see ChargingVoltage()
+*/
+word rawChargingVoltage() {
+  return readRaw<ChargingVoltageRegister>();
+}
+
+/**
+  @brief 12.1.26 0x32/33 ChargingCurrent, no printing.
+  @returns the desired charging current, mA.
+  @see ChargingCurrent()
+*/
+word rawChargingCurrent() {
+  return readRaw<ChargingCurrentRegister>();
+}
+
+/**
+  @brief 12.1.27 0x3C/3D DesignCapacity, no printing.
+  @returns the theoretical maximum pack capacity, mAh.
+  @see DesignCapacity()
+*/
+word rawDesignCapacity() {
+  return readRaw<DesignCapacityRegister>();
+}
+
+/**
+  @brief Read len bytes of the standard commands starting from the register firstReg.
+
+  The range is split into the requests that fit into the Wire buffer, see WIRE_RX_BUFFER_SIZE.
+  No printing.
+
+  @returns number of the obtained bytes, len if successful
+*/
+int readStdRange(byte firstReg, byte *buf, int len) {
+  int actual = 0;
+  while (actual < len) {
+    int chunk = len - actual;
+    if (chunk > WIRE_RX_BUFFER_SIZE) chunk = WIRE_RX_BUFFER_SIZE;
+
+    if (0 != sendCommand(firstReg + actual)) break;
+    const int obtained = rawRequestBytes(buf + actual, chunk);
+    actual += obtained;
+    if (obtained < chunk) break;
+  }
+  return actual;
+}
+
+/**
+  @brief The register word from the buffer obtained by readStdRange().
+
+  @param buf - buffer of readStdRange()
+  @param firstReg - the first register of the buffer
+  @param reg - the register to be taken, e.g. StdCommands::VOLTAGE
+*/
+word stdRangeWord(const byte *buf, byte firstReg, byte reg) {
+  const byte i = reg - firstReg;
+  return (buf[i + 1] << 8) | buf[i];
+}
+
+/**
+  @brief Read Temperature, Voltage, BatteryStatus, Current, RemainingCapacity, FullChargeCapacity,
+  AverageCurrent and RelativeStateOfCharge by the batched requests.
+
+  0x06..0x15 and 0x2C..0x2D are read by two requests,
+  or by one request 0x06..0x2D if the Wire buffer has at least 40 bytes.
+  No printing.
+
+  @returns whether all the bytes were obtained
+*/
+bool readTelemetryFrame(TelemetryFrame *frame) {
+  const byte first = StdCommands::TEMPERATURE;
+  const int rsocEnd = StdCommands::RELATIVE_STATE_OF_CHARGE + 2 - first;
+  byte buf[rsocEnd];
+
+#if WIRE_RX_BUFFER_SIZE >= 40
+  if (rsocEnd != readStdRange(first, buf, rsocEnd)) return false;
+#else
+  const int basicEnd = StdCommands::AVERAGE_CURRENT + 2 - first;
+  if (basicEnd != readStdRange(first, buf, basicEnd)) return false;
+
+  byte *rsocPtr = buf + StdCommands::RELATIVE_STATE_OF_CHARGE - first;
+  if (2 != readStdRange(StdCommands::RELATIVE_STATE_OF_CHARGE, rsocPtr, 2)) return false;
+#endif
+
+  frame->temperature = stdRangeWord(buf, first, StdCommands::TEMPERATURE);
+  frame->voltage = stdRangeWord(buf, first, StdCommands::VOLTAGE);
+  frame->batteryStatus = stdRangeWord(buf, first, StdCommands::BATTERY_STATUS);
+  frame->current = stdRangeWord(buf, first, StdCommands::CURRENT);
+  frame->remainingCapacity = stdRangeWord(buf, first, StdCommands::REMAINING_CAPACITY);
+  frame->fullChargeCapacity = stdRangeWord(buf, first, StdCommands::FULL_CHARGE_CAPACITY);
+  frame->averageCurrent = stdRangeWord(buf, first, StdCommands::AVERAGE_CURRENT);
+  frame->relativeStateOfCharge = stdRangeWord(buf, first, StdCommands::RELATIVE_STATE_OF_CHARGE);
+  frame->timestamp = millis();
+  return true;
+}
@@ -53,6 +53,7 @@
 
 #include "globals.h"
 #include "utils.h"
+#include "std_registers.h"
 
 /**
   @brief 12.1.1 0x00/01 ManufacturerAccessControl
@@ -84,14 +85,16 @@ word ManufacturerAccessControl();
   measured by the gas gauge, and is used for the gauging algorithm.
   It reports either InternalTemperature() or external thermistor temperature,
   depending on the setting of the [TEMPS] bit in Pack configuration.
+
+  The result is in °C, or in 0.1 K if FIXED_POINT.
 */
-float Temperature();
+Measurement Temperature();
 
 /**
   @brief 12.1.5 0x08/09 Voltage
-  @returns the sum of the measured cell voltages.
+  @returns the sum of the measured cell voltages, V, or mV if FIXED_POINT.
 */
-float Voltage();
+Measurement Voltage();
 
 /**
   @brief 12.1.6 0x0A/0B BatteryStatus
@@ -189,9 +192,9 @@ word StateOfHealth();
 
 /**
   @brief 12.1.25 0x30/31 ChargingVoltage
-  @returns the desired charging voltage.
+  @returns the desired charging voltage, V, or mV if FIXED_POINT.
 */
-float ChargingVoltage();
+Measurement ChargingVoltage();
 
 /**
   @brief 12.1.26 0x32/33 ChargingCurrent
@@ -204,3 +207,156 @@ word ChargingCurrent();
   @returns the theoretical maximum pack capacity.
 */
 word DesignCapacity();
+
+/*
+  Raw accessors.
+
+  The functions read the registers through their descriptors, see std_registers.h.
+
+  The functions return the value of the register in the native units of the device
+  and do not print anything, regardless of SILENCE and DEBUG.
+*/
+
+/**
+  @brief 12.1.1 0x00/01 ManufacturerAccessControl, no printing.
+  @returns the Control bits.
+  @see ManufacturerAccessControl()
+*/
+word rawManufacturerAccessControl();
+
+/**
+  @brief 12.1.4 0x06/07 Temperature, no printing.
+  @returns temperature in units 0.1 K.
+  @see Temperature()
+*/
+word rawTemperature();
+
+/**
+  @brief 12.1.5 0x08/09 Voltage, no printing.
+  @returns the sum of the measured cell voltages, mV.
+  @see Voltage()
+*/
+word rawVoltage();
+
+/**
+  @brief 12.1.6 0x0A/0B BatteryStatus, no printing.
+  @returns the BatteryStatus flags.
+  @see BatteryStatus()
+*/
+word rawBatteryStatus();
+
+/**
+  @brief 12.1.6 0x0A/0B BatteryStatus, no printing.
+  @param retval - receives the BatteryStatus flags
+  @returns false if the command was not sent or the response is short
+  @see BatteryStatus()
+*/
+bool rawBatteryStatus(word *retval);
+
+/**
+  @brief 12.1.7 0x0C/0D Current, no printing.
+  @returns the measured current from the coulomb counter, mA.
+  @see Current()
+*/
+int rawCurrent();
+
+/**
+  @brief 12.1.9 0x10/11 RemainingCapacity, no printing.
+  @returns the predicted remaining battery capacity, mAh.
+  @see RemainingCapacity()
+*/
+word rawRemainingCapacity();
+
+/**
+  @brief 12.1.10 0x12/13 FullChargeCapacity, no printing.
+  @returns the predicted battery capacity when fully charged, mAh.
+  @see FullChargeCapacity()
+*/
+word rawFullChargeCapacity();
+
+/**
+  @brief 12.1.11 0x14/15 AverageCurrent, no printing.
+  @returns the average current flow through the sense resistor, mA.
+  @see AverageCurrent()
+*/
+int rawAverageCurrent();
+
+/**
+  @brief 12.1.22 0x2A/2B CycleCount, no printing.
+  @returns the number of discharge cycles the battery has experienced.
+  @see CycleCount()
+*/
+word rawCycleCount();
+
+/**
+  @brief 12.1.23 0x2C/2D RelativeStateOfCharge, no printing.
+  @returns the predicted remaining battery capacity as a percentage of FullChargeCapacity().
+  @see RelativeStateOfCharge()
+*/
+word rawRelativeStateOfCharge();
+
+/**
+  @brief 12.1.24 0x2E/2F State-of-Health (SOH), no printing.
+  @returns the state-of-health in percentage of design capacity.
+  @see StateOfHealth()
+*/
+word rawStateOfHealth();
+
+/**
+  @brief 12.1.25 0x30/31 ChargingVoltage, no printing.
+  @returns the desired charging voltage, mV.
+  @see ChargingVoltage()
+*/
+word rawChargingVoltage();
+
+/**
+  @brief 12.1.26 0x32/33 ChargingCurrent, no printing.
+  @returns the desired charging current, mA.
+  @see ChargingCurrent()
+*/
+word rawChargingCurrent();
+
+/**
+  @brief 12.1.27 0x3C/3D DesignCapacity, no printing.
+  @returns the theoretical maximum pack capacity, mAh.
+  @see DesignCapacity()
+*/
+word rawDesignCapacity();
+
+/*
+  Batched reading.
+
+  The device increments the register pointer while reading,
+  so a contiguous range of the standard commands is read by a single request.
+*/
+
+/**
+  @brief Read len bytes of the standard commands starting from the register firstReg.
+
+  The range is split into the requests that fit into the Wire buffer, see WIRE_RX_BUFFER_SIZE.
+  No printing.
+
+  @returns number of the obtained bytes, len if successful
+*/
+int readStdRange(byte firstReg, byte *buf, int len);
+
+/**
+  @brief The register word from the buffer obtained by readStdRange().
+
+  @param buf - buffer of readStdRange()
+  @param firstReg - the first register of the buffer
+  @param reg - the register to be taken, e.g. StdCommands::VOLTAGE
+*/
+word stdRangeWord(const byte *buf, byte firstReg, byte reg);
+
+/**
+  @brief Read Temperature, Voltage, BatteryStatus, Current, RemainingCapacity, FullChargeCapacity,
+  AverageCurrent and RelativeStateOfCharge by the batched requests.
+
+  0x06..0x15 and 0x2C..0x2D are read by two requests,
+  or by one request 0x06..0x2D if the Wire buffer has at least 40 bytes.
+  No printing.
+
+  @returns whether all the bytes were obtained
+*/
+bool readTelemetryFrame(TelemetryFrame *frame);
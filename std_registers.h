@@ -0,0 +1,278 @@
+/**
+  @file std_registers.h
+
+  @brief Compile-time descriptors of the standard registers
+
+
+  Descriptor carries the command code, width, signedness, scale and units of the register.
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+
+/**
+  @brief Compile-time descriptor of the 2-byte standard register.
+
+  The value is converted into the fixed point: fixed = native * MUL + OFFSET, real = fixed / 10^DECIMALS.
+  All the parameters are constants, so the conversion is an integer multiply and add folded by the compiler,
+  no float math is involved.
+
+  @code
+    const long mV = readFixed<VoltageRegister>();  // 1.234 V -> 1234
+    printRegister<TemperatureRegister>(PSTR("Temperature"));  // "Temperature: 25.35 °C"
+  @endcode
+
+  @tparam COMMAND_ - code of the command, StdCommands
+  @tparam IS_SIGNED_ - whether the register holds a two's complement value
+  @tparam MUL_ - multiplier of the native value
+  @tparam OFFSET_ - offset of the fixed-point value
+  @tparam DECIMALS_ - number of the decimal places of the fixed-point value
+*/
+template <byte COMMAND_, bool IS_SIGNED_, long MUL_, long OFFSET_, byte DECIMALS_>
+class StdRegister {
+  public:
+    static const byte COMMAND = COMMAND_;
+    static const byte WIDTH = 2;  ///< Size of the register, bytes.
+    static const bool IS_SIGNED = IS_SIGNED_;
+    static const long MUL = MUL_;
+    static const long OFFSET = OFFSET_;
+    static const byte DECIMALS = DECIMALS_;
+
+    /**
+      @brief The register word as the value of the device, sign-extended if the register is signed.
+    */
+    static long native(word raw) {
+      return IS_SIGNED ? (long)(int16_t) raw : (long) raw;
+    }
+
+    /**
+      @brief The register word in the fixed point: real * 10^DECIMALS.
+    */
+    static long fixed(word raw) {
+      return native(raw) * MUL + OFFSET;
+    }
+};
+
+/*
+  Registers of 12.1 Standard Data Commands.
+
+  units() returns the units of the fixed-point value, NULL if the value has no units.
+*/
+
+/**
+  @brief 12.1.1 0x00/01 ManufacturerAccessControl(): Control bits
+*/
+class ManufacturerAccessControlRegister : public StdRegister<StdCommands::MANUFACTURER_ACCESS_CONTROL, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return NULL;
+    }
+};
+
+/**
+  @brief 12.1.4 0x06/07 Temperature(): 0.1 K -> 0.01 °C
+*/
+class TemperatureRegister : public StdRegister<StdCommands::TEMPERATURE, false, 10, -27315, 2> {
+  public:
+    static PGM_P units() {
+      return Units::CELSIUS();
+    }
+};
+
+/**
+  @brief 12.1.5 0x08/09 Voltage(): mV -> 0.001 V
+*/
+class VoltageRegister : public StdRegister<StdCommands::VOLTAGE, false, 1, 0, 3> {
+  public:
+    static PGM_P units() {
+      return Units::V();
+    }
+};
+
+/**
+  @brief 12.1.6 0x0A/0B BatteryStatus(): flags
+*/
+class BatteryStatusRegister : public StdRegister<StdCommands::BATTERY_STATUS, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return NULL;
+    }
+};
+
+/**
+  @brief 12.1.7 0x0C/0D Current(): mA
+*/
+class CurrentRegister : public StdRegister<StdCommands::CURRENT, true, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MA();
+    }
+};
+
+/**
+  @brief 12.1.9 0x10/11 RemainingCapacity(): mAh
+*/
+class RemainingCapacityRegister : public StdRegister<StdCommands::REMAINING_CAPACITY, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MAH();
+    }
+};
+
+/**
+  @brief 12.1.10 0x12/13 FullChargeCapacity(): mAh
+*/
+class FullChargeCapacityRegister : public StdRegister<StdCommands::FULL_CHARGE_CAPACITY, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MAH();
+    }
+};
+
+/**
+  @brief 12.1.11 0x14/15 AverageCurrent(): mA
+*/
+class AverageCurrentRegister : public StdRegister<StdCommands::AVERAGE_CURRENT, true, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MA();
+    }
+};
+
+/**
+  @brief 12.1.22 0x2A/2B CycleCount()
+*/
+class CycleCountRegister : public StdRegister<StdCommands::CYCLE_COUNT, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return NULL;
+    }
+};
+
+/**
+  @brief 12.1.23 0x2C/2D RelativeStateOfCharge(): %
+*/
+class RelativeStateOfChargeRegister : public StdRegister<StdCommands::RELATIVE_STATE_OF_CHARGE, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::PERCENT();
+    }
+};
+
+/**
+  @brief 12.1.24 0x2E/2F State-of-Health (SOH): %
+*/
+class StateOfHealthRegister : public StdRegister<StdCommands::STATE_OF_HEALTH, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::PERCENT();
+    }
+};
+
+/**
+  @brief 12.1.25 0x30/31 ChargingVoltage(): mV -> 0.001 V
+*/
+class ChargingVoltageRegister : public StdRegister<StdCommands::CHARGING_VOLTAGE, false, 1, 0, 3> {
+  public:
+    static PGM_P units() {
+      return Units::V();
+    }
+};
+
+/**
+  @brief 12.1.26 0x32/33 ChargingCurrent(): mA
+*/
+class ChargingCurrentRegister : public StdRegister<StdCommands::CHARGING_CURRENT, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MA();
+    }
+};
+
+/**
+  @brief 12.1.27 0x3C/3D DesignCapacity(): mAh
+*/
+class DesignCapacityRegister : public StdRegister<StdCommands::DESIGN_CAPACITY, false, 1, 0, 0> {
+  public:
+    static PGM_P units() {
+      return Units::MAH();
+    }
+};
+
+/**
+  @brief Read the register word without printing.
+*/
+template <class Reg>
+word readRaw() {
+  return rawReadWord(Reg::COMMAND);
+}
+
+/**
+  @brief Read the register word without printing.
+  @returns false if the command was not sent or the response is short
+*/
+template <class Reg>
+bool readRaw(word *retval) {
+  return rawReadWord(Reg::COMMAND, retval);
+}
+
+/**
+  @brief Read the register as the value of the device, sign-extended if the register is signed.
+*/
+template <class Reg>
+long readNative() {
+  return Reg::native(rawReadWord(Reg::COMMAND));
+}
+
+/**
+  @brief Read the register as the fixed-point value: real * 10^Reg::DECIMALS.
+*/
+template <class Reg>
+long readFixed() {
+  return Reg::fixed(rawReadWord(Reg::COMMAND));
+}
+
+/**
+  @brief Print the fixed-point value of the register in format: "Caption: 1.234 units"
+*/
+template <class Reg>
+void printRegister(PGM_P caption, word raw) {
+  printFixed(caption, Reg::fixed(raw), Reg::DECIMALS, Reg::units());
+}
+
+/**
+  @brief Read the register and print it in format: "Caption: 1.234 units"
+  @returns the register word
+*/
+template <class Reg>
+word printRegister(PGM_P caption) {
+  const word retval = readRaw<Reg>();
+  printRegister<Reg>(caption, retval);
+  return retval;
+}
@@ -0,0 +1,133 @@
+/**
+  @file telemetry.cpp
+
+  @brief Binary telemetry records implementation
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "telemetry.h"
+
+/**
+  Consistent Overhead Byte Stuffing: the output has no zero bytes.
+
+  The output should have room for len + len / 254 + 1 bytes.
+
+  @returns length of the output
+*/
+int _cobsEncode(const byte *data, int len, byte *retval) {
+  int code = 0;  // index of the current code byte
+  int out = 1;
+  byte distance = 1;
+
+  for (int i = 0; i < len; i++) {
+    if (0 != data[i]) {
+      retval[out++] = data[i];
+      distance++;
+    }
+    if (0 == data[i] || 0xFF == distance) {
+      retval[code] = distance;
+      code = out++;
+      distance = 1;
+    }
+  }
+  retval[code] = distance;
+  return out;
+}
+
+/**
+  @brief Encode the record and write it to the output.
+
+  @param tag - TelemetryTag or the command code of the standard register
+  @param value - raw value, len should not be greater than Telemetry::VALUE_MAX_SIZE
+  @returns whether the whole frame has been written
+*/
+bool telemetryWrite(Print &out, byte tag, const byte *value, byte len, unsigned long timestamp) {
+  if (len > Telemetry::VALUE_MAX_SIZE) return false;
+
+  byte record[Telemetry::RECORD_MAX_SIZE];
+  int n = 0;
+  record[n++] = tag;
+  for (byte i = 0; i < 4; i++) record[n++] = (timestamp >> (8 * i)) & 0xFF;
+  for (byte i = 0; i < len; i++) record[n++] = value[i];
+
+  const word crc = crc16(record, n);
+  record[n++] = crc & 0xFF;
+  record[n++] = crc >> 8;
+
+  byte frame[Telemetry::RECORD_MAX_SIZE + Telemetry::RECORD_MAX_SIZE / 254 + 2];
+  int size = _cobsEncode(record, n, frame);
+  frame[size++] = Telemetry::DELIMITER;
+
+  return size == (int) out.write(frame, size);
+}
+
+/**
+  @brief Same as telemetryWrite() with the current millis() as the timestamp.
+*/
+bool telemetryWrite(Print &out, byte tag, const byte *value, byte len) {
+  return telemetryWrite(out, tag, value, len, millis());
+}
+
+bool telemetryWriteWord(Print &out, byte tag, word value) {
+  const byte buf[] = {(byte)(value & 0xFF), (byte)(value >> 8)};
+  return telemetryWrite(out, tag, buf, sizeof(buf));
+}
+
+bool telemetryWriteLong(Print &out, byte tag, u32 value) {
+  byte buf[4];
+  for (byte i = 0; i < sizeof(buf); i++) buf[i] = (value >> (8 * i)) & 0xFF;
+  return telemetryWrite(out, tag, buf, sizeof(buf));
+}
+
+/**
+  @brief Write the HELLO record, so the host can check the version of the format.
+*/
+bool telemetryWriteHello(Print &out) {
+  const byte version = Telemetry::VERSION;
+  return telemetryWrite(out, TelemetryTag::HELLO, &version, 1);
+}
+
+/**
+  @brief Write the 4-byte status obtained by the MAC subcommand, e.g. rawSafetyStatus().
+*/
+bool telemetryWriteMac(Print &out, word MACSubcmd, u32 value) {
+  return telemetryWriteLong(out, TelemetryTag::mac(MACSubcmd), value);
+}
+
+/**
+  @brief Write the frame obtained by readTelemetryFrame(), its timestamp is used.
+*/
+bool telemetryWriteFrame(Print &out, const TelemetryFrame *frame) {
+  const word values[] = {
+    frame->temperature, frame->voltage, frame->batteryStatus, (word) frame->current,
+    frame->remainingCapacity, frame->fullChargeCapacity, (word) frame->averageCurrent, frame->relativeStateOfCharge
+  };
+
+  byte buf[sizeof(values)];
+  for (byte i = 0; i < sizeof(values) / sizeof(word); i++) {
+    buf[2 * i] = values[i] & 0xFF;
+    buf[2 * i + 1] = values[i] >> 8;
+  }
+  return telemetryWrite(out, TelemetryTag::FRAME, buf, sizeof(buf), frame->timestamp);
+}
@@ -0,0 +1,132 @@
+/**
+  @file telemetry.h
+
+  @brief Binary telemetry records headers
+
+
+  Record: tag, timestamp and raw value, protected by CRC-16 and framed with COBS.
+  The records are decoded by extras/data_flash/telemetry.py
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "std_registers.h"
+
+/**
+  @brief Format of the telemetry record.
+
+  <pre>
+  Record before the encoding:
+    [0]      tag, TelemetryTag
+    [1..4]   timestamp, millis() LE
+    [5..n]   raw value in the native units of the device, LE, 0..VALUE_MAX_SIZE bytes
+    [n+1..]  crc16() of the bytes above, LE
+  On the wire:
+    COBS(record), 0x00
+  </pre>
+*/
+class Telemetry {
+  public:
+    static const byte VERSION = 2;
+    static const byte HEADER_SIZE = 5;  ///< Tag and timestamp.
+    static const byte CRC_SIZE = 2;
+    static const byte VALUE_MAX_SIZE = 16;  ///< The largest value is TelemetryFrame without the timestamp.
+    static const byte RECORD_MAX_SIZE = HEADER_SIZE + VALUE_MAX_SIZE + CRC_SIZE;
+    static const byte DELIMITER = 0x00;  ///< End of the COBS frame.
+};
+
+/**
+  @brief Tags of the telemetry records.
+
+  Standard registers are tagged by the command code, e.g. 0x08 Voltage, the codes do not exceed 0x7D.
+  The records of the format itself are tagged above the command codes, so no register is decoded as them.
+  MAC subcommands 0x0050..0x007F are tagged by MAC_BASE | (subcommand & 0x7F), e.g. 0xD4 OperationStatus.
+*/
+class TelemetryTag {
+  public:
+    static const byte HELLO = 0x7E;  ///< value: [Telemetry::VERSION]
+    static const byte FRAME = 0x7F;  ///< value: TelemetryFrame without the timestamp, 16 bytes
+    static const byte MAC_BASE = 0x80;
+
+    static byte mac(word MACSubcmd) {
+      return MAC_BASE | (MACSubcmd & 0x7F);
+    }
+};
+
+/**
+  @brief Encode the record and write it to the output.
+
+  @param tag - TelemetryTag or the command code of the standard register
+  @param value - raw value, len should not be greater than Telemetry::VALUE_MAX_SIZE
+  @returns whether the whole frame has been written
+*/
+bool telemetryWrite(Print &out, byte tag, const byte *value, byte len, unsigned long timestamp);
+
+/**
+  @brief Same as telemetryWrite() with the current millis() as the timestamp.
+*/
+bool telemetryWrite(Print &out, byte tag, const byte *value, byte len);
+
+bool telemetryWriteWord(Print &out, byte tag, word value);
+bool telemetryWriteLong(Print &out, byte tag, u32 value);
+
+/**
+  @brief Write the HELLO record, so the host can check the version of the format.
+*/
+bool telemetryWriteHello(Print &out);
+
+/**
+  @brief Write the 4-byte status obtained by the MAC subcommand, e.g. rawSafetyStatus().
+*/
+bool telemetryWriteMac(Print &out, word MACSubcmd, u32 value);
+
+/**
+  @brief Write the frame obtained by readTelemetryFrame(), its timestamp is used.
+*/
+bool telemetryWriteFrame(Print &out, const TelemetryFrame *frame);
+
+/**
+  @brief Write the standard register, the tag is the command code of the descriptor.
+  @see std_registers.h
+*/
+template <class Reg>
+bool telemetryWriteRegister(Print &out, word raw) {
+  return telemetryWriteWord(out, Reg::COMMAND, raw);
+}
+
+/**
+  @brief Read the standard register without printing and write it.
+  @returns false if the register was not read, nothing is written then
+*/
+template <class Reg>
+bool telemetrySampleRegister(Print &out) {
+  word raw;
+  if (!readRaw<Reg>(&raw)) return false;
+  return telemetryWriteRegister<Reg>(out, raw);
+}
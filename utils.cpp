@@ -28,6 +28,20 @@
 
 #include "utils.h"
 
+/**
+  Number of the repeats of the failed transaction, besides the first attempt, 0 = no retries.
+  @see BusError
+*/
+byte BUS_RETRIES = BusError::DEFAULT_RETRIES;
+
+/**
+  Delay before the first repeat, us; doubled before every next one, up to BusError::MAX_BACKOFF_US.
+*/
+word BUS_BACKOFF_US = BusError::DEFAULT_BACKOFF_US;
+
+word _busErrors[BusError::COUNT];
+byte _lastBusError = BusError::OK;
+
 /**
   Check whether length is greater than 0.
 */
@@ -65,10 +79,126 @@ bool isAllowedRequestPayloadSize(int len) {
   return retval;
 }
 
+/**
+  Count the error of the class, BusError::OK is ignored.
+  @see BusError
+*/
+void recordBusError(byte error) {
+  if (BusError::OK == error) return;
+  if (error >= BusError::COUNT) error = BusError::OTHER;
+
+  _lastBusError = error;
+  if (_busErrors[error] < 0xFFFF) _busErrors[error]++;
+}
+
+/**
+  Number of the errors of the class since the start or resetBusErrors(), saturated at 0xFFFF.
+*/
+word busErrorCount(byte error) {
+  return error < BusError::COUNT ? _busErrors[error] : 0;
+}
+
+/**
+  Class of the last recorded error, BusError::OK if there was none since resetBusErrors().
+*/
+byte lastBusError() {
+  return _lastBusError;
+}
+
+void resetBusErrors() {
+  memset(_busErrors, 0, sizeof(_busErrors));
+  _lastBusError = BusError::OK;
+}
+
+/**
+  Print the counters of all the error classes.
+*/
+void printBusErrors() {
+  printInteger(PSTR("Bus errors, NACK addr"), _busErrors[BusError::NACK_ADDR]);
+  printInteger(PSTR("Bus errors, NACK data"), _busErrors[BusError::NACK_DATA]);
+  printInteger(PSTR("Bus errors, other write"), _busErrors[BusError::OTHER] + _busErrors[BusError::TOO_LONG]);
+  printInteger(PSTR("Bus errors, short read"), _busErrors[BusError::SHORT_READ]);
+  printInteger(PSTR("Bus errors, checksum"), _busErrors[BusError::CHECKSUM]);
+  printInteger(PSTR("Bus errors, length"), _busErrors[BusError::LENGTH]);
+  printInteger(PSTR("Bus errors, MAC timeout"), _busErrors[BusError::MAC_TIMEOUT]);
+}
+
+/**
+  Wait before the repeat of the failed transaction: BUS_BACKOFF_US * 2^attempt, up to BusError::MAX_BACKOFF_US.
+  @param attempt - 0 for the first repeat
+*/
+void busBackoff(byte attempt) {
+  unsigned long us = BUS_BACKOFF_US;
+  while (attempt-- > 0 && us < BusError::MAX_BACKOFF_US) us <<= 1;
+  if (us > BusError::MAX_BACKOFF_US) us = BusError::MAX_BACKOFF_US;
+
+  // delayMicroseconds() is accurate up to 16383 us only
+  DRIVER_DELAY(us / 1000);
+  DRIVER_DELAY_US(us % 1000);
+}
+
+/**
+  Write the register and the data to the selected gauge by the single transaction.
+  @returns status of TwoWire::endTransmission(), 0 = success
+*/
+int _busWriteOnce(byte reg, const byte *data, int len) {
+  Gauge *gauge = currentGauge();
+  INSTRUMENT_START(start);
+  int status;
+
+  if (NULL != gauge->transport) {
+    status = gauge->transport->write(gauge->transport->ctx, gauge->addr, reg, data, len);
+  } else {
+    gauge->wire->beginTransmission(gauge->addr);
+    gauge->wire->write(reg);
+    if (len > 0) gauge->wire->write(data, len);
+    status = gauge->wire->endTransmission();
+  }
+
+  INSTRUMENT_WRITE(reg, data, len, start);
+  return status;
+}
+
+/**
+  Class of the result of TwoWire::endTransmission(): 5 (timeout on ESP32, AVR) and other codes are BusError::OTHER.
+*/
+byte _writeError(int status) {
+  return status > BusError::OTHER ? BusError::OTHER : status;
+}
+
+/**
+  Write the register and the data, the failed write is repeated up to BUS_RETRIES times.
+
+  NACK means that the device has not accepted the write, so the repeat is safe.
+  BusError::TOO_LONG is not repeated, the result would be the same.
+
+  @returns status of TwoWire::endTransmission() of the last attempt, 0 = success
+*/
+int _busWrite(byte reg, const byte *data, int len) {
+  int status = _busWriteOnce(reg, data, len);
+
+  for (byte attempt = 0; BusError::OK != status && BusError::TOO_LONG != status && attempt < BUS_RETRIES; attempt++) {
+    recordBusError(_writeError(status));
+    busBackoff(attempt);
+    status = _busWriteOnce(reg, data, len);
+  }
+
+  INSTRUMENT_WRITE_END(reg);
+  recordBusError(_writeError(status));
+  return status;
+}
+
 int sendCommand(byte command) {
-  Wire.beginTransmission(DEVICE_ADDR);
-  Wire.write(command);
-  return Wire.endTransmission();
+  return _busWrite(command, NULL, 0);
+}
+
+/**
+  Single attempt of sendCommand(), the failure is not counted.
+*/
+int sendCommandOnce(byte command) {
+  const int status = _busWriteOnce(command, NULL, 0);
+  INSTRUMENT_WRITE_END(command);
+  return status;
 }
 
 /**
@@ -85,10 +215,7 @@ int sendCommand(byte reg, word command) {
     command & 0xFF,  // 0x..XX
     (command >> 8) & 0xFF  // 0xXX..
   };
-  Wire.beginTransmission(DEVICE_ADDR);
-  Wire.write(reg);
-  Wire.write(buf, sizeof(buf));
-  return Wire.endTransmission();
+  return _busWrite(reg, buf, sizeof(buf));
 }
 
 /**
@@ -99,37 +226,55 @@ int sendCommand(byte reg, word command) {
   The length should not be greater than 32 and less than 1.
 */
 int sendData(byte reg, byte *data, int len) {
-  Wire.beginTransmission(DEVICE_ADDR);
-  Wire.write(reg);
-  Wire.write(data, len);
-  return Wire.endTransmission();
+  return _busWrite(reg, data, len);
 }
 
 /**
-  Request the device for 36 bytes per multiple requests using the Block Protocol.
+  Request the device for 36 bytes using the Block Protocol.
   - The first 2 bytes represent the requested address.
   - 32 bytes contain data.
   - 1 byte is allocated for the checksum.
   - 1 byte denotes the total length.
+
+  The block is read by a single request if BLOCK_SINGLE_READ, otherwise by three requests.
 */
 int requestBlock(byte *buf) {
-  int actual = 0;
+#if BLOCK_SINGLE_READ
+  return rawRequestBytes(buf, BlockProtocol::RESPONSE_MAX_SIZE);
+#else
+  const int actual = rawRequestBytes(buf, BlockProtocol::ADDR_SIZE);
+  return actual + requestBlockData(buf);
+#endif
+}
 
-  byte *bufPtr = buf;
-  actual += requestBytes(bufPtr, BlockProtocol::ADDR_SIZE);
+/**
+  Request the rest of the block when the 2 bytes of the address have already been read.
+  - 32 bytes of data are placed from the BlockProtocol::DATA_INDEX.
+  - 1 byte is allocated for the checksum.
+  - 1 byte denotes the total length.
 
-  bufPtr += BlockProtocol::ADDR_SIZE;
-  actual += requestBytes(bufPtr, BlockProtocol::PAYLOAD_MAX_SIZE);
+  The rest is read by a single request if BLOCK_SINGLE_READ, otherwise by two requests.
+*/
+int requestBlockData(byte *buf) {
+  byte *bufPtr = buf + BlockProtocol::DATA_INDEX;
+
+#if BLOCK_SINGLE_READ
+  return rawRequestBytes(bufPtr, BlockProtocol::RESPONSE_MAX_SIZE - BlockProtocol::DATA_INDEX);
+#else
+  int actual = 0;
+  actual += rawRequestBytes(bufPtr, BlockProtocol::PAYLOAD_MAX_SIZE);
 
   bufPtr += BlockProtocol::PAYLOAD_MAX_SIZE;
-  actual += requestBytes(bufPtr, BlockProtocol::CHECKSUM_AND_LENGTH_SIZE);
+  actual += rawRequestBytes(bufPtr, BlockProtocol::CHECKSUM_AND_LENGTH_SIZE);
 
   return actual;
+#endif
 }
 
 byte requestByte() {
-  Wire.requestFrom(DEVICE_ADDR, 1);
-  return Wire.available() ? Wire.read() : 0;
+  byte retval = 0;
+  rawRequestBytes(&retval, 1);
+  return retval;
 }
 
 /**
@@ -138,16 +283,61 @@ byte requestByte() {
   because it cannot response more.
 */
 int requestBytes(byte *buf, int len) {
-  if (!_isAllowedRequestSize(len)) return;
+  if (!_isAllowedRequestSize(len)) return 0;
+  return rawRequestBytes(buf, len);
+}
+
+/**
+  Request the device for len bytes per single request without checking of the length and printing.
+  The length must be in the range [1; WIRE_RX_BUFFER_SIZE].
+*/
+int rawRequestBytes(byte *buf, int len) {
+  const int actual = rawRequestBytesUncounted(buf, len);
+  if (actual < len) recordBusError(BusError::SHORT_READ);
+  return actual;
+}
 
+/**
+  Same as rawRequestBytes(), but the short read is not counted.
+*/
+int rawRequestBytesUncounted(byte *buf, int len) {
+  Gauge *gauge = currentGauge();
+  INSTRUMENT_START(start);
   int actual = 0;
 
-  Wire.requestFrom(DEVICE_ADDR, len);
-  while (Wire.available() && actual < len) buf[actual++] = Wire.read();
+  if (NULL != gauge->transport) {
+    actual = gauge->transport->read(gauge->transport->ctx, gauge->addr, buf, len);
+  } else {
+    TwoWire *wire = gauge->wire;
+    wire->requestFrom((int) gauge->addr, len);
+    while (wire->available() && actual < len) buf[actual++] = wire->read();
+  }
 
+  INSTRUMENT_READ(actual, start);
   return actual;
 }
 
+/**
+  Read word from the register in Little Endian and return as normal word, without printing.
+*/
+word rawReadWord(byte reg) {
+  byte buf[] = {0, 0};
+  sendCommand(reg);
+  rawRequestBytes(buf, sizeof(buf));
+  return (buf[1] << 8) | buf[0];
+}
+
+/**
+  Read word from the register in Little Endian, without printing.
+  @returns false if the command was not sent or the response is short, retval is not changed then
+*/
+bool rawReadWord(byte reg, word *retval) {
+  byte buf[] = {0, 0};
+  if (0 != sendCommand(reg) || sizeof(buf) != rawRequestBytes(buf, sizeof(buf))) return false;
+  *retval = (buf[1] << 8) | buf[0];
+  return true;
+}
+
 /**
   Read word from the Device in Little Endian and return as normal word.
 
@@ -176,29 +366,78 @@ byte checksum(byte *data, byte len) {
   return ~sum;
 }
 
+void printInvalidData() {
+  PGM_PRINTLN("The device responded with invalid data.");
+}
+
 /**
-  Validate the data via checksum: the sum of the data bytes and the checksum should equal a full byte.
-  Length of the data array according to the Block Protocol should be equal 36.
-  The last two bytes should represent the checksum and the total length.
+  Sum of the checksum and the bytes covered by it.
 */
-bool validate(byte *data) {
+byte _blockSum(byte *data) {
   byte sum = data[BlockProtocol::CHECKSUM_INDEX];
 
   const byte len = data[BlockProtocol::LENGTH_INDEX];
-  for (int i = 0; i < len - 2; i++) sum += data[i];  // exclude length byte itself
+  for (int i = 0; i < len - 2 && i < BlockProtocol::CHECKSUM_INDEX; i++) sum += data[i];  // exclude length byte itself
 
-  const bool retval = (sum & 0xFF);
-  if (!retval) PGM_PRINTLN("The device responded with invalid data.");
+  return sum;
+}
+
+/**
+  Validate the data via checksum: the sum of the data bytes and the checksum should equal a full byte.
+  Length of the data array according to the Block Protocol should be equal 36.
+  The last two bytes should represent the checksum and the total length.
+*/
+bool validate(byte *data) {
+  const bool retval = isBlockValid(data);
+  if (!retval) printInvalidData();
 
   if (DEBUG) {
     printInteger(PSTR("$Checksum"), data[BlockProtocol::CHECKSUM_INDEX]);
     printInteger(PSTR("$Length"), data[BlockProtocol::LENGTH_INDEX]);
-    printInteger(PSTR("$Result"), sum);
+    printInteger(PSTR("$Result"), _blockSum(data));
   }
 
   return retval;
 }
 
+/**
+  Check the block via checksum without printing.
+
+  The sum of the address and data bytes and the checksum should equal a full byte.
+
+  @see validate()
+*/
+bool isBlockValid(byte *data) {
+  return 0xFF == _blockSum(data);
+}
+
+/**
+  Class of the error of the response block obtained by count bytes, without recording and printing.
+
+  @returns BusError::SHORT_READ, BusError::LENGTH, BusError::CHECKSUM or BusError::OK
+*/
+byte blockError(byte *data, int count) {
+  if (count < BlockProtocol::RESPONSE_MAX_SIZE) return BusError::SHORT_READ;
+
+  const byte len = data[BlockProtocol::LENGTH_INDEX];
+  if (len < BlockProtocol::SERVICE_SIZE || len > BlockProtocol::RESPONSE_MAX_SIZE) return BusError::LENGTH;
+
+  return isBlockValid(data) ? BusError::OK : BusError::CHECKSUM;
+}
+
+/**
+  CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection.
+
+  Pass the previous result as crc to continue the calculation over several buffers.
+*/
+word crc16(const byte *data, int len, word crc) {
+  for (int i = 0; i < len; i++) {
+    crc ^= (word)data[i] << 8;
+    for (int j = 0; j < 8; j++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
 /**
   Compose the word value from the two bytes of the buffer.
 
@@ -249,7 +488,7 @@ u32 composeDoubleWord(byte *buf) {
 u32 composeValue(byte *buf, int from, int till) {
   if (till <= from) {
     PGM_PRINTLN("~ Error: Invalid range to compose value. Till param should be greater than From param.");
-    return;
+    return 0;
   }
 
   u32 retval = 0;
@@ -260,8 +499,28 @@ u32 composeValue(byte *buf, int from, int till) {
   return retval;
 }
 
+/**
+  Power in mW by the voltage in mV and the current in mA, 32-bit integer math:
+  powerMw(7612, -1500) -> -11418
+
+  65535 mV * -32768 mA still fits into long.
+*/
+long powerMw(word mV, int mA) {
+  return (long) mV * mA / 1000;
+}
+
+/**
+  Energy in cWh by the capacity in mAh and the voltage in mV, 32-bit integer math:
+  energyCwh(3000, 7200) -> 2160, see learningCycleInit()
+*/
+u32 energyCwh(word mAh, word mV) {
+  return (u32) mAh * mV / 10000;
+}
+
 /**
   Read string from PROGMEM and return as String in RAM.
+
+  @warning The String is allocated in the heap, use PGM_FLASH() for printing instead.
 */
 String stringFromProgmem(PGM_P stringPtr) {
   const char buf[strlen_P(stringPtr) + 1];
@@ -269,6 +528,64 @@ String stringFromProgmem(PGM_P stringPtr) {
   return String(buf);
 }
 
+/**
+  Print the string from PROGMEM without copying into RAM.
+*/
+void printPgm(PGM_P pgmPtr, bool newLine) {
+  Serial.print(PGM_FLASH(pgmPtr));
+  if (newLine) Serial.println();
+}
+
+#if defined(__AVR__)
+extern char __heap_start;
+extern char *__brkval;
+
+char *_heapEnd() {
+  return NULL != __brkval ? __brkval : &__heap_start;
+}
+#endif
+
+/**
+  Free RAM between the heap and the stack, bytes.
+  @returns -1 if not supported by the platform, AVR only
+*/
+int freeMemory() {
+#if defined(__AVR__)
+  char top;
+  return &top - _heapEnd();
+#else
+  return -1;
+#endif
+}
+
+/**
+  Fill the free RAM between the heap and the stack with STACK_PAINT_VALUE,
+  so the deepest use of the stack can be found later by stackHighWater().
+
+  Should be called once at the beginning of setup(). AVR only.
+*/
+void paintStack() {
+#if defined(__AVR__)
+  char top;
+  for (char *p = _heapEnd(); p < &top - 32; p++) *p = STACK_PAINT_VALUE;  // keep the frame of this function
+#endif
+}
+
+/**
+  Number of the painted bytes that have never been overwritten by the stack or the heap since paintStack().
+  @returns -1 if not supported by the platform, AVR only
+*/
+int stackHighWater() {
+#if defined(__AVR__)
+  char top;
+  int retval = 0;
+  for (const char *p = _heapEnd(); p < &top && STACK_PAINT_VALUE == (byte) *p; p++) retval++;
+  return retval;
+#else
+  return -1;
+#endif
+}
+
 /**
   Print value in the HEX format with leading 0x and zero if necessary.
 */
@@ -340,13 +657,11 @@ void printByteBin(byte val, bool newLine) {
 }
 
 void __printPgm(PGM_P pgmPtr) {
-  const String s = stringFromProgmem(pgmPtr);
-  Serial.print(s);
+  Serial.print(PGM_FLASH(pgmPtr));
 }
 
 void __printlnPgm(PGM_P pgmPtr) {
-  const String s = stringFromProgmem(pgmPtr);
-  Serial.println(s);
+  Serial.println(PGM_FLASH(pgmPtr));
 }
 
 void __printCaption(PGM_P caption) {
@@ -390,21 +705,73 @@ void printFloat(PGM_P caption, float value, int format, PGM_P (*unitsFn)()) {
   printFloat(caption, value, format, (*unitsFn)());
 }
 
+/**
+  Print the fixed-point value, value = real * 10^decimals, without the float math:
+  printFixed(-1234, 3, Units::V()) -> "-1.234 V"
+
+  Units can be NULL.
+*/
+void printFixed(long value, byte decimals, PGM_P units, bool newLine) {
+  if (value < 0) {
+    Serial.print('-');
+    value = -value;
+  }
+
+  unsigned long divider = 1;
+  for (byte i = 0; i < decimals; i++) divider *= 10;
+  Serial.print((unsigned long) value / divider);
+
+  if (decimals > 0) {
+    Serial.print('.');
+    const unsigned long fraction = (unsigned long) value % divider;
+    for (unsigned long d = divider / 10; d > 1 && fraction < d; d /= 10) Serial.print('0');  // leading zeros
+    Serial.print(fraction);
+  }
+
+  if (NULL != units) __printUnits(units, newLine);
+  else if (newLine) Serial.println();
+}
+
+/**
+  Print the fixed-point value in format: "Caption: 1.234 units"
+*/
+void printFixed(PGM_P caption, long value, byte decimals, PGM_P units) {
+  __printCaption(caption);
+  printFixed(value, decimals, units, true);
+}
+
 /**
   Print the integer value as a float divided by 1000 with 3 decimal places in format:
   "Caption: 65.536"
 */
 void printPremil(PGM_P caption, int value, PGM_P units) {
-  const float fValue = PERMIL * value;
-  printFloat(caption, fValue, PERMIL_DECIMAL, units);
+  printFixed(caption, value, PERMIL_DECIMAL, units);
 }
 
 void printPremil(PGM_P caption, int value, PGM_P (*unitsFn)()) {
   printPremil(caption, value, (*unitsFn)());
 }
 
+/**
+  Print the value of MEASURE_MILLIS() with 3 decimal places in format: "Caption: 7.612 V",
+  the float is not involved if FIXED_POINT.
+*/
+void printMeasurement(PGM_P caption, Measurement value, PGM_P units) {
+#if FIXED_POINT
+  printFixed(caption, value, PERMIL_DECIMAL, units);
+#else
+  printFloat(caption, value, PERMIL_DECIMAL, units);
+#endif
+}
+
 void printFlag(PGM_P caption, u32 flags, int n) {
-  __printCaption(caption);
+  if (NULL != caption) {
+    __printCaption(caption);
+  } else {
+    PGM_PRINT("Bit ");
+    Serial.print(n);
+    PGM_PRINT(": ");
+  }
   Serial.println(bitRead(flags, n));
 }
 
@@ -422,7 +789,21 @@ void printFlag(PGM_P caption, u32 flags, Flag flag) {
 }
 
 void printFlag(u32 flags, Flag flag) {
-  printFlag(flag.caption, flags, flag.n);
+  printFlag(flagCaption(flag), flags, flag.n);
+}
+
+/**
+  Print the values of the flags of the table, starting from the position "first".
+  One pass over the table in PROGMEM, the captions are not searched for every flag.
+*/
+void printFlags(u32 flags, const FlagTable *table, byte first) {
+  const byte *bits = (const byte *) pgm_read_ptr(&table->bits);
+  PGM_P caption = (PGM_P) pgm_read_ptr(&table->captions);
+  const byte count = pgm_read_byte(&table->count);
+  for (byte i = 0; i < count; i++) {
+    if (i >= first) printFlag(caption, flags, pgm_read_byte(&bits[i]));
+    if (NULL != caption) caption += strlen_P(caption) + 1;
+  }
 }
 
 void printWordHex(PGM_P caption, word val, bool newLine) {
@@ -32,20 +32,81 @@
 #include <Wire.h>
 
 #include "globals.h"
+#include "gauge.h"
+#include "instrumentation.h"
 
 #define KELVIN_TO_CELSIUS(k) (k - 273.15)
 
+/*
+  Measurement of the native value of the device, see FIXED_POINT:
+  - MEASURE_MILLIS: mV -> V, or mV if FIXED_POINT;
+  - MEASURE_DECIKELVIN: 0.1 K -> °C, or 0.1 K if FIXED_POINT.
+*/
+#if FIXED_POINT
+#define MEASURE_MILLIS(raw) ((Measurement) (raw))
+#define MEASURE_DECIKELVIN(raw) ((Measurement) (raw))
+#else
+#define MEASURE_MILLIS(raw) (PERMIL * (raw))
+#define MEASURE_DECIKELVIN(raw) KELVIN_TO_CELSIUS(DECIPART * (raw))
+#endif
+
+/**
+  Size of the receive buffer of the Wire library, detected at compile time.
+
+  Can be overridden with the build flag: -DWIRE_RX_BUFFER_SIZE=...
+*/
+#ifndef WIRE_RX_BUFFER_SIZE
+#if defined(I2C_BUFFER_LENGTH)  // ESP32
+#define WIRE_RX_BUFFER_SIZE I2C_BUFFER_LENGTH
+#elif defined(WIRE_BUFFER_SIZE)  // RP2040 (arduino-pico)
+#define WIRE_RX_BUFFER_SIZE WIRE_BUFFER_SIZE
+#elif defined(ARDUINO_ARCH_SAMD)  // RingBufferN<256>, no macro
+#define WIRE_RX_BUFFER_SIZE 256
+#elif defined(BUFFER_LENGTH)  // AVR, ESP8266
+#define WIRE_RX_BUFFER_SIZE BUFFER_LENGTH
+#else
+#define WIRE_RX_BUFFER_SIZE 32
+#endif
+#endif
+
+/**
+  1 = the whole 36-byte response of the Block Protocol is read by a single request,
+  0 = the response is read by parts not bigger than 32 bytes.
+
+  BlockProtocol::RESPONSE_MAX_SIZE cannot be used by the preprocessor, so the size is literal.
+*/
+#if WIRE_RX_BUFFER_SIZE >= 36
+#define BLOCK_SINGLE_READ 1
+#else
+#define BLOCK_SINGLE_READ 0
+#endif
+
+/**
+  Pointer to the string in the program memory as the argument for Print::print(),
+  the string is printed directly from the flash without copying into RAM.
+*/
+#define PGM_FLASH(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+
+/**
+  Put defined string into program memory and print it directly from the program memory.
+*/
+#define PGM_PRINT(s) Serial.print(F(s))
+
+/**
+  Put defined string into program memory and print it directly from the program memory.
+*/
+#define PGM_PRINTLN(s) Serial.println(F(s))
+
 /**
-  Put defined string into program memory,
-  in the runtime read the string from the program memory and print it.
+  Number of the repeats of the failed transaction, besides the first attempt, 0 = no retries.
+  @see BusError
 */
-#define PGM_PRINT(s) Serial.print(stringFromProgmem(PSTR(s)))
+extern byte BUS_RETRIES;
 
 /**
-  Put defined string into program memory,
-  in the runtime read the string from the program memory and print it.
+  Delay before the first repeat, us; doubled before every next one, up to BusError::MAX_BACKOFF_US.
 */
-#define PGM_PRINTLN(s) Serial.println(stringFromProgmem(PSTR(s)))
+extern word BUS_BACKOFF_US;
 
 /**
   Check whether length is greater than 0 and lower that 32.
@@ -54,8 +115,52 @@
 */
 bool isAllowedRequestPayloadSize(int len);
 
+/**
+  Count the error of the class, BusError::OK is ignored.
+  @see BusError
+*/
+void recordBusError(byte error);
+
+/**
+  Number of the errors of the class since the start or resetBusErrors(), saturated at 0xFFFF.
+*/
+word busErrorCount(byte error);
+
+/**
+  Class of the last recorded error, BusError::OK if there was none since resetBusErrors().
+*/
+byte lastBusError();
+
+void resetBusErrors();
+
+/**
+  Print the counters of all the error classes.
+*/
+void printBusErrors();
+
+/**
+  Wait before the repeat of the failed transaction: BUS_BACKOFF_US * 2^attempt, up to BusError::MAX_BACKOFF_US.
+  @param attempt - 0 for the first repeat
+*/
+void busBackoff(byte attempt);
+
+/**
+  Set the register pointer of the device.
+
+  The write errors are repeated up to BUS_RETRIES times.
+
+  @returns status of TwoWire::endTransmission() of the last attempt, 0 = success
+*/
 int sendCommand(byte command);
 
+/**
+  Same as sendCommand(), but by the single attempt, and the failure is not counted.
+  Used by the polling, where the busy device is expected.
+
+  @returns status of TwoWire::endTransmission(), 0 = success
+*/
+int sendCommandOnce(byte command);
+
 /**
   Send word command in Little Endian to the register.
 
@@ -64,6 +169,10 @@ int sendCommand(byte command);
 
   0x4321 to REG:
   > write: [ REG, 0x21, 0x43 ]
+
+  The write errors are repeated up to BUS_RETRIES times.
+
+  @returns status of TwoWire::endTransmission() of the last attempt, 0 = success
 */
 int sendCommand(byte reg, word command);
 
@@ -73,18 +182,34 @@ int sendCommand(byte reg, word command);
   Order of the bytes in the data array should be prepared to sending.
 
   The length should not be greater than 32 and less than 1.
+
+  The write errors are repeated up to BUS_RETRIES times.
+
+  @returns status of TwoWire::endTransmission() of the last attempt, 0 = success
 */
 int sendData(byte reg, byte *data, int len);
 
 /**
-  Request the device for 36 bytes per multiple requests using the Block Protocol.
+  Request the device for 36 bytes using the Block Protocol.
   - The first 2 bytes represent the requested address.
   - 32 bytes contain data.
   - 1 byte is allocated for the checksum.
   - 1 byte denotes the total length.
+
+  The block is read by a single request if BLOCK_SINGLE_READ, otherwise by three requests.
 */
 int requestBlock(byte *buf);
 
+/**
+  Request the rest of the block when the 2 bytes of the address have already been read.
+  - 32 bytes of data are placed from the BlockProtocol::DATA_INDEX.
+  - 1 byte is allocated for the checksum.
+  - 1 byte denotes the total length.
+
+  The rest is read by a single request if BLOCK_SINGLE_READ, otherwise by two requests.
+*/
+int requestBlockData(byte *buf);
+
 byte requestByte();
 
 /**
@@ -95,6 +220,32 @@ byte requestByte();
 */
 int requestBytes(byte *buf, int len);
 
+/**
+  Request the device for len bytes per single request without checking of the length and printing.
+  The length must be in the range [1; WIRE_RX_BUFFER_SIZE].
+
+  The short read is counted as BusError::SHORT_READ, but not repeated:
+  the register pointer of the device has already moved.
+*/
+int rawRequestBytes(byte *buf, int len);
+
+/**
+  Same as rawRequestBytes(), but the short read is not counted.
+  Used by the polling, where the busy device is expected.
+*/
+int rawRequestBytesUncounted(byte *buf, int len);
+
+/**
+  Read word from the register in Little Endian and return as normal word, without printing.
+*/
+word rawReadWord(byte reg);
+
+/**
+  Read word from the register in Little Endian, without printing.
+  @returns false if the command was not sent or the response is short, retval is not changed then
+*/
+bool rawReadWord(byte reg, word *retval);
+
 /**
   Read word from the Device in Little Endian and return as normal word.
 
@@ -124,6 +275,31 @@ byte checksum(byte *data, byte len);
 */
 bool validate(byte *data);
 
+void printInvalidData();
+
+/**
+  Check the block via checksum without printing.
+
+  The sum of the address and data bytes and the checksum should equal a full byte.
+
+  @see validate()
+*/
+bool isBlockValid(byte *data);
+
+/**
+  Class of the error of the response block obtained by count bytes, without recording and printing.
+
+  @returns BusError::SHORT_READ, BusError::LENGTH, BusError::CHECKSUM or BusError::OK
+*/
+byte blockError(byte *data, int count);
+
+/**
+  CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xFFFF, no reflection.
+
+  Pass the previous result as crc to continue the calculation over several buffers.
+*/
+word crc16(const byte *data, int len, word crc = 0xFFFF);
+
 /**
   Compose the word value from the two bytes of the buffer.
 
@@ -164,11 +340,55 @@ u32 composeDoubleWord(byte *buf);
 */
 u32 composeValue(byte *buf, int from, int till);
 
+/**
+  Power in mW by the voltage in mV and the current in mA, 32-bit integer math:
+  powerMw(7612, -1500) -> -11418
+*/
+long powerMw(word mV, int mA);
+
+/**
+  Energy in cWh by the capacity in mAh and the voltage in mV, 32-bit integer math:
+  energyCwh(3000, 7200) -> 2160, see learningCycleInit()
+*/
+u32 energyCwh(word mAh, word mV);
+
 /**
   Read string from PROGMEM and return as String in RAM.
+
+  @warning The String is allocated in the heap, use PGM_FLASH() for printing instead.
 */
 String stringFromProgmem(PGM_P stringPtr);
 
+/**
+  Print the string from PROGMEM without copying into RAM.
+*/
+void printPgm(PGM_P pgmPtr, bool newLine = false);
+
+/**
+  Value of the unused stack bytes, see paintStack().
+*/
+#define STACK_PAINT_VALUE 0xC5
+
+/**
+  Free RAM between the heap and the stack, bytes.
+  @returns -1 if not supported by the platform, AVR only
+*/
+int freeMemory();
+
+/**
+  Fill the free RAM between the heap and the stack with STACK_PAINT_VALUE,
+  so the deepest use of the stack can be found later by stackHighWater().
+
+  Should be called once at the beginning of setup(). AVR only.
+*/
+void paintStack();
+
+/**
+  Number of the painted bytes that have never been overwritten by the stack or the heap since paintStack().
+  @returns -1 if not supported by the platform, AVR only
+*/
+int stackHighWater();
+
 /**
   Print value in binary format with leading zeros.
 */
@@ -217,6 +437,19 @@ void printFloat(float value, int format, PGM_P units, bool newLine = false);
 void printFloat(PGM_P caption, float value, int format, PGM_P units);
 void printFloat(PGM_P caption, float value, int format, PGM_P (*unitsFn)());
 
+/**
+  Print the fixed-point value, value = real * 10^decimals, without the float math:
+  printFixed(-1234, 3, Units::V()) -> "-1.234 V"
+
+  Units can be NULL.
+*/
+void printFixed(long value, byte decimals, PGM_P units, bool newLine = false);
+
+/**
+  Print the fixed-point value in format: "Caption: 1.234 units"
+*/
+void printFixed(PGM_P caption, long value, byte decimals, PGM_P units);
+
 /**
   Print the integer value as a float divided by 1000 with 3 decimal places in format:
   "Caption: 65.536"
@@ -225,7 +458,13 @@ void printPremil(PGM_P caption, int value, PGM_P units);
 void printPremil(PGM_P caption, int value, PGM_P (*unitsFn)());
 
 /**
-  Print the Flag number with the caption.
+  Print the value of MEASURE_MILLIS() with 3 decimal places in format: "Caption: 7.612 V",
+  the float is not involved if FIXED_POINT.
+*/
+void printMeasurement(PGM_P caption, Measurement value, PGM_P units);
+
+/**
+  Print the Flag number with the caption, in format "Bit 12: 1" if the caption is NULL.
 */
 void printFlag(PGM_P caption, u32 flags, int n);
 
@@ -244,3 +483,9 @@ void printFlag(PGM_P caption, u32 flags, Flag flag);
   Print the Flag value, caption is taken from the Flag definition.
 */
 void printFlag(u32 flags, Flag flag);
+
+/**
+  Print the values of the flags of the table, starting from the position "first".
+  One pass over the table in PROGMEM, the captions are not searched for every flag.
+*/
+void printFlags(u32 flags, const FlagTable *table, byte first = 0);
@@ -0,0 +1,217 @@
+/**
+  @file warm_start.cpp
+
+  @brief Warm start: the driver state kept in EEPROM over the MCU reset
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "warm_start.h"
+
+#if WARM_START
+#include <EEPROM.h>
+#endif
+
+/**
+  The snapshot as it is stored in EEPROM, see WarmStart.
+*/
+struct _WarmStartImage {
+  byte version;
+  byte size;
+  WarmStartIdentity identity;
+  byte shadowLen;
+  byte shadow[DF_SHADOW::SAVED_SIZE];
+  byte samplerCount;
+  unsigned long samplerPeriods[Sampler::MAX_TASKS];
+  word crc;
+};
+
+WarmStartIdentity _warmStartIdentity;
+bool _isWarmStartIdentityKnown = false;
+
+#if WARM_START
+
+void _eepromRead(int addr, byte *data, int len) {
+#if defined(ESP32) || defined(ESP8266)
+  EEPROM.begin(addr + len);
+#endif
+  for (int i = 0; i < len; i++) data[i] = EEPROM.read(addr + i);
+}
+
+void _eepromWrite(int addr, const byte *data, int len) {
+#if defined(ESP32) || defined(ESP8266)
+  EEPROM.begin(addr + len);
+  for (int i = 0; i < len; i++) EEPROM.write(addr + i, data[i]);
+  EEPROM.commit();  // the flash is written only if some byte has changed
+#else
+  for (int i = 0; i < len; i++) EEPROM.update(addr + i, data[i]);  // only the changed bytes are written
+#endif
+}
+
+#else
+
+void _eepromRead(int, byte *data, int len) {
+  memset(data, 0, len);
+}
+
+void _eepromWrite(int, const byte *, int) {}
+
+#endif
+
+/**
+  Request the Manufacture Date and the Serial Number by the single Data Flash read.
+*/
+bool _warmStartReadPackKey(word *manufactureDate, word *serialNumber) {
+  byte buf[4];
+  if (!rawDfReadBytes(DF_ADDR::MANUFACTURE_DATE, buf, sizeof(buf))) return false;
+
+  *manufactureDate = composeWord(buf);
+  *serialNumber = composeWord(buf, DF_ADDR::SERIAL_NUMBER - DF_ADDR::MANUFACTURE_DATE);
+  return true;
+}
+
+/**
+  Request the identity from the device without printing.
+*/
+bool _warmStartReadIdentity(WarmStartIdentity *identity) {
+  memset(identity, 0, sizeof(WarmStartIdentity));
+
+  byte buf[BlockProtocol::RESPONSE_MAX_SIZE], len = 0;
+  if (!rawAltManufacturerAccess(AltManufacturerCommands::DEVICE_TYPE, buf, &len) || len < 2) return false;
+  identity->deviceType = composeWord(buf);
+
+  if (!rawAltManufacturerAccess(AltManufacturerCommands::CHEMICAL_ID, buf, &len) || len < 2) return false;
+  identity->chemicalId = composeWord(buf);
+
+  if (!rawAltManufacturerAccess(AltManufacturerCommands::FIRMWARE_VERSION, buf, &len)) return false;
+  memcpy(identity->firmwareVersion, buf, len < WarmStart::FIRMWARE_VERSION_SIZE ? len : WarmStart::FIRMWARE_VERSION_SIZE);
+
+  if (dfReadString(DF_ADDR::DEVICE_NAME, identity->deviceName, sizeof(identity->deviceName)) < 0) return false;
+
+  return _warmStartReadPackKey(&identity->manufactureDate, &identity->serialNumber);
+}
+
+/**
+  @brief Save the identity, the DF shadow copy and the sampler periods of the current gauge into EEPROM.
+
+  The identity is requested from the device if it is not known yet.
+  Should be called after the cold start has read the cached Data Flash parameters
+  and after every change of them or of the sample periods. Only the changed EEPROM bytes are written.
+
+  @returns false if the identity could not be obtained or WARM_START is disabled
+*/
+bool warmStartSave(int eepromAddr) {
+  if (!WARM_START) return false;
+
+  if (!_isWarmStartIdentityKnown) {
+    if (!_warmStartReadIdentity(&_warmStartIdentity)) return false;
+    _isWarmStartIdentityKnown = true;
+  }
+
+  _WarmStartImage image;
+  memset(&image, 0, sizeof(image));  // the padding is covered by the CRC too
+  image.version = WarmStart::VERSION;
+  image.size = sizeof(image);
+  image.identity = _warmStartIdentity;
+  image.shadowLen = dfShadowSave(image.shadow, sizeof(image.shadow));
+  image.samplerCount = samplerCount();
+  for (byte i = 0; i < image.samplerCount; i++) image.samplerPeriods[i] = samplerPeriod(i);
+  image.crc = crc16((const byte *) &image, offsetof(_WarmStartImage, crc));
+
+  _eepromWrite(eepromAddr, (const byte *) &image, sizeof(image));
+  return true;
+}
+
+/**
+  @brief Restore the snapshot saved by warmStartSave() if it belongs to the connected device.
+
+  The snapshot is checked by the version and crc16(), then against the device by the security mode
+  and a single Data Flash read of the Manufacture Date and the Serial Number of the pack:
+  the Device Name is the same for all the packs of the model, so it does not detect a swap of the pack.
+  Should be called after the sampler tasks are registered:
+  the sample periods are restored only if the number of the tasks is the same.
+
+  The device can not be checked in SEALED mode, the start is the cold one then.
+
+  @returns true if the snapshot was restored (warm start), false if the driver state should be requested from the device
+*/
+bool warmStartRestore(int eepromAddr) {
+  _WarmStartImage image;
+  _eepromRead(eepromAddr, (byte *) &image, sizeof(image));
+  if (WarmStart::VERSION != image.version || sizeof(image) != image.size) return false;
+  if (crc16((const byte *) &image, offsetof(_WarmStartImage, crc)) != image.crc) return false;
+
+  // the security mode is requested anyway: the device could be reset together with the MCU
+  const int mode = rawSecurityMode();
+  if (SecurityMode::UNKNOWN == mode || SecurityMode::SEALED == mode) return false;
+
+  word manufactureDate, serialNumber;
+  if (!_warmStartReadPackKey(&manufactureDate, &serialNumber)) return false;
+  if (manufactureDate != image.identity.manufactureDate || serialNumber != image.identity.serialNumber) {
+    return false;  // another pack
+  }
+
+  _warmStartIdentity = image.identity;
+  _isWarmStartIdentityKnown = true;
+  dfShadowRestore(image.shadow, image.shadowLen);
+  if (samplerCount() == image.samplerCount) {
+    for (byte i = 0; i < image.samplerCount; i++) samplerSetPeriod(i, image.samplerPeriods[i]);
+  }
+  return true;
+}
+
+/**
+  @brief Make the snapshot invalid, so the next start is the cold one.
+*/
+void warmStartErase(int eepromAddr) {
+  const byte erased = 0xFF;
+  _eepromWrite(eepromAddr, &erased, 1);
+  _isWarmStartIdentityKnown = false;
+}
+
+/**
+  @brief Identity of the device saved or restored by the warm start.
+  @returns NULL if it is not known yet
+*/
+const WarmStartIdentity *warmStartIdentity() {
+  return _isWarmStartIdentityKnown ? &_warmStartIdentity : NULL;
+}
+
+/**
+  @brief Print the identity known by the warm start instead of requesting it from the device.
+*/
+void printWarmStartIdentity() {
+  const WarmStartIdentity *identity = warmStartIdentity();
+  if (NULL == identity) {
+    PGM_PRINTLN("[!] Warm start: the identity is not known");
+    return;
+  }
+  printWordHex(PSTR("=== 12.2.1 AltManufacturerAccess() 0x0001 Device Type"), identity->deviceType);
+  PGM_PRINT("=== 12.2.2 AltManufacturerAccess() 0x0002 Firmware Version: ");
+  printBytesHex((byte *) identity->firmwareVersion, WarmStart::FIRMWARE_VERSION_SIZE);
+  printWordHex(PSTR("=== 12.2.6 AltManufacturerAccess() 0x0006 Chemical ID"), identity->chemicalId);
+  PGM_PRINT("=== Device Name: ");
+  Serial.println(identity->deviceName);
+  printWordHex(PSTR("=== Manufacture Date"), identity->manufactureDate);
+  printWordHex(PSTR("=== Serial Number"), identity->serialNumber);
+}
@@ -0,0 +1,128 @@
+/**
+  @file warm_start.h
+
+  @brief Warm start: the driver state kept in EEPROM over the MCU reset
+
+  MIT License
+
+  Copyright (c) 2024 Oleksii Sylichenko
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "globals.h"
+#include "utils.h"
+#include "alt_manufacturer_access.h"
+#include "data_flash_access.h"
+#include "sampler.h"
+#include "service.h"
+
+/**
+  1 = the snapshot is kept in the EEPROM of the MCU,
+  0 = the functions do nothing, every start is the cold one, e.g. for the boards without the EEPROM library.
+
+  Enabled by default on AVR, ESP32 and ESP8266, can be changed with the build flag: -DWARM_START=0
+*/
+#ifndef WARM_START
+#if defined(__AVR__) || defined(ESP32) || defined(ESP8266)
+#define WARM_START 1
+#else
+#define WARM_START 0
+#endif
+#endif
+
+/**
+  @brief Warm start constants
+
+  The snapshot in EEPROM:
+  <pre>
+    [0]      VERSION
+    [1]      size of the snapshot
+    [2..]    identity, see WarmStartIdentity
+    [..]     number of the saved DF shadow bytes, dfShadowSave()
+    [..]     DF_SHADOW::SAVED_SIZE bytes of the DF shadow copy
+    [..]     number of the sampler tasks
+    [..]     Sampler::MAX_TASKS sample periods, ms
+    [n-2..]  crc16() of the bytes above
+  </pre>
+*/
+class WarmStart {
+  public:
+    static const byte VERSION = 2;  ///< Changed with the layout of the snapshot, the older snapshots are ignored.
+    static const int DEFAULT_EEPROM_ADDR = 0;
+    static const byte FIRMWARE_VERSION_SIZE = 11;  ///< ddDDvvVVbbBBTTzzZZRREE, see FirmwareVersion()
+};
+
+/**
+  @brief Identity of the device read by the cold start.
+*/
+struct WarmStartIdentity {
+  word deviceType;  ///< 12.2.1 AltManufacturerAccess() 0x0001 Device Type
+  word chemicalId;  ///< 12.2.6 AltManufacturerAccess() 0x0006 Chemical ID
+  byte firmwareVersion[WarmStart::FIRMWARE_VERSION_SIZE];  ///< 12.2.2 AltManufacturerAccess() 0x0002 Firmware Version
+  char deviceName[DF_ADDR::DEVICE_NAME_SIZE];  ///< I2C Configuration; Data; Device Name; S21
+  word manufactureDate;  ///< I2C Configuration; Data; Manufacture Date; U2
+  word serialNumber;  ///< I2C Configuration; Data; Serial Number; H2, the key of the pack
+};
+
+/**
+  @brief Save the identity, the DF shadow copy and the sampler periods of the current gauge into EEPROM.
+
+  The identity is requested from the device if it is not known yet.
+  Should be called after the cold start has read the cached Data Flash parameters
+  and after every change of them or of the sample periods. Only the changed EEPROM bytes are written.
+
+  @returns false if the identity could not be obtained or WARM_START is disabled
+*/
+bool warmStartSave(int eepromAddr = WarmStart::DEFAULT_EEPROM_ADDR);
+
+/**
+  @brief Restore the snapshot saved by warmStartSave() if it belongs to the connected device.
+
+  The snapshot is checked by the version and crc16(), then against the device by the security mode
+  and a single Data Flash read of the Manufacture Date and the Serial Number of the pack:
+  the Device Name is the same for all the packs of the model, so it does not detect a swap of the pack.
+  Should be called after the sampler tasks are registered:
+  the sample periods are restored only if the number of the tasks is the same.
+
+  The device can not be checked in SEALED mode, the start is the cold one then.
+
+  @returns true if the snapshot was restored (warm start), false if the driver state should be requested from the device
+*/
+bool warmStartRestore(int eepromAddr = WarmStart::DEFAULT_EEPROM_ADDR);
+
+/**
+  @brief Make the snapshot invalid, so the next start is the cold one.
+*/
+void warmStartErase(int eepromAddr = WarmStart::DEFAULT_EEPROM_ADDR);
+
+/**
+  @brief Identity of the device saved or restored by the warm start.
+  @returns NULL if it is not known yet
+*/
+const WarmStartIdentity *warmStartIdentity();
+
+/**
+  @brief Print the identity known by the warm start instead of requesting it from the device.
+*/
+void printWarmStartIdentity();